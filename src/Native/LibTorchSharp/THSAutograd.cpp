@@ -2,6 +2,8 @@
 #include "THSAutograd.h"
 
 #include "torch/torch.h"
+#include "torch/csrc/autograd/forward_grad.h"
+#include "ATen/VmapMode.h"
 
 bool THSAutograd_isGradEnabled()
 {
@@ -33,3 +35,212 @@ void THSAutograd_grad(
     for (size_t i = 0; i < sz; i++)
         result[i] = ResultTensor(res[i]);
 }
+
+int64_t THSAutograd_enter_dual_level()
+{
+    CATCH_RETURN(int64_t, -1, (int64_t)torch::autograd::ForwardADLevel::get_next_idx());
+}
+
+void THSAutograd_exit_dual_level(const int64_t level)
+{
+    CATCH(torch::autograd::ForwardADLevel::release_idx((uint64_t)level););
+}
+
+Tensor THSAutograd_make_dual(const Tensor primal, const Tensor tangent, const int64_t level)
+{
+    CATCH_TENSOR(at::_make_dual(*primal, *tangent, level));
+}
+
+Tensor THSAutograd_unpack_dual(const Tensor dual, const int64_t level, Tensor* tangent)
+{
+    at::Tensor primal;
+    CATCH(
+        auto res = at::_unpack_dual(*dual, level);
+        primal = std::get<0>(res);
+        *tangent = std::get<1>(res).defined() ? ResultTensor(std::get<1>(res)) : nullptr;
+    );
+    return primal.defined() ? ResultTensor(primal) : nullptr;
+}
+
+// Batched directions must pair up with the tensors they apply to, and share the batch size along dimension 0.
+static void check_batched(const std::vector<at::Tensor>& batched, size_t expected, const char* what)
+{
+    if (batched.empty() || batched.size() != expected)
+        throw std::runtime_error(std::string("There must be one batch of ") + what + " per tensor, and at least one.");
+    for (const auto& b : batched) {
+        if (!b.defined() || b.dim() == 0)
+            throw std::runtime_error(std::string("The batched ") + what + " must have the batch along dimension 0.");
+        if (b.size(0) != batched[0].size(0))
+            throw std::runtime_error(std::string("All batched ") + what + " must have the same size along dimension 0.");
+    }
+}
+
+// Runs a single backward pass for a whole batch of grad_outputs, each with the batch along dimension 0,
+// by treating dimension 0 as a vmap dimension. Results have the batch along dimension 0 as well.
+static std::vector<at::Tensor> batched_grad(
+    const std::vector<at::Tensor>& outputs,
+    const std::vector<at::Tensor>& inputs,
+    const std::vector<at::Tensor>& batched_grad_outputs,
+    bool retain_graph, bool create_graph)
+{
+    check_batched(batched_grad_outputs, outputs.size(), "grad_outputs");
+    const int64_t batch_size = batched_grad_outputs[0].size(0);
+
+    std::vector<at::Tensor> res;
+    auto level = at::impl::VmapMode::increment_nesting();
+    try {
+        std::vector<at::Tensor> grad_outputs;
+        for (const auto& g : batched_grad_outputs)
+            grad_outputs.push_back(at::_add_batch_dim(g, 0, level));
+
+        res = torch::autograd::grad(outputs, inputs, grad_outputs, retain_graph, create_graph, /*allow_unused=*/true);
+
+        for (auto& r : res) {
+            if (r.defined())
+                r = at::_remove_batch_dim(r, level, batch_size, 0);
+        }
+    }
+    catch (...) {
+        at::impl::VmapMode::decrement_nesting();
+        throw;
+    }
+    at::impl::VmapMode::decrement_nesting();
+
+    // Results that do not depend on the grad_outputs at all are zero.
+    for (size_t i = 0; i < res.size(); i++) {
+        if (!res[i].defined()) {
+            auto sizes = inputs[i].sizes().vec();
+            sizes.insert(sizes.begin(), batch_size);
+            res[i] = torch::zeros(sizes, inputs[i].options());
+        }
+    }
+    return res;
+}
+
+static void return_tensors(const std::vector<at::Tensor>& tensors, Tensor* (*allocator)(size_t length), const char* origin)
+{
+    Tensor* result = allocator(tensors.size());
+    for (size_t i = 0; i < tensors.size(); i++)
+        result[i] = ResultTensorFrom(tensors[i], origin);
+}
+
+void THSAutograd_batched_vjp(
+    Tensor* outputs, const int64_t oLength,
+    Tensor* inputs, const int64_t iLength,
+    Tensor* grad_outs, const int64_t gLength,
+    bool retain_graph, bool create_graph,
+    Tensor* (*allocator)(size_t length))
+{
+    CATCH(
+        auto res = batched_grad(
+            toTensors<at::Tensor>((torch::Tensor**)outputs, oLength),
+            toTensors<at::Tensor>((torch::Tensor**)inputs, iLength),
+            toTensors<at::Tensor>((torch::Tensor**)grad_outs, gLength),
+            retain_graph, create_graph);
+        return_tensors(res, allocator, __func__);
+    );
+}
+
+// The Jacobian-vector product J v is the gradient, with respect to u, of the vector-Jacobian product u J
+// applied to v. Since u J is linear in u, u itself can be zero, and all directions v go through one
+// batched backward pass of the (much smaller) u J graph.
+static std::vector<at::Tensor> batched_jvp(
+    const std::vector<at::Tensor>& outputs,
+    const std::vector<at::Tensor>& inputs,
+    const std::vector<at::Tensor>& tangents,
+    bool retain_graph, bool create_graph)
+{
+    check_batched(tangents, inputs.size(), "tangents");
+
+    std::vector<at::Tensor> dummies;
+    for (const auto& o : outputs)
+        dummies.push_back(torch::zeros_like(o).requires_grad_(true));
+
+    auto vjps = torch::autograd::grad(outputs, inputs, dummies, /*retain_graph=*/true, /*create_graph=*/true, /*allow_unused=*/true);
+
+    std::vector<at::Tensor> used_vjps;
+    std::vector<at::Tensor> used_tangents;
+    for (size_t i = 0; i < vjps.size(); i++) {
+        if (vjps[i].defined() && vjps[i].requires_grad()) {
+            used_vjps.push_back(vjps[i]);
+            used_tangents.push_back(tangents[i]);
+        }
+    }
+
+    if (used_vjps.empty()) {
+        std::vector<at::Tensor> res;
+        for (const auto& o : outputs) {
+            auto sizes = o.sizes().vec();
+            sizes.insert(sizes.begin(), tangents[0].size(0));
+            res.push_back(torch::zeros(sizes, o.options()));
+        }
+        return res;
+    }
+    return batched_grad(used_vjps, dummies, used_tangents, retain_graph, create_graph);
+}
+
+void THSAutograd_batched_jvp(
+    Tensor* outputs, const int64_t oLength,
+    Tensor* inputs, const int64_t iLength,
+    Tensor* tangents, const int64_t tLength,
+    bool retain_graph, bool create_graph,
+    Tensor* (*allocator)(size_t length))
+{
+    CATCH(
+        auto res = batched_jvp(
+            toTensors<at::Tensor>((torch::Tensor**)outputs, oLength),
+            toTensors<at::Tensor>((torch::Tensor**)inputs, iLength),
+            toTensors<at::Tensor>((torch::Tensor**)tangents, tLength),
+            retain_graph, create_graph);
+        return_tensors(res, allocator, __func__);
+    );
+}
+
+// The Hessian is symmetric, so Hessian-vector products are vector-Jacobian products of the gradient.
+static std::vector<at::Tensor> batched_hvp(
+    const at::Tensor& output,
+    const std::vector<at::Tensor>& inputs,
+    const std::vector<at::Tensor>& directions,
+    bool retain_graph, bool create_graph)
+{
+    check_batched(directions, inputs.size(), "directions");
+
+    auto grads = torch::autograd::grad({ output }, inputs, {}, /*retain_graph=*/true, /*create_graph=*/true, /*allow_unused=*/true);
+
+    std::vector<at::Tensor> used_grads;
+    std::vector<at::Tensor> used_directions;
+    for (size_t i = 0; i < grads.size(); i++) {
+        if (grads[i].defined() && grads[i].requires_grad()) {
+            used_grads.push_back(grads[i]);
+            used_directions.push_back(directions[i]);
+        }
+    }
+
+    if (used_grads.empty()) {
+        std::vector<at::Tensor> res;
+        for (const auto& input : inputs) {
+            auto sizes = input.sizes().vec();
+            sizes.insert(sizes.begin(), directions[0].size(0));
+            res.push_back(torch::zeros(sizes, input.options()));
+        }
+        return res;
+    }
+    return batched_grad(used_grads, inputs, used_directions, retain_graph, create_graph);
+}
+
+void THSAutograd_batched_hvp(
+    const Tensor output,
+    Tensor* inputs, const int64_t iLength,
+    Tensor* directions, const int64_t dLength,
+    bool retain_graph, bool create_graph,
+    Tensor* (*allocator)(size_t length))
+{
+    CATCH(
+        auto res = batched_hvp(
+            *output,
+            toTensors<at::Tensor>((torch::Tensor**)inputs, iLength),
+            toTensors<at::Tensor>((torch::Tensor**)directions, dLength),
+            retain_graph, create_graph);
+        return_tensors(res, allocator, __func__);
+    );
+}
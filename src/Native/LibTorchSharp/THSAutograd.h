@@ -17,3 +17,38 @@ EXPORT_API(void) THSAutograd_grad(
     Tensor* grad_outs, const int64_t gLenght,
     bool retain_graph, bool create_graph, bool allow_unused,
     Tensor* (*allocator)(size_t length));
+
+// Forward-mode AD.
+
+EXPORT_API(int64_t) THSAutograd_enter_dual_level();
+
+EXPORT_API(void) THSAutograd_exit_dual_level(const int64_t level);
+
+EXPORT_API(Tensor) THSAutograd_make_dual(const Tensor primal, const Tensor tangent, const int64_t level);
+
+// Returns the primal, and the tangent (or null) through 'tangent'.
+EXPORT_API(Tensor) THSAutograd_unpack_dual(const Tensor dual, const int64_t level, Tensor* tangent);
+
+// Batched Jacobian and Hessian products. Each vector argument and each result holds many directions,
+// stacked along dimension 0, which are all evaluated in one vectorized backward pass.
+
+EXPORT_API(void) THSAutograd_batched_vjp(
+    Tensor* outputs, const int64_t oLength,
+    Tensor* inputs, const int64_t iLength,
+    Tensor* grad_outs, const int64_t gLength,
+    bool retain_graph, bool create_graph,
+    Tensor* (*allocator)(size_t length));
+
+EXPORT_API(void) THSAutograd_batched_jvp(
+    Tensor* outputs, const int64_t oLength,
+    Tensor* inputs, const int64_t iLength,
+    Tensor* tangents, const int64_t tLength,
+    bool retain_graph, bool create_graph,
+    Tensor* (*allocator)(size_t length));
+
+EXPORT_API(void) THSAutograd_batched_hvp(
+    const Tensor output,
+    Tensor* inputs, const int64_t iLength,
+    Tensor* directions, const int64_t dLength,
+    bool retain_graph, bool create_graph,
+    Tensor* (*allocator)(size_t length));
@@ -67,8 +67,8 @@ inline bool DatasetIterator<Dataset>::moveNext()
 template<typename Dataset>
 inline void DatasetIterator<Dataset>::current(Tensor* data, Tensor* target)
 {
-    data[0] = new torch::Tensor(currentIter->data);
-    target[0] = new torch::Tensor(currentIter->target);
+    data[0] = make_result_tensor(currentIter->data, "THSData_current");
+    target[0] = make_result_tensor(currentIter->target, "THSData_current");
 }
 
 // Reset the iterator to start from the beginning.
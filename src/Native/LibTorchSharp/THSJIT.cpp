@@ -1,11 +1,94 @@
 //// Copyright (c) .NET Foundation and Contributors.  All Rights Reserved.  See LICENSE in the project root for license information.
 #include "THSJIT.h"
 
+#include "torch/csrc/jit/frontend/tracer.h"
+
 JITModule THSJIT_load(const char* filename)
 {
-	auto res = torch::jit::load(filename);
-	auto copy = new torch::jit::Module(res);
-	return new std::shared_ptr<torch::jit::Module>(copy);
+    JITModule res = nullptr;
+    CATCH(
+        res = new std::shared_ptr<torch::jit::Module>(new torch::jit::Module(torch::jit::load(filename)));
+    );
+    return res;
+}
+
+// Mirrors a native module tree as a TorchScript module tree sharing the same parameter and buffer
+// tensors, so that the tracer can refer to them as attributes rather than baking them in as constants.
+static torch::jit::Module make_script_module(const std::shared_ptr<torch::jit::CompilationUnit>& cu, torch::nn::Module& module)
+{
+    torch::jit::Module result(c10::QualifiedName("__torch__.TorchSharp.TracedModule"), cu, /*shouldMangle=*/true);
+    result.register_attribute("training", c10::BoolType::get(), module.is_training());
+    for (const auto& p : module.named_parameters(false)) {
+        if (p.value().defined())
+            result.register_parameter(p.key(), p.value(), /*is_buffer=*/false);
+    }
+    for (const auto& b : module.named_buffers(false)) {
+        if (b.value().defined())
+            result.register_buffer(b.key(), b.value());
+    }
+    for (const auto& c : module.named_children()) {
+        result.register_module(c.key(), make_script_module(cu, *c.value()));
+    }
+    return result;
+}
+
+static JITModule trace(const NNModule module, const Tensor input, Tensor(*forward)(Tensor))
+{
+    auto cu = std::make_shared<torch::jit::CompilationUnit>();
+    auto script = make_script_module(cu, **module);
+
+    // The forward callback returns a fresh handle, which is owned by the caller.
+    auto traced_fn = [forward](torch::jit::Stack inputs) -> torch::jit::Stack {
+        auto input = inputs[0].toTensor();
+        auto output = forward(&input);
+        if (output == nullptr)
+            throw std::runtime_error("The forward function of the traced module did not return a tensor.");
+        at::Tensor result = *output;
+        dispose_tensor_handle(output);
+        return { result };
+    };
+
+    auto traced = torch::jit::tracer::trace(
+        { *input },
+        traced_fn,
+        [](const torch::autograd::Variable&) { return std::string(); },
+        /*strict=*/true,
+        /*force_outplace=*/false,
+        &script);
+
+    auto fn = cu->create_function(c10::QualifiedName(*script.type()->name(), "forward"), traced.first->graph);
+    script.type()->addMethod(fn);
+
+    return new std::shared_ptr<torch::jit::Module>(new torch::jit::Module(script));
+}
+
+JITModule THSJIT_trace(const NNModule module, const Tensor input, Tensor(*forward)(Tensor))
+{
+    JITModule res = nullptr;
+    CATCH(
+        res = trace(module, input, forward);
+    );
+    return res;
+}
+
+// Freezing inlines the parameters and attributes of an evaluation-mode copy of the module, which
+// lets the frozen-graph passes fold and fuse operations before the artifact is written.
+static void save(const JITModule module, const char* filename, const bool freeze)
+{
+    if (!freeze) {
+        (*module)->save(filename);
+        return;
+    }
+    auto copy = (*module)->clone();
+    copy.eval();
+    torch::jit::freeze(copy).save(filename);
+}
+
+void THSJIT_save(const JITModule module, const char* filename, const bool freeze)
+{
+    CATCH(
+        save(module, filename, freeze);
+    );
 }
 
 void THSJIT_Module_modules(const JITModule module, JITModule* (*allocator)(size_t length))
@@ -69,7 +152,7 @@ JITMethod THSJIT_Module_get_method(const JITModule module, const char* name)
 
 Tensor THSJIT_Module_forward(const JITModule module, const Tensor* tensorPtrs, const int length)
 {
-    return new torch::Tensor((*module)->forward(toTensors<c10::IValue>((torch::Tensor**)tensorPtrs, length)).toTensor());
+    CATCH_TENSOR((*module)->forward(toTensors<c10::IValue>((torch::Tensor**)tensorPtrs, length)).toTensor());
 }
 
 void THSJIT_Module_dispose(const JITModule module)
@@ -19,6 +19,10 @@
 
 EXPORT_API(JITModule) THSJIT_load(const char* filename);
 
+EXPORT_API(JITModule) THSJIT_trace(const NNModule module, const Tensor input, Tensor(*forward)(Tensor));
+
+EXPORT_API(void) THSJIT_save(const JITModule module, const char* filename, const bool freeze);
+
 EXPORT_API(void) THSJIT_Module_modules(const JITModule module, JITModule* (*allocator)(size_t length));
 
 EXPORT_API(void) THSJIT_Module_named_modules(const JITModule module,
@@ -231,10 +231,11 @@ Tensor THSNN_triplet_margin_with_distance_loss(const Tensor anchor, const Tensor
         ApplyReduction(opts, reduction);
 
         if (distance_function != nullptr) {
+            const char* origin = __func__;
             opts = opts.distance_function(
                 [=](const at::Tensor& x, const at::Tensor& y) -> const at::Tensor& {
-                auto x1 = ResultTensor(x);
-                auto y1 = ResultTensor(y);
+                auto x1 = ResultTensorFrom(x, origin);
+                auto y1 = ResultTensorFrom(y, origin);
                 return *distance_function(x1, y1);
             });
         }
@@ -3,6 +3,18 @@
 
 #include <torch/nn/init.h>
 
+#include <algorithm>
+#include <cstdio>
+#include <future>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#if _WINDOWS
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
 // General Module functions
 
 int THSNN_Module_is_training(NNModule module)
@@ -60,10 +72,21 @@ void THSNN_AnyModule_dispose(const NNAnyModule module)
 
 // Sub-module handling, parameters, etc.
 
+// Bumped whenever a module, parameter or buffer is registered anywhere, which is what makes
+// cached parameter tables stale. Moving a module to another device or dtype keeps the same
+// tensors, so it does not count as a structural change.
+static std::atomic<int64_t> module_structure_version(0);
+
+void notify_module_structure_changed()
+{
+    module_structure_version.fetch_add(1);
+}
+
 void THSNN_Module_register_module(const NNModule module, const char* name, const NNModule submodule)
 {
     CATCH(
         (*module)->register_module(name, *submodule);
+        notify_module_structure_changed();
     );
 }
 
@@ -71,6 +94,7 @@ void THSNN_Module_register_parameter(const NNModule module, const char* name, co
 {
     CATCH(
         (*module)->register_parameter(name, *tensor, requires_grad);
+        notify_module_structure_changed();
     );
 }
 
@@ -78,6 +102,7 @@ void THSNN_Module_register_buffer(const NNModule module, const char* name, const
 {
     CATCH(
         (*module)->register_buffer(name, *tensor);
+        notify_module_structure_changed();
     );
 }
 
@@ -154,6 +179,274 @@ void THSNN_Module_get_named_modules(const NNModule module, NNModule* (*allocator
     }
 }
 
+// A snapshot of a module's named parameters, buffers and sub-modules that is rebuilt only when
+// the module structure changes. The names are owned by the table, so handing them out needs no copy.
+class ModuleParameterTable
+{
+public:
+    explicit ModuleParameterTable(const std::shared_ptr<torch::nn::Module>& module) : module(module), version(-1) { }
+
+    // Returns true if the table had to be rebuilt.
+    bool refresh()
+    {
+        auto current = module_structure_version.load();
+        if (current == version)
+            return false;
+
+        parameters = module->named_parameters();
+        buffers = module->named_buffers();
+        modules = module->named_modules();
+        version = current;
+        return true;
+    }
+
+    std::shared_ptr<torch::nn::Module> module;
+    int64_t version;
+    torch::OrderedDict<std::string, at::Tensor> parameters;
+    torch::OrderedDict<std::string, at::Tensor> buffers;
+    torch::OrderedDict<std::string, std::shared_ptr<torch::nn::Module>> modules;
+};
+
+ParameterTable THSNN_Module_parameter_table(const NNModule module)
+{
+    ParameterTable res = nullptr;
+    CATCH(
+        auto table = std::make_shared<ModuleParameterTable>(*module);
+        table->refresh();
+        res = new std::shared_ptr<ModuleParameterTable>(table);
+    );
+    return res;
+}
+
+int THSNN_ParameterTable_refresh(const ParameterTable table)
+{
+    CATCH_RETURN(int, 0, (*table)->refresh());
+}
+
+static void get_table_tensors(const torch::OrderedDict<std::string, at::Tensor>& entries, Tensor* (*allocator1)(size_t length), const char** (*allocator2)(size_t length), const char* origin)
+{
+    Tensor* result1 = allocator1(entries.size());
+    const char** result2 = allocator2(entries.size());
+
+    for (size_t i = 0; i < entries.size(); i++)
+    {
+        result1[i] = ResultTensorFrom(entries[i].value(), origin);
+        result2[i] = entries[i].key().c_str();
+    }
+}
+
+void THSNN_ParameterTable_get_parameters(const ParameterTable table, Tensor* (*allocator1)(size_t length), const char** (*allocator2)(size_t length))
+{
+    CATCH(
+        get_table_tensors((*table)->parameters, allocator1, allocator2, __func__);
+    );
+}
+
+void THSNN_ParameterTable_get_buffers(const ParameterTable table, Tensor* (*allocator1)(size_t length), const char** (*allocator2)(size_t length))
+{
+    CATCH(
+        get_table_tensors((*table)->buffers, allocator1, allocator2, __func__);
+    );
+}
+
+void THSNN_ParameterTable_get_modules(const ParameterTable table, NNModule* (*allocator1)(size_t length), const char** (*allocator2)(size_t length))
+{
+    CATCH(
+        auto& modules = (*table)->modules;
+        NNModule* result1 = allocator1(modules.size());
+        const char** result2 = allocator2(modules.size());
+
+        for (size_t i = 0; i < modules.size(); i++)
+        {
+            result1[i] = new std::shared_ptr<torch::nn::Module>(modules[i].value());
+            result2[i] = modules[i].key().c_str();
+        }
+    );
+}
+
+void THSNN_ParameterTable_dispose(const ParameterTable table)
+{
+    delete table;
+}
+
+// An exponential moving average of a module's floating-point parameters and, optionally, buffers. Each
+// update folds the current weights into shadow copies in one pass: contiguous CPU tensors are treated as
+// a single range split across the intra-op thread pool, the rest get one lerp_ each. Swapping exchanges
+// the storage of each weight with its shadow, so evaluating with the averaged weights copies nothing.
+class ModuleWeightAverage
+{
+public:
+    ModuleWeightAverage(const std::shared_ptr<torch::nn::Module>& module, double decay, bool warmup, bool include_buffers)
+        : decay(decay), warmup(warmup)
+    {
+        if (decay < 0 || decay > 1)
+            throw std::runtime_error("The decay must be between 0 and 1.");
+
+        torch::NoGradGuard no_grad;
+        for (auto& p : module->named_parameters())
+            add(p.key(), p.value());
+        if (include_buffers) {
+            for (auto& b : module->named_buffers())
+                add(b.key(), b.value());
+        }
+    }
+
+    ~ModuleWeightAverage()
+    {
+        // Leave the module with its own weights.
+        if (swapped) {
+            try { swap(); }
+            catch (...) { }
+        }
+    }
+
+    // With warm-up, early updates use a smaller decay, so the average is not dominated by the initial weights.
+    double current_decay() const
+    {
+        return warmup ? std::min(decay, (1.0 + updates) / (10.0 + updates)) : decay;
+    }
+
+    void update()
+    {
+        if (swapped)
+            throw std::runtime_error("The averaged weights are swapped into the module; swap them out before updating.");
+
+        torch::NoGradGuard no_grad;
+        const double d = current_decay();
+        std::vector<size_t> floats, doubles;
+        for (size_t i = 0; i < live.size(); i++) {
+            const auto& p = live[i];
+            const auto& s = shadow[i];
+            if (p.sizes() != s.sizes() || p.scalar_type() != s.scalar_type() || p.device() != s.device())
+                throw std::runtime_error("The weight '" + names[i] + "' changed shape, type or device since the average was created.");
+
+            if (p.device().is_cpu() && p.is_contiguous() && s.is_contiguous() && p.scalar_type() == at::kFloat)
+                floats.push_back(i);
+            else if (p.device().is_cpu() && p.is_contiguous() && s.is_contiguous() && p.scalar_type() == at::kDouble)
+                doubles.push_back(i);
+            else
+                shadow[i].lerp_(p, 1 - d);
+        }
+        fused_update<float>(floats, (float)d);
+        fused_update<double>(doubles, d);
+        updates++;
+    }
+
+    void swap()
+    {
+        torch::NoGradGuard no_grad;
+        for (size_t i = 0; i < live.size(); i++) {
+            auto held = live[i].data();
+            live[i].set_data(shadow[i]);
+            shadow[i] = held;
+        }
+        swapped = !swapped;
+    }
+
+    double decay;
+    bool warmup;
+    bool swapped = false;
+    int64_t updates = 0;
+
+    std::vector<std::string> names;
+    std::vector<at::Tensor> live;
+    // The averages, or the module's own weights while swapped.
+    std::vector<at::Tensor> shadow;
+
+private:
+    void add(const std::string& name, const at::Tensor& tensor)
+    {
+        if (!tensor.defined() || !at::isFloatingType(tensor.scalar_type()))
+            return;
+        names.push_back(name);
+        live.push_back(tensor);
+        shadow.push_back(tensor.detach().clone(at::MemoryFormat::Contiguous));
+    }
+
+    template<typename T>
+    void fused_update(const std::vector<size_t>& indices, const T d)
+    {
+        if (indices.empty())
+            return;
+
+        std::vector<T*> averages;
+        std::vector<const T*> currents;
+        std::vector<int64_t> offsets(1, 0);
+        for (auto i : indices) {
+            averages.push_back(shadow[i].data_ptr<T>());
+            currents.push_back(live[i].data_ptr<T>());
+            offsets.push_back(offsets.back() + live[i].numel());
+        }
+
+        const T w = 1 - d;
+        at::parallel_for(0, offsets.back(), 1 << 15, [&](int64_t begin, int64_t end) {
+            size_t k = std::upper_bound(offsets.begin(), offsets.end(), begin) - offsets.begin() - 1;
+            for (int64_t pos = begin; pos < end; k++) {
+                const int64_t start = pos - offsets[k];
+                const int64_t stop = std::min(end, offsets[k + 1]) - offsets[k];
+                T* s = averages[k];
+                const T* p = currents[k];
+                for (int64_t j = start; j < stop; j++)
+                    s[j] = d * s[j] + w * p[j];
+                pos = offsets[k] + stop;
+            }
+        });
+    }
+};
+
+WeightAverage THSNN_Module_weight_average(const NNModule module, const double decay, const bool warmup, const bool include_buffers)
+{
+    WeightAverage res = nullptr;
+    CATCH(
+        res = new std::shared_ptr<ModuleWeightAverage>(std::make_shared<ModuleWeightAverage>(*module, decay, warmup, include_buffers));
+    );
+    return res;
+}
+
+void THSNN_WeightAverage_update(const WeightAverage average)
+{
+    CATCH((*average)->update(););
+}
+
+void THSNN_WeightAverage_swap(const WeightAverage average)
+{
+    CATCH((*average)->swap(););
+}
+
+int THSNN_WeightAverage_is_swapped(const WeightAverage average)
+{
+    return (*average)->swapped;
+}
+
+int64_t THSNN_WeightAverage_updates(const WeightAverage average)
+{
+    return (*average)->updates;
+}
+
+double THSNN_WeightAverage_decay(const WeightAverage average)
+{
+    return (*average)->current_decay();
+}
+
+void THSNN_WeightAverage_get_averages(const WeightAverage average, Tensor* (*allocator1)(size_t length), const char** (*allocator2)(size_t length))
+{
+    CATCH(
+        auto& ema = **average;
+        const auto& averages = ema.swapped ? ema.live : ema.shadow;
+        Tensor* result1 = allocator1(averages.size());
+        const char** result2 = allocator2(averages.size());
+        for (size_t i = 0; i < averages.size(); i++) {
+            result1[i] = ResultTensor(averages[i].detach());
+            result2[i] = make_sharable_string(ema.names[i]);
+        }
+    );
+}
+
+void THSNN_WeightAverage_dispose(const WeightAverage average)
+{
+    delete average;
+}
+
 long THSNN_Module_children_size(const NNModule module)
 {
     return (*module)->children().size();
@@ -190,23 +483,467 @@ void THSNN_Module_save(const NNModule module, const char* location)
 }
 
 
+// Asynchronous checkpoints
+
+// Writes to a temporary file next to the destination, flushes it all the way to disk and renames it into
+// place on commit, so that a crash during a checkpoint never leaves a torn file where the last good one was.
+class DurableFile
+{
+public:
+    explicit DurableFile(const std::string& location) : _location(location), _temp(location + ".tmp")
+    {
+        _file = fopen(_temp.c_str(), "wb");
+        if (_file == nullptr)
+            throw std::runtime_error("Could not open file for writing: " + _temp);
+    }
+
+    ~DurableFile()
+    {
+        if (_file != nullptr) {
+            fclose(_file);
+            std::remove(_temp.c_str());
+        }
+    }
+
+    size_t write(const void* buf, size_t nbytes)
+    {
+        if (fwrite(buf, 1, nbytes, _file) != nbytes)
+            throw std::runtime_error("Failed writing to file: " + _temp);
+        return nbytes;
+    }
+
+    void commit()
+    {
+        bool synced = fflush(_file) == 0;
+#if _WINDOWS
+        synced = synced && _commit(_fileno(_file)) == 0;
+#else
+        synced = synced && fsync(fileno(_file)) == 0;
+#endif
+        bool closed = fclose(_file) == 0;
+        _file = nullptr;
+
+        if (!synced || !closed) {
+            std::remove(_temp.c_str());
+            throw std::runtime_error("Failed flushing file to disk: " + _temp);
+        }
+#if _WINDOWS
+        std::remove(_location.c_str());
+#endif
+        if (std::rename(_temp.c_str(), _location.c_str()) != 0) {
+            std::remove(_temp.c_str());
+            throw std::runtime_error("Could not move checkpoint into place: " + _location);
+        }
+    }
+
+private:
+    std::string _location;
+    std::string _temp;
+    FILE* _file;
+};
+
+// CPU copies of a module's parameters and buffers, mirroring the module tree so that it can be
+// written with the same layout that torch::nn::Module::save() produces.
+struct ModuleSnapshot
+{
+    std::vector<std::pair<std::string, at::Tensor>> parameters;
+    std::vector<std::pair<std::string, at::Tensor>> buffers;
+    std::vector<std::pair<std::string, ModuleSnapshot>> children;
+};
+
+class AsyncCheckpointJob
+{
+public:
+    std::shared_future<void> done;
+};
+
+// At most one checkpoint is in flight at a time. Since a new one does not start before the previous one
+// has been written, the staging tensors can be reused from one checkpoint to the next. They are kept,
+// one per parameter or buffer name, until THSNN_Module_clear_checkpoint_staging releases them.
+static std::mutex checkpoint_lock;
+static std::shared_ptr<AsyncCheckpointJob> checkpoint_in_flight;
+static std::unordered_map<std::string, at::Tensor> checkpoint_staging;
+
+static at::Tensor stage_tensor(const std::string& key, const at::Tensor& source)
+{
+    if (!source.defined())
+        return source;
+
+    auto& staged = checkpoint_staging[key];
+    if (!staged.defined() || staged.scalar_type() != source.scalar_type() || staged.sizes() != source.sizes())
+        staged = torch::empty(source.sizes(), at::TensorOptions().dtype(source.scalar_type()));
+
+    staged.copy_(source);
+    return staged;
+}
+
+static ModuleSnapshot snapshot_module(const torch::nn::Module& module, const std::string& prefix)
+{
+    ModuleSnapshot snapshot;
+
+    for (auto& p : module.named_parameters(/*recurse=*/false))
+        snapshot.parameters.emplace_back(p.key(), stage_tensor(prefix + p.key(), p.value()));
+    for (auto& b : module.named_buffers(/*recurse=*/false))
+        snapshot.buffers.emplace_back(b.key(), stage_tensor(prefix + b.key(), b.value()));
+    for (auto& c : module.named_children()) {
+        if (c.value()->is_serializable())
+            snapshot.children.emplace_back(c.key(), snapshot_module(*c.value(), prefix + c.key() + "."));
+    }
+
+    return snapshot;
+}
+
+static void write_snapshot(const ModuleSnapshot& snapshot, torch::serialize::OutputArchive& archive)
+{
+    for (auto& p : snapshot.parameters)
+        archive.write(p.first, p.second);
+    for (auto& b : snapshot.buffers)
+        archive.write(b.first, b.second, /*is_buffer=*/true);
+    for (auto& c : snapshot.children) {
+        torch::serialize::OutputArchive child(archive.compilation_unit());
+        write_snapshot(c.second, child);
+        archive.write(c.first, child);
+    }
+}
+
+static AsyncCheckpoint save_async(const torch::nn::Module& module, const std::string& location, const std::shared_ptr<torch::optim::Optimizer>* optimizer, const std::string& optimizer_location)
+{
+    std::lock_guard<std::mutex> guard(checkpoint_lock);
+
+    // Back-pressure: wait for the previous checkpoint. Its outcome is reported through its own handle.
+    if (checkpoint_in_flight)
+        checkpoint_in_flight->done.wait();
+
+    torch::NoGradGuard no_grad;
+
+    auto snapshot = std::make_shared<ModuleSnapshot>(snapshot_module(module, ""));
+
+    // Optimizer state is updated in place by step(), so it is serialized to memory here and only
+    // the file I/O is left to the background thread.
+    auto optimizerBytes = std::make_shared<std::string>();
+    if (optimizer != nullptr) {
+        torch::serialize::OutputArchive archive;
+        (*optimizer)->save(archive);
+        archive.save_to([optimizerBytes](const void* buf, size_t nbytes) -> size_t {
+            optimizerBytes->append((const char*)buf, nbytes);
+            return nbytes;
+        });
+    }
+
+    auto job = std::make_shared<AsyncCheckpointJob>();
+    job->done = std::async(std::launch::async, [snapshot, location, optimizerBytes, optimizer_location]() {
+        torch::serialize::OutputArchive archive;
+        write_snapshot(*snapshot, archive);
+
+        DurableFile file(location);
+        archive.save_to([&file](const void* buf, size_t nbytes) -> size_t { return file.write(buf, nbytes); });
+        file.commit();
+
+        if (!optimizer_location.empty()) {
+            DurableFile optimizerFile(optimizer_location);
+            optimizerFile.write(optimizerBytes->data(), optimizerBytes->size());
+            optimizerFile.commit();
+        }
+    }).share();
+
+    checkpoint_in_flight = job;
+    return new std::shared_ptr<AsyncCheckpointJob>(job);
+}
+
+AsyncCheckpoint THSNN_Module_save_async(const NNModule module, const char* location, const Optimizer optimizer, const char* optimizer_location)
+{
+    AsyncCheckpoint res = nullptr;
+    CATCH(
+        if (optimizer != nullptr && optimizer_location == nullptr)
+            throw std::runtime_error("An optimizer checkpoint requires a location.");
+        res = save_async(**module, location, optimizer, optimizer != nullptr ? optimizer_location : "");
+    );
+    return res;
+}
+
+int THSNN_AsyncCheckpoint_is_completed(const AsyncCheckpoint checkpoint)
+{
+    return (*checkpoint)->done.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+void THSNN_AsyncCheckpoint_wait(const AsyncCheckpoint checkpoint)
+{
+    CATCH(
+        (*checkpoint)->done.get();
+    );
+}
+
+void THSNN_AsyncCheckpoint_dispose(const AsyncCheckpoint checkpoint)
+{
+    delete checkpoint; // NOTE: an unfinished checkpoint keeps running; only the handle goes away.
+}
+
+void THSNN_Module_load_checkpoint(const NNModule module, const char* location)
+{
+    CATCH(
+        torch::serialize::InputArchive archive;
+        archive.load_from(location);
+        (*module)->load(archive);
+    );
+}
+
+void THSNN_Module_clear_checkpoint_staging()
+{
+    // A checkpoint in flight holds its own references to the staging tensors it is writing.
+    std::lock_guard<std::mutex> guard(checkpoint_lock);
+    checkpoint_staging.clear();
+}
+
+
+// Reads one unsigned LEB128 value, the length encoding used by exportsd.py and Module.save() on the .NET side.
+static uint64_t decode_leb128(const uint8_t*& ptr, const uint8_t* end)
+{
+    uint64_t result = 0;
+    for (int shift = 0; ; shift += 7) {
+        if (ptr >= end || shift > 63)
+            throw std::runtime_error("Malformed state dictionary file: truncated or invalid length encoding.");
+        uint8_t b = *ptr++;
+        result |= (uint64_t)(b & 0x7f) << shift;
+        if ((b & 0x80) == 0)
+            return result;
+    }
+}
+
+struct StateDictEntry
+{
+    std::string name;
+    at::ScalarType dtype;
+    std::vector<int64_t> shape;
+    uint8_t* data;
+    size_t nbytes;
+};
+
+// Walks the headers of a mapped state dictionary, recording where the raw bytes of each tensor are.
+// No tensor data is touched here, so only the pages holding headers are faulted in.
+static std::vector<StateDictEntry> parse_state_dict_file(const MappedFile& file)
+{
+    const uint8_t* ptr = file.data();
+    const uint8_t* end = ptr + file.size();
+
+    auto count = decode_leb128(ptr, end);
+
+    std::vector<StateDictEntry> entries;
+    entries.reserve((size_t)std::min<uint64_t>(count, 4096));
+
+    for (uint64_t i = 0; i < count; i++)
+    {
+        StateDictEntry entry;
+
+        auto nameLength = decode_leb128(ptr, end);
+        if ((uint64_t)(end - ptr) < nameLength)
+            throw std::runtime_error("Malformed state dictionary file: truncated entry name.");
+        entry.name.assign((const char*)ptr, (size_t)nameLength);
+        ptr += nameLength;
+
+        auto type = decode_leb128(ptr, end);
+        if (type >= (uint64_t)at::ScalarType::NumOptions)
+            throw std::runtime_error("Unsupported element type for '" + entry.name + "' in state dictionary file.");
+        entry.dtype = (at::ScalarType)type;
+
+        auto rank = decode_leb128(ptr, end);
+        uint64_t numel = 1;
+        for (uint64_t d = 0; d < rank; d++)
+        {
+            auto dim = decode_leb128(ptr, end);
+            entry.shape.push_back((int64_t)dim);
+            numel *= dim;
+        }
+
+        entry.nbytes = (size_t)(numel * c10::elementSize(entry.dtype));
+        if ((uint64_t)(end - ptr) < entry.nbytes)
+            throw std::runtime_error("Malformed state dictionary file: truncated data for '" + entry.name + "'.");
+        entry.data = const_cast<uint8_t*>(ptr);
+        ptr += entry.nbytes;
+
+        entries.push_back(std::move(entry));
+    }
+
+    return entries;
+}
+
+static void load_state_dict_file(torch::nn::Module& module, const char* location, bool strict, bool zero_copy)
+{
+    auto file = std::make_shared<MappedFile>(location);
+    auto entries = parse_state_dict_file(*file);
+
+    // Parameters and buffers share one name space, just like state_dict() on the .NET side.
+    std::unordered_map<std::string, at::Tensor> state;
+    for (auto& p : module.named_parameters())
+        state[p.key()] = p.value();
+    for (auto& b : module.named_buffers())
+        state[b.key()] = b.value();
+
+    if (strict && entries.size() != state.size())
+        throw std::runtime_error("Mismatched state_dict sizes: expected " + std::to_string(state.size()) + ", but found " + std::to_string(entries.size()) + " entries.");
+
+    std::vector<std::pair<at::Tensor, const StateDictEntry*>> work;
+    work.reserve(entries.size());
+
+    for (auto& entry : entries)
+    {
+        auto found = state.find(entry.name);
+        if (found == state.end()) {
+            if (strict)
+                throw std::runtime_error("Mismatched module state names: the target module does not have a submodule or buffer named '" + entry.name + "'");
+            continue;
+        }
+
+        auto& target = found->second;
+        // exportsd.py writes bool tensors with the uint8 type code.
+        auto dtype = (entry.dtype == at::kByte && target.scalar_type() == at::kBool) ? at::kBool : entry.dtype;
+
+        if (dtype != target.scalar_type())
+            throw std::runtime_error("Mismatched tensor data types while loading '" + entry.name + "'.");
+        if (target.sizes() != at::IntArrayRef(entry.shape))
+            throw std::runtime_error("Mismatched tensor shape while loading '" + entry.name + "'.");
+
+        work.emplace_back(target, &entry);
+    }
+
+    at::parallel_for(0, (int64_t)work.size(), 1, [&](int64_t begin, int64_t end) {
+        torch::NoGradGuard no_grad;
+
+        for (int64_t i = begin; i < end; i++)
+        {
+            auto& target = work[i].first;
+            auto entry = work[i].second;
+            auto options = at::TensorOptions().dtype(target.scalar_type());
+
+            if (zero_copy && target.is_cpu() && ((uintptr_t)entry->data % target.element_size()) == 0) {
+                // Each view holds on to the mapping, which goes away with the last tensor using it.
+                target.set_(torch::from_blob(entry->data, entry->shape, [file](void*) {}, options));
+            }
+            else {
+                target.copy_(torch::from_blob(entry->data, entry->shape, options));
+            }
+        }
+    });
+}
+
+void THSNN_Module_load_state_dict_file(const NNModule module, const char* location, bool strict, bool zero_copy)
+{
+    CATCH(
+        load_state_dict_file(**module, location, strict, zero_copy);
+    );
+}
+
+
 // Wrapper class used to enable .NET definitions ot new modules describing parameters and with delegates to implement forward function
 class CustomModule : public torch::nn::Module
 {
 public:
+    // Traits a batched custom module can declare, letting callers merge several inputs into one forward call.
+    static const int Elementwise = 1;   // Output i depends only on input element i, whatever the shape.
+    static const int BatchAgnostic = 2; // Samples along dimension 0 are processed independently.
+
     CustomModule(
         const char* name,
         Tensor(*forward)(Tensor))
-        : torch::nn::Module(name), _forward(forward)
+        : torch::nn::Module(name), _forward(forward), _forward_batch(nullptr), _traits(0)
+    {
+    }
+
+    CustomModule(
+        const char* name,
+        void(*forward_batch)(const Tensor*, int, Tensor*),
+        int traits)
+        : torch::nn::Module(name), _forward(nullptr), _forward_batch(forward_batch), _traits(traits)
     {
     }
 
     Tensor(*_forward)(Tensor);
 
+    // Takes 'length' input handles, which remain owned by the caller, and fills the caller's
+    // array with 'length' fresh output handles, whose ownership passes to the caller.
+    void(*_forward_batch)(const Tensor*, int, Tensor*);
+    int _traits;
+
+    bool is_batched() const { return _forward_batch != nullptr; }
+
     at::Tensor forward(at::Tensor input) {
+        if (_forward_batch != nullptr)
+            return invoke_batch({ input })[0];
         return *(*_forward)(&input);
     }
 
+    // Runs all inputs through the module with a single call into .NET.
+    std::vector<at::Tensor> forward_batch(const std::vector<at::Tensor>& inputs)
+    {
+        if (inputs.size() > 1 && can_concatenate(inputs))
+            return forward_concatenated(inputs);
+        return invoke_batch(inputs);
+    }
+
+private:
+    std::vector<at::Tensor> invoke_batch(const std::vector<at::Tensor>& inputs)
+    {
+        const int length = (int)inputs.size();
+        std::vector<Tensor> handles(length);
+        std::vector<Tensor> results(length, nullptr);
+        for (int i = 0; i < length; i++)
+            handles[i] = const_cast<at::Tensor*>(&inputs[i]);
+
+        _forward_batch(handles.data(), length, results.data());
+
+        std::vector<at::Tensor> outputs;
+        outputs.reserve(length);
+        for (auto result : results) {
+            if (result != nullptr) {
+                outputs.push_back(*result);
+                dispose_tensor_handle(result);
+            }
+        }
+        if ((int)outputs.size() != length)
+            throw std::runtime_error("A batched custom module did not produce one output per input.");
+        return outputs;
+    }
+
+    bool can_concatenate(const std::vector<at::Tensor>& inputs) const
+    {
+        if ((_traits & (Elementwise | BatchAgnostic)) == 0)
+            return false;
+
+        const auto& first = inputs[0];
+        for (const auto& t : inputs) {
+            if (t.scalar_type() != first.scalar_type() || t.device() != first.device())
+                return false;
+            if ((_traits & Elementwise) == 0 && (t.dim() == 0 || t.sizes().slice(1) != first.sizes().slice(1)))
+                return false;
+        }
+        return true;
+    }
+
+    // Concatenates the inputs, makes one call, and splits the result again. This trades a copy of
+    // the inputs for a single transition into .NET instead of one per input.
+    std::vector<at::Tensor> forward_concatenated(const std::vector<at::Tensor>& inputs)
+    {
+        const bool elementwise = (_traits & Elementwise) != 0;
+
+        std::vector<at::Tensor> parts;
+        std::vector<int64_t> lengths;
+        int64_t total = 0;
+        for (const auto& t : inputs) {
+            parts.push_back(elementwise ? t.reshape(-1) : t);
+            lengths.push_back(parts.back().size(0));
+            total += lengths.back();
+        }
+
+        auto batched = invoke_batch({ torch::cat(parts, 0) })[0];
+        if (batched.dim() == 0 || batched.size(0) != total)
+            throw std::runtime_error("A batch-agnostic custom module must preserve the size of dimension 0.");
+
+        auto pieces = batched.split_with_sizes(lengths, 0);
+        std::vector<at::Tensor> outputs;
+        outputs.reserve(inputs.size());
+        for (size_t i = 0; i < inputs.size(); i++)
+            outputs.push_back(elementwise ? pieces[i].reshape(inputs[i].sizes()) : pieces[i]);
+        return outputs;
+    }
 };
 
 NNModule THSNN_custom_module(const char* name,
@@ -228,3 +965,485 @@ NNModule THSNN_custom_module(const char* name,
     );
 }
 
+NNModule THSNN_custom_module_batched(const char* name,
+    void(*forward)(const Tensor*, int, Tensor*),
+    int traits,
+    NNAnyModule* outAsAnyModule)
+{
+    CATCH_RETURN_NNModule(
+        auto mod = new CustomModule(name, forward, traits);
+
+    if (outAsAnyModule != NULL)
+    {
+        auto modShared = new std::shared_ptr<CustomModule>(mod);
+        auto wrapped = std::make_shared<torch::nn::AnyModule>(torch::nn::ModuleHolder<CustomModule>(*modShared));
+        *outAsAnyModule = new std::shared_ptr<torch::nn::AnyModule>(wrapped);
+    }
+    res = new std::shared_ptr<torch::nn::Module>((torch::nn::Module*)mod);
+    );
+}
+
+// Pushes a whole batch of inputs through a Sequential one stage at a time, so that each batched
+// custom module is entered once per stage rather than once per input.
+static std::vector<at::Tensor> sequential_forward_batch(torch::nn::SequentialImpl& sequential, std::vector<at::Tensor> current)
+{
+    for (auto& child : sequential) {
+        auto custom = std::dynamic_pointer_cast<CustomModule>(child.ptr());
+        if (custom != nullptr && custom->is_batched()) {
+            current = custom->forward_batch(current);
+        }
+        else {
+            for (auto& t : current)
+                t = child.forward(t);
+        }
+    }
+    return current;
+}
+
+void THSNN_Sequential_forward_batch(const NNModule module, const Tensor* inputs, const int length, Tensor* outputs)
+{
+    CATCH(
+        auto results = sequential_forward_batch(*(*module)->as<torch::nn::Sequential>(), toTensors<at::Tensor>((torch::Tensor**)inputs, length));
+        for (int i = 0; i < length; i++)
+            outputs[i] = ResultTensor(results[i]);
+    );
+}
+
+// True if a module is any of the given module types.
+template<typename... M> struct module_is_any_of;
+
+template<>
+struct module_is_any_of<>
+{
+    static bool of(torch::nn::Module&) { return false; }
+};
+
+template<typename M, typename... Rest>
+struct module_is_any_of<M, Rest...>
+{
+    static bool of(torch::nn::Module& m) { return m.as<M>() != nullptr || module_is_any_of<Rest...>::of(m); }
+};
+
+// Cost estimation: walks a module tree with symbolic shapes, computing each layer's output shape and
+// cost in closed form, without running the model. Sequential children are walked in order; any other
+// module is treated as a single layer. Layers without a closed form are run once on zeros, to learn
+// their output shape, and report their FLOPs as unknown.
+struct LayerCost
+{
+    std::string name;
+    std::string kind;
+    int64_t parameters = 0;
+    int64_t activation_bytes = 0;
+    int64_t flops = -1;
+    int64_t traffic_bytes = 0;
+};
+
+class ModuleCostEstimator
+{
+public:
+    explicit ModuleCostEstimator(at::ScalarType dtype) : dtype(dtype), element_size(c10::elementSize(dtype)) {}
+
+    std::vector<LayerCost> layers;
+
+    std::vector<int64_t> visit(const std::string& name, const std::shared_ptr<torch::nn::Module>& module, torch::nn::AnyModule* any, const std::vector<int64_t>& shape)
+    {
+        if (auto sequential = module->as<torch::nn::Sequential>()) {
+            auto children = sequential->named_children();
+            auto x = shape;
+            size_t i = 0;
+            for (auto& child : *sequential) {
+                const auto& key = children[i++].key();
+                x = visit(name.empty() ? key : name + "." + key, child.ptr(), &child, x);
+            }
+            return x;
+        }
+
+        LayerCost cost;
+        cost.name = name;
+        cost.kind = kind_of(*module);
+
+        int64_t weight_bytes = 0;
+        for (const auto& p : module->parameters()) {
+            cost.parameters += p.numel();
+            weight_bytes += p.nbytes();
+        }
+
+        Estimate e;
+        e.weight_bytes = weight_bytes;
+        if (estimate(*module, shape, e)) {
+            cost.flops = e.flops;
+        }
+        else {
+            e.shape = run(module, any, shape);
+        }
+
+        const auto input_bytes = numel(shape) * element_size;
+        const auto output_bytes = numel(e.shape) * element_size;
+        if (!e.view) {
+            cost.activation_bytes = output_bytes + e.workspace_bytes;
+            cost.traffic_bytes = input_bytes + e.weight_bytes + output_bytes + 2 * e.workspace_bytes;
+        }
+        layers.push_back(cost);
+        return e.shape;
+    }
+
+private:
+    struct Estimate
+    {
+        std::vector<int64_t> shape;
+        int64_t flops = 0;
+        int64_t workspace_bytes = 0; // Intermediates materialized inside the layer, written once and read once.
+        int64_t weight_bytes = 0;    // The parameter bytes read by the forward pass.
+        bool view = false;           // The output is a view of the input, so nothing is computed or written.
+    };
+
+    at::ScalarType dtype;
+    int64_t element_size;
+
+    static int64_t numel(const std::vector<int64_t>& shape)
+    {
+        int64_t n = 1;
+        for (auto s : shape) n *= s;
+        return n;
+    }
+
+    static std::string kind_of(const torch::nn::Module& module)
+    {
+        // Native module names look like 'torch::nn::Conv2dImpl'; custom modules carry their .NET name.
+        auto kind = module.name();
+        const std::string prefix = "torch::nn::";
+        if (kind.compare(0, prefix.size(), prefix) == 0) kind = kind.substr(prefix.size());
+        if (kind.size() > 4 && kind.compare(kind.size() - 4, 4, "Impl") == 0) kind = kind.substr(0, kind.size() - 4);
+        return kind;
+    }
+
+    static int64_t window_output_size(int64_t in, int64_t kernel, int64_t stride, int64_t padding, int64_t dilation, bool ceil_mode)
+    {
+        auto span = in + 2 * padding - dilation * (kernel - 1) - 1;
+        auto out = (ceil_mode ? (span + stride - 1) / stride : span / stride) + 1;
+        // With ceil_mode, the last window must start inside the input or its left padding.
+        if (ceil_mode && (out - 1) * stride >= in + padding) out--;
+        if (out <= 0)
+            throw std::runtime_error("The input is too small for the layer's kernel.");
+        return out;
+    }
+
+    // Checks the input has at least D spatial dimensions plus a channel dimension of the expected size.
+    template<size_t D>
+    static void check_channels(const std::vector<int64_t>& in, int64_t channels, const char* layer)
+    {
+        if (in.size() < D + 1 || (channels > 0 && in[in.size() - D - 1] != channels))
+            throw std::runtime_error(std::string("The input shape does not match the channels of a ") + layer + " layer.");
+    }
+
+    template<size_t D, typename Impl>
+    static void conv(Impl& module, const std::vector<int64_t>& in, Estimate& e)
+    {
+        const auto& o = module.options;
+        check_channels<D>(in, o.in_channels(), "convolution");
+
+        std::vector<int64_t> padding(D, 0);
+        if (auto explicit_padding = c10::get_if<torch::ExpandingArray<D>>(&o.padding()))
+            padding.assign((*explicit_padding)->begin(), (*explicit_padding)->end());
+        const bool same = c10::get_if<torch::enumtype::kSame>(&o.padding()) != nullptr;
+
+        e.shape = in;
+        e.shape[in.size() - D - 1] = o.out_channels();
+        int64_t window = 1;
+        for (size_t i = 0; i < D; i++) {
+            auto& s = e.shape[in.size() - D + i];
+            const auto k = (*o.kernel_size())[i];
+            const auto stride = (*o.stride())[i];
+            const auto dilation = (*o.dilation())[i];
+            window *= k;
+            if (o.transposed())
+                s = (s - 1) * stride - 2 * padding[i] + dilation * (k - 1) + (*o.output_padding())[i] + 1;
+            else if (!same)
+                s = window_output_size(s, k, stride, padding[i], dilation, false);
+        }
+
+        // Every multiply-add pairs one input element with one kernel tap of one output channel in its group.
+        if (o.transposed())
+            e.flops = 2 * numel(in) * window * (o.out_channels() / o.groups());
+        else
+            e.flops = 2 * numel(e.shape) * window * (o.in_channels() / o.groups());
+        if (o.bias()) e.flops += numel(e.shape);
+    }
+
+    template<size_t D, typename Options>
+    static void pool(const Options& o, const std::array<int64_t, D>& dilation, const std::vector<int64_t>& in, Estimate& e)
+    {
+        check_channels<D>(in, 0, "pooling");
+        e.shape = in;
+        int64_t window = 1;
+        for (size_t i = 0; i < D; i++) {
+            auto& s = e.shape[in.size() - D + i];
+            const auto k = (*o.kernel_size())[i];
+            window *= k;
+            s = window_output_size(s, k, (*o.stride())[i], (*o.padding())[i], dilation[i], o.ceil_mode());
+        }
+        e.flops = numel(e.shape) * window;
+    }
+
+    static int64_t adaptive_size(int64_t size, int64_t) { return size; }
+    static int64_t adaptive_size(const c10::optional<int64_t>& size, int64_t in) { return size.has_value() ? *size : in; }
+
+    template<size_t D, typename Options>
+    static void adaptive_pool(const Options& o, const std::vector<int64_t>& in, Estimate& e)
+    {
+        check_channels<D>(in, 0, "pooling");
+        e.shape = in;
+        for (size_t i = 0; i < D; i++) {
+            auto& s = e.shape[in.size() - D + i];
+            s = adaptive_size((*o.output_size())[i], s);
+        }
+        // Adaptive windows tile the input, overlapping by at most one element.
+        e.flops = numel(in);
+    }
+
+    // Cost of a recurrent layer: 'gates' matrix products per step, plus 'pointwise' operations per hidden unit.
+    template<typename Impl>
+    static void recurrent(Impl& module, int64_t gates, int64_t pointwise, const std::vector<int64_t>& in, Estimate& e)
+    {
+        const auto& o = module.options_base;
+        if (in.size() < 2 || in.back() != o.input_size())
+            throw std::runtime_error("The input shape does not match the input size of a recurrent layer.");
+
+        const int64_t directions = o.bidirectional() ? 2 : 1;
+        const int64_t hidden = o.hidden_size();
+        const int64_t output = o.proj_size() > 0 ? o.proj_size() : hidden;
+        const int64_t steps_times_batch = numel(in) / in.back();
+
+        int64_t per_step = 0;
+        int64_t layer_input = o.input_size();
+        for (int64_t l = 0; l < o.num_layers(); l++) {
+            int64_t cell = 2 * gates * hidden * (layer_input + output) + pointwise * hidden;
+            if (o.bias()) cell += 2 * gates * hidden;
+            if (o.proj_size() > 0) cell += 2 * hidden * output;
+            per_step += directions * cell;
+            layer_input = directions * output;
+        }
+
+        e.shape = in;
+        e.shape.back() = directions * output;
+        e.flops = steps_times_batch * per_step;
+        // The gate pre-activations of every step are materialized.
+        e.workspace_bytes = steps_times_batch * directions * o.num_layers() * gates * hidden * element_size;
+    }
+
+    bool estimate(torch::nn::Module& m, const std::vector<int64_t>& in, Estimate& e)
+    {
+        const auto n = numel(in);
+        e.shape = in;
+
+        if (auto linear = m.as<torch::nn::Linear>()) {
+            const auto& o = linear->options;
+            if (in.empty() || in.back() != o.in_features())
+                throw std::runtime_error("The input shape does not match the input features of a Linear layer.");
+            e.shape.back() = o.out_features();
+            e.flops = 2 * (n / o.in_features()) * o.in_features() * o.out_features();
+            if (o.bias()) e.flops += numel(e.shape);
+        }
+        else if (auto c1 = m.as<torch::nn::Conv1d>()) conv<1>(*c1, in, e);
+        else if (auto c2 = m.as<torch::nn::Conv2d>()) conv<2>(*c2, in, e);
+        else if (auto c3 = m.as<torch::nn::Conv3d>()) conv<3>(*c3, in, e);
+        else if (auto c4 = m.as<torch::nn::ConvTranspose1d>()) conv<1>(*c4, in, e);
+        else if (auto c5 = m.as<torch::nn::ConvTranspose2d>()) conv<2>(*c5, in, e);
+        else if (auto c6 = m.as<torch::nn::ConvTranspose3d>()) conv<3>(*c6, in, e);
+        else if (auto p1 = m.as<torch::nn::MaxPool1d>()) pool<1>(p1->options, *p1->options.dilation(), in, e);
+        else if (auto p2 = m.as<torch::nn::MaxPool2d>()) pool<2>(p2->options, *p2->options.dilation(), in, e);
+        else if (auto p3 = m.as<torch::nn::MaxPool3d>()) pool<3>(p3->options, *p3->options.dilation(), in, e);
+        else if (auto p4 = m.as<torch::nn::AvgPool1d>()) pool<1>(p4->options, std::array<int64_t, 1>{ { 1 } }, in, e);
+        else if (auto p5 = m.as<torch::nn::AvgPool2d>()) pool<2>(p5->options, std::array<int64_t, 2>{ { 1, 1 } }, in, e);
+        else if (auto p6 = m.as<torch::nn::AvgPool3d>()) pool<3>(p6->options, std::array<int64_t, 3>{ { 1, 1, 1 } }, in, e);
+        else if (auto p7 = m.as<torch::nn::AdaptiveAvgPool1d>()) adaptive_pool<1>(p7->options, in, e);
+        else if (auto p8 = m.as<torch::nn::AdaptiveAvgPool2d>()) adaptive_pool<2>(p8->options, in, e);
+        else if (auto p9 = m.as<torch::nn::AdaptiveAvgPool3d>()) adaptive_pool<3>(p9->options, in, e);
+        else if (auto p10 = m.as<torch::nn::AdaptiveMaxPool1d>()) adaptive_pool<1>(p10->options, in, e);
+        else if (auto p11 = m.as<torch::nn::AdaptiveMaxPool2d>()) adaptive_pool<2>(p11->options, in, e);
+        else if (auto p12 = m.as<torch::nn::AdaptiveMaxPool3d>()) adaptive_pool<3>(p12->options, in, e);
+        else if (auto r1 = m.as<torch::nn::RNN>()) recurrent(*r1, 1, 1, in, e);
+        else if (auto r2 = m.as<torch::nn::LSTM>()) recurrent(*r2, 4, 8, in, e);
+        else if (auto r3 = m.as<torch::nn::GRU>()) recurrent(*r3, 3, 6, in, e);
+        else if (auto a = m.as<torch::nn::MultiheadAttention>()) {
+            // Self-attention over an input of [length, batch, embedding].
+            const auto& o = a->options;
+            if (in.size() < 2 || in.back() != o.embed_dim())
+                throw std::runtime_error("The input shape does not match the embedding size of a MultiheadAttention layer.");
+            const auto length = in.front();
+            const auto tokens = n / o.embed_dim();
+            const auto batch = tokens / length;
+            const auto scores = batch * o.num_heads() * length * length;
+            e.flops = 2 * tokens * o.embed_dim() * (2 * o.embed_dim() + o.kdim() + o.vdim()) // Input and output projections.
+                + 2 * 2 * scores * (o.embed_dim() / o.num_heads())                            // Q.K^T and weights.V
+                + 5 * scores;                                                                    // Scaling and softmax.
+            e.workspace_bytes = (3 * tokens * o.embed_dim() + scores) * element_size;
+        }
+        else if (auto emb = m.as<torch::nn::Embedding>()) {
+            e.shape.push_back(emb->options.embedding_dim());
+            e.flops = 0;
+            // Only the looked-up rows of the table are read.
+            e.weight_bytes = numel(e.shape) * element_size;
+        }
+        else if (auto bn1 = m.as<torch::nn::BatchNorm1d>()) normalization(bn1->options.affine(), bn1->is_training(), n, e);
+        else if (auto bn2 = m.as<torch::nn::BatchNorm2d>()) normalization(bn2->options.affine(), bn2->is_training(), n, e);
+        else if (auto bn3 = m.as<torch::nn::BatchNorm3d>()) normalization(bn3->options.affine(), bn3->is_training(), n, e);
+        else if (auto in1 = m.as<torch::nn::InstanceNorm1d>()) normalization(in1->options.affine(), true, n, e);
+        else if (auto in2 = m.as<torch::nn::InstanceNorm2d>()) normalization(in2->options.affine(), true, n, e);
+        else if (auto in3 = m.as<torch::nn::InstanceNorm3d>()) normalization(in3->options.affine(), true, n, e);
+        else if (auto ln = m.as<torch::nn::LayerNorm>()) normalization(ln->options.elementwise_affine(), true, n, e);
+        else if (auto gn = m.as<torch::nn::GroupNorm>()) normalization(gn->options.affine(), true, n, e);
+        else if (module_is_any_of<torch::nn::Identity, torch::nn::Flatten, torch::nn::Dropout, torch::nn::Dropout2d, torch::nn::Dropout3d,
+                        torch::nn::AlphaDropout, torch::nn::FeatureAlphaDropout>::of(m)) {
+            if (auto flatten = m.as<torch::nn::Flatten>()) {
+                const int64_t rank = in.size();
+                auto start = flatten->options.start_dim(), end = flatten->options.end_dim();
+                if (start < 0) start += rank;
+                if (end < 0) end += rank;
+                e.shape.assign(in.begin(), in.begin() + start);
+                e.shape.push_back(numel(std::vector<int64_t>(in.begin() + start, in.begin() + end + 1)));
+                e.shape.insert(e.shape.end(), in.begin() + end + 1, in.end());
+            }
+            e.view = !m.is_training() || m.as<torch::nn::Identity>() || m.as<torch::nn::Flatten>();
+            e.flops = e.view ? 0 : 2 * n;
+        }
+        else if (module_is_any_of<torch::nn::ReLU, torch::nn::ReLU6, torch::nn::LeakyReLU, torch::nn::PReLU, torch::nn::RReLU,
+                        torch::nn::Hardtanh, torch::nn::Hardshrink, torch::nn::Softshrink, torch::nn::Threshold>::of(m)) {
+            e.flops = n;
+        }
+        else if (module_is_any_of<torch::nn::Sigmoid, torch::nn::Tanh, torch::nn::GELU, torch::nn::SiLU, torch::nn::Mish, torch::nn::ELU,
+                        torch::nn::SELU, torch::nn::CELU, torch::nn::Softplus, torch::nn::Softsign, torch::nn::LogSigmoid,
+                        torch::nn::Tanhshrink, torch::nn::Softmax, torch::nn::Softmin, torch::nn::LogSoftmax>::of(m)) {
+            // Transcendental functions and softmax normalization cost a handful of operations per element.
+            e.flops = 4 * n;
+        }
+        else {
+            return false;
+        }
+        return true;
+    }
+
+    static void normalization(bool affine, bool compute_statistics, int64_t n, Estimate& e)
+    {
+        // Mean and variance take two passes; normalizing subtracts and scales; the affine transform scales and shifts.
+        // Evaluation-mode batch norm uses running statistics and folds into a single scale and shift.
+        e.flops = compute_statistics ? 4 * n + (affine ? 2 * n : 0) : 2 * n;
+    }
+
+    std::vector<int64_t> run(const std::shared_ptr<torch::nn::Module>& module, torch::nn::AnyModule* any, const std::vector<int64_t>& shape)
+    {
+        auto options = at::TensorOptions().dtype(dtype);
+        auto parameters = module->parameters();
+        if (!parameters.empty()) options = options.device(parameters.front().device());
+
+        torch::NoGradGuard no_grad;
+        auto input = torch::zeros(shape, options);
+        if (any != nullptr)
+            return any->forward(input).sizes().vec();
+        if (auto custom = std::dynamic_pointer_cast<CustomModule>(module))
+            return custom->forward(input).sizes().vec();
+        throw std::runtime_error("Cannot estimate the cost of a " + kind_of(*module) + " module on its own: it has no closed form and is not a custom module.");
+    }
+};
+
+void THSNN_Module_profile_cost(const NNModule module, const int64_t* shape, const int length, const int8_t dtype, int64_t* (*allocator1)(size_t length), const char** (*allocator2)(size_t length))
+{
+    CATCH(
+        ModuleCostEstimator estimator((at::ScalarType)dtype);
+        estimator.visit("", *module, nullptr, std::vector<int64_t>(shape, shape + length));
+
+        const auto& layers = estimator.layers;
+        int64_t* numbers = allocator1(layers.size() * 4);
+        const char** names = allocator2(layers.size() * 2);
+        for (size_t i = 0; i < layers.size(); i++) {
+            numbers[4 * i + 0] = layers[i].parameters;
+            numbers[4 * i + 1] = layers[i].activation_bytes;
+            numbers[4 * i + 2] = layers[i].flops;
+            numbers[4 * i + 3] = layers[i].traffic_bytes;
+            names[2 * i + 0] = make_sharable_string(layers[i].name);
+            names[2 * i + 1] = make_sharable_string(layers[i].kind);
+        }
+    );
+}
+
+// Runs a module's forward without leaving native code, except for custom modules, which call into .NET once.
+static at::Tensor forward_module(const std::shared_ptr<torch::nn::Module>& module, torch::nn::AnyModule* boxed, const at::Tensor& input)
+{
+    if (auto sequential = std::dynamic_pointer_cast<torch::nn::SequentialImpl>(module))
+        return sequential->forward(input);
+    if (auto custom = std::dynamic_pointer_cast<CustomModule>(module))
+        return custom->forward(input);
+    if (boxed != nullptr) {
+        // The boxed module is a separate instance sharing the parameters, so it does not see train() and eval().
+        boxed->ptr()->train(module->is_training());
+        return boxed->forward(input);
+    }
+    throw std::runtime_error("Cannot run a " + module->name() + " module natively: it is neither a Sequential, a custom module, nor boxed.");
+}
+
+// The losses a native training step can compute, each with mean reduction.
+enum class TrainLoss : int64_t
+{
+    MSE = 0,
+    L1 = 1,
+    CrossEntropy = 2,
+    NLL = 3,
+    BinaryCrossEntropyWithLogits = 4,
+    SmoothL1 = 5,
+    Huber = 6,
+};
+
+static at::Tensor train_loss(const int64_t kind, const at::Tensor& output, const at::Tensor& target)
+{
+    namespace F = torch::nn::functional;
+    switch ((TrainLoss)kind) {
+    case TrainLoss::MSE: return F::mse_loss(output, target);
+    case TrainLoss::L1: return F::l1_loss(output, target);
+    case TrainLoss::CrossEntropy: return F::cross_entropy(output, target);
+    case TrainLoss::NLL: return F::nll_loss(output, target);
+    case TrainLoss::BinaryCrossEntropyWithLogits: return F::binary_cross_entropy_with_logits(output, target);
+    case TrainLoss::SmoothL1: return F::smooth_l1_loss(output, target);
+    case TrainLoss::Huber: return F::huber_loss(output, target);
+    }
+    throw std::runtime_error("Unknown loss kind: " + std::to_string(kind));
+}
+
+// The batch is split along dimension 0 into 'accumulation_steps' micro-batches, whose gradients are
+// accumulated before the single optimizer step. Each micro-batch loss is weighted by its share of the
+// batch, so the gradients and the returned loss are those of the whole batch.
+static double train_step(const std::shared_ptr<torch::nn::Module>& module, torch::nn::AnyModule* boxed, const at::Tensor& input, const at::Tensor& target, const int64_t loss_kind, torch::optim::Optimizer& optimizer, const double max_norm, const int64_t accumulation_steps)
+{
+    if (accumulation_steps < 1)
+        throw std::runtime_error("The number of accumulation steps must be at least 1.");
+    if (input.dim() == 0 || input.size(0) != target.size(0))
+        throw std::runtime_error("The input and target must have the same, non-empty, batch dimension.");
+
+    const auto batch = input.size(0);
+    const auto inputs = input.chunk(accumulation_steps);
+    const auto targets = target.chunk(accumulation_steps);
+
+    optimizer.zero_grad();
+    double total = 0;
+    for (size_t i = 0; i < inputs.size(); i++) {
+        const double share = (double)inputs[i].size(0) / batch;
+        auto loss = train_loss(loss_kind, forward_module(module, boxed, inputs[i]), targets[i]) * share;
+        loss.backward();
+        total += loss.item<double>();
+    }
+
+    if (max_norm > 0) {
+        std::vector<at::Tensor> parameters;
+        for (auto& group : optimizer.param_groups())
+            for (auto& p : group.params())
+                parameters.push_back(p);
+        torch::nn::utils::clip_grad_norm_(parameters, max_norm);
+    }
+
+    optimizer.step();
+    return total;
+}
+
+double THSNN_train_step(const NNModule module, const NNAnyModule boxed, const Tensor input, const Tensor target, const int64_t loss_kind, const Optimizer optimizer, const double max_norm, const int64_t accumulation_steps)
+{
+    CATCH_RETURN(double, std::numeric_limits<double>::quiet_NaN(), train_step(*module, boxed == nullptr ? nullptr : boxed->get(), *input, *target, loss_kind, **optimizer, max_norm, accumulation_steps));
+}
@@ -3,6 +3,12 @@
 
 #include <torch/nn/init.h>
 
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <thread>
+
 
 NNModule THSNN_Identity_ctor(NNAnyModule* outAsAnyModule)
 {
@@ -881,6 +887,7 @@ void THSNN_Sequential_push_back(const NNModule module, const char *name, const N
 {
     CATCH (
         (*module)->as<torch::nn::Sequential>()->push_back(name, *(*submodule));
+        notify_module_structure_changed();
     )
 }
 
@@ -889,6 +896,823 @@ Tensor THSNN_Sequential_forward(const NNModule module, const Tensor tensor)
     CATCH_TENSOR((*module)->as<torch::nn::Sequential>()->forward(*tensor));
 }
 
+// Planned inference for Sequential: for a fixed input, the output of every layer is placed in one
+// of two preallocated buffers, alternating between them, since in a chain only the input and output
+// of the current layer are live. Layers with an out= kernel write straight into their buffer; layers
+// returning a view of their input keep using the buffer it lives in; any other layer falls back to
+// its own forward(), which allocates as usual.
+class SequentialInferencePlan
+{
+public:
+    enum class Op { Forward, Linear, ReLU, Sigmoid, Tanh, GELU, SiLU };
+
+    struct Step
+    {
+        Op op;
+        torch::nn::AnyModule module;
+        at::Tensor weight;
+        at::Tensor bias;
+        at::Tensor output; // A view into one of the plan's buffers; undefined for Forward steps.
+    };
+
+    std::shared_ptr<torch::nn::Module> sequential;
+    std::vector<Step> steps;
+    std::vector<at::Tensor> buffers;
+    std::vector<int64_t> input_shape;
+    at::TensorOptions input_options;
+
+    int64_t workspace_bytes() const
+    {
+        int64_t total = 0;
+        for (const auto& b : buffers) {
+            if (b.defined())
+                total += b.numel();
+        }
+        return total;
+    }
+
+    at::Tensor forward(const at::Tensor& input)
+    {
+        if (input.sizes() != c10::IntArrayRef(input_shape) || input.dtype() != input_options.dtype() || input.device() != input_options.device())
+            throw std::runtime_error("The input does not have the shape, dtype and device the plan was made for.");
+
+        torch::NoGradGuard no_grad;
+        at::Tensor x = input;
+        for (auto& step : steps) {
+            switch (step.op) {
+            case Op::Linear: {
+                auto x2 = x.reshape({ -1, x.size(-1) });
+                auto out2 = step.output.view({ -1, step.output.size(-1) });
+                if (step.bias.defined())
+                    torch::addmm_out(out2, step.bias, x2, step.weight.t());
+                else
+                    torch::mm_out(out2, x2, step.weight.t());
+                x = step.output;
+                break;
+            }
+            case Op::ReLU:
+                x = torch::clamp_min_out(step.output, x, 0);
+                break;
+            case Op::Sigmoid:
+                x = torch::sigmoid_out(step.output, x);
+                break;
+            case Op::Tanh:
+                x = torch::tanh_out(step.output, x);
+                break;
+            case Op::GELU:
+                x = torch::gelu_out(step.output, x);
+                break;
+            case Op::SiLU:
+                x = torch::silu_out(step.output, x);
+                break;
+            default:
+                x = step.module.forward(x);
+                break;
+            }
+        }
+        return x;
+    }
+};
+
+static SequentialInferencePlan::Op planned_op(torch::nn::Module& module)
+{
+    using Op = SequentialInferencePlan::Op;
+    if (module.as<torch::nn::Linear>() != nullptr) return Op::Linear;
+    if (module.as<torch::nn::ReLU>() != nullptr) return Op::ReLU;
+    if (module.as<torch::nn::Sigmoid>() != nullptr) return Op::Sigmoid;
+    if (module.as<torch::nn::Tanh>() != nullptr) return Op::Tanh;
+    if (module.as<torch::nn::GELU>() != nullptr) return Op::GELU;
+    if (module.as<torch::nn::SiLU>() != nullptr) return Op::SiLU;
+    return Op::Forward;
+}
+
+static std::shared_ptr<SequentialInferencePlan> plan_sequential(const std::shared_ptr<torch::nn::Module>& module, const at::Tensor& example)
+{
+    using Op = SequentialInferencePlan::Op;
+
+    auto plan = std::make_shared<SequentialInferencePlan>();
+    plan->sequential = module;
+    plan->input_shape = example.sizes().vec();
+    plan->input_options = example.options();
+
+    // Run the example through once to learn every intermediate shape, and assign buffers by liveness.
+    torch::NoGradGuard no_grad;
+    std::vector<int> assignment;
+    std::vector<int64_t> sizes(2, 0);
+    std::vector<at::Tensor> shapes;
+    int current = -1; // The buffer holding the current activation; -1 if it is not in a planned buffer.
+
+    auto sequential = module->as<torch::nn::Sequential>();
+    if (sequential == nullptr)
+        throw std::runtime_error("Only Sequential modules can be planned.");
+
+    // Work on a copy, so that in-place layers do not modify the caller's example.
+    at::Tensor x = example.clone();
+    for (auto& child : *sequential) {
+        SequentialInferencePlan::Step step;
+        step.op = planned_op(*child.ptr());
+        step.module = child;
+
+        at::Tensor y = child.forward(x);
+        if (step.op != Op::Forward) {
+            if (step.op == Op::Linear) {
+                auto linear = child.ptr()->as<torch::nn::Linear>();
+                step.weight = linear->weight;
+                step.bias = linear->bias;
+            }
+            current = (current == 0) ? 1 : 0;
+            sizes[current] = std::max(sizes[current], (int64_t)y.nbytes());
+        }
+        else if (!y.is_alias_of(x)) {
+            current = -1;
+        }
+        assignment.push_back(step.op != Op::Forward ? current : -1);
+        shapes.push_back(y);
+        plan->steps.push_back(std::move(step));
+        x = y;
+    }
+
+    for (auto bytes : sizes) {
+        if (bytes > 0)
+            plan->buffers.push_back(torch::empty({ bytes }, example.options().dtype(at::kByte)));
+        else
+            plan->buffers.push_back(at::Tensor());
+    }
+
+    for (size_t i = 0; i < plan->steps.size(); i++) {
+        if (assignment[i] < 0) continue;
+        auto buffer = plan->buffers[assignment[i]];
+        plan->steps[i].output = torch::from_blob(buffer.data_ptr(), shapes[i].sizes(), [buffer](void*) {}, shapes[i].options());
+    }
+    return plan;
+}
+
+SequentialPlan THSNN_Sequential_plan(const NNModule module, const Tensor example)
+{
+    SequentialPlan res = nullptr;
+    CATCH(
+        res = new std::shared_ptr<SequentialInferencePlan>(plan_sequential(*module, *example));
+    );
+    return res;
+}
+
+Tensor THSNN_SequentialPlan_forward(const SequentialPlan plan, const Tensor input)
+{
+    CATCH_TENSOR((*plan)->forward(*input));
+}
+
+int64_t THSNN_SequentialPlan_workspace_bytes(const SequentialPlan plan)
+{
+    CATCH_RETURN(int64_t, 0, (*plan)->workspace_bytes());
+}
+
+void THSNN_SequentialPlan_dispose(const SequentialPlan plan)
+{
+    delete plan;
+}
+
+// Per-sample gradients: the forward pass records the input and output of every layer with parameters.
+// A single backward pass then yields the gradient of the loss with respect to each of those outputs,
+// from which each layer's per-sample parameter gradients follow in closed form, with the batch along
+// dimension 0. Only layers with a closed form are supported: Linear, Conv1d, Conv2d, Embedding and LayerNorm.
+class PerSampleGradientTrace
+{
+public:
+    enum class Kind { Linear, Conv1d, Conv2d, Embedding, LayerNorm };
+
+    struct Layer
+    {
+        Kind kind;
+        std::shared_ptr<torch::nn::Module> module;
+        at::Tensor input;
+        at::Tensor output;
+    };
+
+    std::vector<Layer> layers;
+
+    // Returns the per-sample gradients of every recorded parameter, layer by layer.
+    std::vector<at::Tensor> grads(const at::Tensor& loss);
+
+    // Clips each sample's gradient to max_norm, sums the clipped gradients into the parameters' grad,
+    // and returns the per-sample gradient norms before clipping.
+    at::Tensor clip_and_accumulate(const at::Tensor& loss, double max_norm);
+
+private:
+    std::vector<at::Tensor> parameters() const;
+};
+
+template<size_t D>
+static at::Tensor unfold_conv_input(const at::Tensor& input, const torch::nn::ConvNdOptions<D>& options, const std::vector<int64_t>& kernel)
+{
+    if (!c10::get_if<torch::enumtype::kZeros>(&options.padding_mode()))
+        throw std::runtime_error("Per-sample gradients of convolutions are only supported with zero padding.");
+
+    std::vector<int64_t> stride(options.stride()->begin(), options.stride()->end());
+    std::vector<int64_t> dilation(options.dilation()->begin(), options.dilation()->end());
+    std::vector<int64_t> padding(D, 0);
+
+    at::Tensor x = input;
+    if (auto explicit_padding = c10::get_if<torch::ExpandingArray<D>>(&options.padding())) {
+        padding.assign((*explicit_padding)->begin(), (*explicit_padding)->end());
+    }
+    else if (c10::get_if<torch::enumtype::kSame>(&options.padding())) {
+        // 'same' padding may be uneven, with the extra element on the right, so pad explicitly.
+        std::vector<int64_t> pad;
+        for (int64_t d = D - 1; d >= 0; d--) {
+            auto total = dilation[d] * (kernel[d] - 1);
+            pad.push_back(total / 2);
+            pad.push_back(total - total / 2);
+        }
+        x = torch::constant_pad_nd(x, pad, 0);
+    }
+
+    if (D == 1) {
+        // Treat the sequence as an image of height one.
+        return torch::im2col(x.unsqueeze(2), { 1, kernel[0] }, { 1, dilation[0] }, { 0, padding[0] }, { 1, stride[0] });
+    }
+    return torch::im2col(x, kernel, dilation, padding, stride);
+}
+
+template<size_t D, typename Impl>
+static void conv_per_sample_grads(Impl* conv, const at::Tensor& input, const at::Tensor& grad_output, std::vector<at::Tensor>& result)
+{
+    const auto& weight = conv->weight;
+    const auto n = input.size(0);
+    const auto groups = conv->options.groups();
+    std::vector<int64_t> kernel(weight.sizes().begin() + 2, weight.sizes().end());
+
+    // [n, in * k, L] and [n, out, L], split by group.
+    auto columns = unfold_conv_input<D>(input, conv->options, kernel).reshape({ n, groups, -1, grad_output.flatten(2).size(2) });
+    auto g = grad_output.flatten(2).reshape({ n, groups, -1, columns.size(3) });
+
+    auto sizes = weight.sizes().vec();
+    sizes.insert(sizes.begin(), n);
+    result.push_back(torch::einsum("ngol,ngkl->ngok", { g, columns }).reshape(sizes));
+
+    if (conv->bias.defined())
+        result.push_back(grad_output.flatten(2).sum(2));
+}
+
+static void per_sample_grads(const PerSampleGradientTrace::Layer& layer, const at::Tensor& grad_output, std::vector<at::Tensor>& result)
+{
+    using Kind = PerSampleGradientTrace::Kind;
+
+    const auto& input = layer.input;
+    const auto n = input.size(0);
+
+    switch (layer.kind) {
+    case Kind::Linear: {
+        auto linear = layer.module->as<torch::nn::Linear>();
+        auto a = input.reshape({ n, -1, input.size(-1) });
+        auto g = grad_output.reshape({ n, -1, grad_output.size(-1) });
+        result.push_back(torch::bmm(g.transpose(1, 2), a));
+        if (linear->bias.defined())
+            result.push_back(g.sum(1));
+        break;
+    }
+    case Kind::Conv1d:
+        conv_per_sample_grads<1>(layer.module->as<torch::nn::Conv1d>(), input, grad_output, result);
+        break;
+    case Kind::Conv2d:
+        conv_per_sample_grads<2>(layer.module->as<torch::nn::Conv2d>(), input, grad_output, result);
+        break;
+    case Kind::Embedding: {
+        // Sparse, with one (sample, index) entry per lookup and the matching grad_output row as its value:
+        // a dense [n, num_embeddings, dim] gradient would hold n copies of the table. Entries may repeat.
+        auto embedding = layer.module->as<torch::nn::Embedding>();
+        const auto& weight = embedding->weight;
+        auto rows = input.reshape({ n, -1 }).to(torch::kLong);
+        auto samples = torch::arange(n, rows.options()).unsqueeze(1).expand_as(rows);
+        auto indices = torch::stack({ samples.reshape(-1), rows.reshape(-1) });
+        auto values = grad_output.reshape({ -1, weight.size(1) });
+        if (embedding->options.padding_idx().has_value()) {
+            auto keep = torch::nonzero(indices[1] != *embedding->options.padding_idx()).squeeze(1);
+            indices = indices.index_select(1, keep);
+            values = values.index_select(0, keep);
+        }
+        result.push_back(torch::sparse_coo_tensor(indices, values, { n, weight.size(0), weight.size(1) }));
+        break;
+    }
+    case Kind::LayerNorm: {
+        auto norm = layer.module->as<torch::nn::LayerNorm>();
+        const auto& shape = norm->options.normalized_shape();
+        auto normalized = torch::layer_norm(input, shape, {}, {}, norm->options.eps());
+
+        std::vector<int64_t> sizes = { n, -1 };
+        sizes.insert(sizes.end(), shape.begin(), shape.end());
+        result.push_back((grad_output * normalized).reshape(sizes).sum(1));
+        result.push_back(grad_output.reshape(sizes).sum(1));
+        break;
+    }
+    }
+}
+
+std::vector<at::Tensor> PerSampleGradientTrace::grads(const at::Tensor& loss)
+{
+    std::vector<at::Tensor> outputs;
+    for (const auto& layer : layers)
+        outputs.push_back(layer.output);
+
+    auto grad_outputs = torch::autograd::grad({ loss }, outputs, {}, /*retain_graph=*/false, /*create_graph=*/false, /*allow_unused=*/true);
+
+    torch::NoGradGuard no_grad;
+    std::vector<at::Tensor> result;
+    for (size_t i = 0; i < layers.size(); i++) {
+        auto g = grad_outputs[i].defined() ? grad_outputs[i] : torch::zeros_like(layers[i].output);
+        per_sample_grads(layers[i], g, result);
+    }
+    return result;
+}
+
+std::vector<at::Tensor> PerSampleGradientTrace::parameters() const
+{
+    std::vector<at::Tensor> result;
+    for (const auto& layer : layers) {
+        for (const auto& p : layer.module->named_parameters(false)) {
+            if (p.value().defined())
+                result.push_back(p.value());
+        }
+    }
+    return result;
+}
+
+// The squared norm of each sample's slice of a sparse [n, rows, dim] per-sample gradient. Repeated (sample, row)
+// entries are summed first, with an index_add over the unique ones, rather than by scattering into a dense table.
+static at::Tensor sparse_squared_norms(const at::Tensor& g, int64_t n)
+{
+    auto indices = g._indices();
+    auto values = g._values();
+    auto keys = indices[0] * g.size(1) + indices[1];
+
+    at::Tensor unique, inverse;
+    std::tie(unique, inverse) = torch::_unique(keys, /*sorted=*/false, /*return_inverse=*/true);
+    auto summed = torch::zeros({ unique.size(0), values.size(1) }, values.options()).index_add_(0, inverse, values);
+    return torch::zeros({ n }, values.options()).index_add_(0, unique.div(g.size(1), "floor"), summed.pow(2).sum(1));
+}
+
+at::Tensor PerSampleGradientTrace::clip_and_accumulate(const at::Tensor& loss, double max_norm)
+{
+    auto sample_grads = grads(loss);
+    auto params = parameters();
+    if (sample_grads.size() != params.size())
+        throw std::runtime_error("The per-sample gradients do not match the parameters of the traced layers.");
+
+    torch::NoGradGuard no_grad;
+    const auto n = sample_grads[0].size(0);
+
+    auto squared = torch::zeros({ n }, sample_grads[0].options().layout(torch::kStrided));
+    for (const auto& g : sample_grads)
+        squared.add_(g.is_sparse() ? sparse_squared_norms(g, n) : g.reshape({ n, -1 }).pow(2).sum(1));
+    auto norms = squared.sqrt();
+    auto factors = norms.add(1e-6).reciprocal().mul(max_norm).clamp_max(1.0);
+
+    for (size_t i = 0; i < params.size(); i++) {
+        const auto& g = sample_grads[i];
+        at::Tensor clipped;
+        if (g.is_sparse()) {
+            auto indices = g._indices();
+            auto scaled = g._values() * factors.index_select(0, indices[0]).unsqueeze(1);
+            clipped = torch::zeros_like(params[i]).index_add_(0, indices[1], scaled);
+        }
+        else {
+            std::vector<int64_t> shape(g.dim(), 1);
+            shape[0] = n;
+            clipped = (g * factors.view(shape)).sum(0);
+        }
+
+        auto& grad = params[i].mutable_grad();
+        if (grad.defined())
+            grad.add_(clipped);
+        else
+            grad = clipped;
+    }
+    return norms;
+}
+
+static std::shared_ptr<PerSampleGradientTrace> per_sample_forward(const std::shared_ptr<torch::nn::Module>& module, const at::Tensor& input, at::Tensor& output)
+{
+    using Kind = PerSampleGradientTrace::Kind;
+
+    auto sequential = module->as<torch::nn::Sequential>();
+    if (sequential == nullptr)
+        throw std::runtime_error("Per-sample gradients can only be traced through Sequential modules.");
+
+    auto trace = std::make_shared<PerSampleGradientTrace>();
+    at::Tensor x = input;
+    for (auto& child : *sequential) {
+        auto m = child.ptr();
+        at::Tensor y = child.forward(x);
+
+        bool has_parameters = false;
+        for (const auto& p : m->named_parameters(true))
+            has_parameters = has_parameters || (p.value().defined() && p.value().requires_grad());
+
+        if (has_parameters) {
+            Kind kind;
+            if (m->as<torch::nn::Linear>()) kind = Kind::Linear;
+            else if (m->as<torch::nn::Conv1d>()) kind = Kind::Conv1d;
+            else if (m->as<torch::nn::Conv2d>()) kind = Kind::Conv2d;
+            else if (m->as<torch::nn::Embedding>()) kind = Kind::Embedding;
+            else if (m->as<torch::nn::LayerNorm>()) kind = Kind::LayerNorm;
+            else
+                throw std::runtime_error("Per-sample gradients are not supported for module '" + m->name() + "'.");
+
+            trace->layers.push_back({ kind, m, x, y });
+        }
+        x = y;
+    }
+    output = x;
+    return trace;
+}
+
+PerSampleTrace THSNN_Sequential_per_sample_forward(const NNModule module, const Tensor input, Tensor* output)
+{
+    PerSampleTrace res = nullptr;
+    CATCH(
+        at::Tensor result;
+        auto trace = per_sample_forward(*module, *input, result);
+        *output = ResultTensor(result);
+        res = new std::shared_ptr<PerSampleGradientTrace>(trace);
+    );
+    return res;
+}
+
+void THSNN_PerSampleTrace_grads(const PerSampleTrace trace, const Tensor loss, Tensor* (*allocator)(size_t length))
+{
+    CATCH(
+        auto grads = (*trace)->grads(*loss);
+        Tensor* result = allocator(grads.size());
+        for (size_t i = 0; i < grads.size(); i++)
+            result[i] = ResultTensor(grads[i]);
+    );
+}
+
+Tensor THSNN_PerSampleTrace_clip_and_accumulate(const PerSampleTrace trace, const Tensor loss, const double max_norm)
+{
+    CATCH_TENSOR((*trace)->clip_and_accumulate(*loss, max_norm));
+}
+
+void THSNN_PerSampleTrace_dispose(const PerSampleTrace trace)
+{
+    delete trace;
+}
+
+// Pipeline-parallel execution of a Sequential: the layers are split into consecutive stages, each run by its
+// own worker thread, optionally pinned to a NUMA node along with its parameters. An input is split into
+// micro-batches that stream through the stages over bounded queues, so that all stages work at once on
+// different micro-batches. Training follows the GPipe schedule: the forward pass of every micro-batch,
+// then the backward pass of every micro-batch, pipelined through the stages in reverse. Stage boundaries
+// are cut out of the autograd graph, and each stage runs its own part of the backward pass.
+class SequentialPipeline
+{
+public:
+    SequentialPipeline(const std::shared_ptr<torch::nn::Module>& module, const std::vector<size_t>& starts, const std::vector<int>& nodes, size_t capacity)
+        : sequential(module), results(SIZE_MAX)
+    {
+        auto& layers = *module->as<torch::nn::Sequential>();
+        for (size_t s = 0; s < starts.size(); s++) {
+            auto stage = std::unique_ptr<Stage>(new Stage(capacity));
+            auto end = s + 1 < starts.size() ? starts[s + 1] : layers.size();
+            for (auto i = starts[s]; i < end; i++)
+                stage->modules.push_back(layers[i]);
+            stage->node = nodes.empty() ? -1 : nodes[s % nodes.size()];
+            stages.push_back(std::move(stage));
+        }
+
+        // Wait for every worker to have moved its parameters, since they may be in use as soon as this returns.
+        std::vector<std::future<void>> ready;
+        for (size_t s = 0; s < stages.size(); s++) {
+            auto started = std::make_shared<std::promise<void>>();
+            ready.push_back(started->get_future());
+            stages[s]->worker = std::thread([this, s, started]() { run_stage(s, *started); });
+        }
+        for (auto& r : ready)
+            r.wait();
+    }
+
+    ~SequentialPipeline()
+    {
+        for (auto& stage : stages)
+            stage->queue.push(Task{ Kind::Stop, false, 0, at::Tensor(), nullptr });
+        for (auto& stage : stages)
+            stage->worker.join();
+    }
+
+    // Returns the output of every micro-batch. In training mode, the outputs are part of the autograd graph,
+    // and backward() must be called with one loss per micro-batch before the next forward().
+    std::vector<at::Tensor> forward(const at::Tensor& input, int64_t micro_batches, bool train)
+    {
+        std::lock_guard<std::mutex> lock(call);
+        auto chunks = input.chunk(micro_batches, 0);
+        for (auto& stage : stages) {
+            stage->inputs.assign(train ? chunks.size() : 0, at::Tensor());
+            stage->outputs.assign(train ? chunks.size() : 0, at::Tensor());
+        }
+        pending = train ? chunks.size() : 0;
+
+        for (size_t i = 0; i < chunks.size(); i++)
+            stages.front()->queue.push(Task{ Kind::Forward, train, (int64_t)i, chunks[i], nullptr });
+        return collect(chunks.size());
+    }
+
+    // Back-propagates each micro-batch's loss, accumulating the parameters' gradients.
+    void backward(const std::vector<at::Tensor>& losses)
+    {
+        std::lock_guard<std::mutex> lock(call);
+        if (pending == 0 || losses.size() != pending)
+            throw std::runtime_error("backward() needs one loss for each micro-batch of the preceding training forward().");
+        pending = 0;
+
+        for (size_t i = 0; i < losses.size(); i++)
+            stages.back()->queue.push(Task{ Kind::Backward, true, (int64_t)i, losses[i], nullptr });
+        collect(losses.size());
+    }
+
+    std::vector<int64_t> stage_sizes() const
+    {
+        std::vector<int64_t> sizes;
+        for (auto& stage : stages)
+            sizes.push_back(stage->modules.size());
+        return sizes;
+    }
+
+    std::vector<int64_t> stage_nodes() const
+    {
+        std::vector<int64_t> nodes;
+        for (auto& stage : stages)
+            nodes.push_back(stage->pinned ? stage->node : -1);
+        return nodes;
+    }
+
+private:
+    enum class Kind { Forward, Backward, Stop };
+
+    struct Task
+    {
+        Kind kind;
+        bool train;
+        int64_t index;
+        at::Tensor tensor;
+        std::exception_ptr error;
+    };
+
+    class TaskQueue
+    {
+    public:
+        explicit TaskQueue(size_t capacity) : capacity(capacity) {}
+
+        void push(Task task)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            not_full.wait(lock, [this]() { return tasks.size() < capacity; });
+            tasks.push_back(std::move(task));
+            not_empty.notify_one();
+        }
+
+        Task pop()
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            not_empty.wait(lock, [this]() { return !tasks.empty(); });
+            Task task = std::move(tasks.front());
+            tasks.pop_front();
+            not_full.notify_one();
+            return task;
+        }
+
+    private:
+        size_t capacity;
+        std::mutex mutex;
+        std::condition_variable not_empty;
+        std::condition_variable not_full;
+        std::deque<Task> tasks;
+    };
+
+    struct Stage
+    {
+        explicit Stage(size_t capacity) : queue(capacity) {}
+
+        std::vector<torch::nn::AnyModule> modules;
+        int node = -1;
+        bool pinned = false;
+        TaskQueue queue;
+        std::thread worker;
+        // The stage's input and output of every micro-batch in flight, kept for the backward pass.
+        std::vector<at::Tensor> inputs;
+        std::vector<at::Tensor> outputs;
+    };
+
+    std::shared_ptr<torch::nn::Module> sequential;
+    std::vector<std::unique_ptr<Stage>> stages;
+    TaskQueue results; // Unbounded, so that the stage feeding it never blocks.
+    std::mutex call;
+    size_t pending = 0;
+
+    std::vector<at::Tensor> collect(size_t count)
+    {
+        std::vector<at::Tensor> outputs(count);
+        std::exception_ptr error;
+        for (size_t i = 0; i < count; i++) {
+            auto task = results.pop();
+            if (task.error) {
+                if (!error) error = task.error;
+            }
+            else {
+                outputs[task.index] = task.tensor;
+            }
+        }
+        if (error) {
+            pending = 0;
+            std::rethrow_exception(error);
+        }
+        return outputs;
+    }
+
+    // Copies a tensor into memory first touched by the calling thread, which places its pages on the thread's node.
+    static void localize(at::Tensor& tensor)
+    {
+        if (!tensor.defined() || !tensor.is_cpu() || !tensor.is_contiguous() || tensor.numel() == 0)
+            return;
+        auto local = at::empty_like(tensor);
+        // A single-threaded copy: a parallel one would touch pages from intra-op threads on other nodes.
+        memcpy(local.data_ptr(), tensor.data_ptr(), tensor.nbytes());
+        tensor.set_(local);
+    }
+
+    void run_stage(size_t s, std::promise<void>& started)
+    {
+        auto& stage = *stages[s];
+        if (stage.node >= 0 && pin_thread_to_numa_node(stage.node)) {
+            stage.pinned = true;
+            try {
+                torch::NoGradGuard no_grad;
+                for (auto& m : stage.modules) {
+                    for (auto& p : m.ptr()->parameters()) localize(p);
+                    for (auto& b : m.ptr()->buffers()) localize(b);
+                }
+            }
+            catch (...) {
+                // Moving parameters is an optimization; they remain usable where they are.
+            }
+        }
+        started.set_value();
+
+        const bool last = s + 1 == stages.size();
+        for (;;) {
+            auto task = stage.queue.pop();
+            if (task.kind == Kind::Stop)
+                return;
+
+            if (!task.error) {
+                try {
+                    task.tensor = task.kind == Kind::Forward ? stage_forward(stage, s, task) : stage_backward(stage, s, task);
+                }
+                catch (...) {
+                    task.error = std::current_exception();
+                    task.tensor = at::Tensor();
+                }
+            }
+
+            if (task.kind == Kind::Forward)
+                (last ? results : stages[s + 1]->queue).push(std::move(task));
+            else
+                (s == 0 ? results : stages[s - 1]->queue).push(std::move(task));
+        }
+    }
+
+    at::Tensor stage_forward(Stage& stage, size_t s, const Task& task)
+    {
+        if (!task.train) {
+            torch::NoGradGuard no_grad;
+            at::Tensor x = task.tensor;
+            for (auto& m : stage.modules)
+                x = m.forward(x);
+            return x;
+        }
+
+        torch::AutoGradMode enable_grad(true);
+        // Cut the graph at the stage boundary; the previous stage back-propagates from its own output.
+        at::Tensor x = s == 0 ? task.tensor : task.tensor.detach().requires_grad_(true);
+        at::Tensor y = x;
+        for (auto& m : stage.modules)
+            y = m.forward(y);
+        stage.inputs[task.index] = x;
+        stage.outputs[task.index] = y;
+        return s + 1 == stages.size() ? y : y.detach();
+    }
+
+    at::Tensor stage_backward(Stage& stage, size_t s, const Task& task)
+    {
+        auto x = stage.inputs[task.index];
+        auto y = stage.outputs[task.index];
+        stage.inputs[task.index] = at::Tensor();
+        stage.outputs[task.index] = at::Tensor();
+        if (!y.defined())
+            throw std::runtime_error("The forward pass of this micro-batch did not complete.");
+
+        // The last stage receives the loss; the others, the gradient with respect to their output.
+        if (s + 1 == stages.size())
+            torch::autograd::backward({ task.tensor });
+        else if (y.requires_grad())
+            torch::autograd::backward({ y }, { task.tensor });
+
+        // The first stage's input is the caller's, whose gradient, if any, autograd has already accumulated.
+        if (s == 0)
+            return at::Tensor();
+        auto grad = x.grad();
+        return grad.defined() ? grad : torch::zeros_like(x);
+    }
+};
+
+// Splits layers into consecutive stages of roughly equal parameter counts; returns the first layer of each stage.
+static std::vector<size_t> balance_stages(torch::nn::SequentialImpl& sequential, size_t count)
+{
+    std::vector<int64_t> weights;
+    int64_t total = 0;
+    for (auto& layer : sequential) {
+        int64_t w = 1; // Layers without parameters still take time.
+        for (const auto& p : layer.ptr()->parameters())
+            w += p.numel();
+        weights.push_back(w);
+        total += w;
+    }
+
+    std::vector<size_t> starts = { 0 };
+    int64_t sum = 0;
+    for (size_t i = 0; i + 1 < weights.size() && starts.size() < count; i++) {
+        sum += weights[i];
+        const auto layers_left = weights.size() - i - 1;
+        const auto stages_left = count - starts.size();
+        if (layers_left == stages_left || sum * (int64_t)count >= total * (int64_t)starts.size())
+            starts.push_back(i + 1);
+    }
+    return starts;
+}
+
+Pipeline THSNN_Sequential_pipeline(const NNModule module, const int64_t* boundaries, const int boundaries_length, const int stages, const int* nodes, const int nodes_length, const int capacity)
+{
+    Pipeline res = nullptr;
+    CATCH(
+        auto sequential = (*module)->as<torch::nn::Sequential>();
+        if (sequential == nullptr)
+            throw std::runtime_error("Only Sequential modules can be pipelined.");
+
+        std::vector<size_t> starts;
+        if (boundaries != nullptr) {
+            starts.push_back(0);
+            for (int i = 0; i < boundaries_length; i++) {
+                if (boundaries[i] <= (int64_t)starts.back() || boundaries[i] >= (int64_t)sequential->size())
+                    throw std::runtime_error("Stage boundaries must be increasing layer indices within the Sequential.");
+                starts.push_back((size_t)boundaries[i]);
+            }
+        }
+        else {
+            if (stages < 1 || (size_t)stages > sequential->size())
+                throw std::runtime_error("The number of stages must be between one and the number of layers.");
+            starts = balance_stages(*sequential, (size_t)stages);
+        }
+        if (capacity < 1)
+            throw std::runtime_error("The queue capacity must be at least one.");
+
+        res = new std::shared_ptr<SequentialPipeline>(std::make_shared<SequentialPipeline>(*module, starts, std::vector<int>(nodes, nodes + nodes_length), (size_t)capacity));
+    );
+    return res;
+}
+
+void THSNN_Pipeline_forward(const Pipeline pipeline, const Tensor input, const int64_t micro_batches, const bool train, Tensor* (*allocator)(size_t length))
+{
+    CATCH(
+        auto outputs = (*pipeline)->forward(*input, micro_batches, train);
+        Tensor* result = allocator(outputs.size());
+        for (size_t i = 0; i < outputs.size(); i++)
+            result[i] = ResultTensor(outputs[i]);
+    );
+}
+
+void THSNN_Pipeline_backward(const Pipeline pipeline, const Tensor* losses, const int length)
+{
+    CATCH(
+        (*pipeline)->backward(toTensors<at::Tensor>((torch::Tensor**)losses, length));
+    );
+}
+
+void THSNN_Pipeline_stages(const Pipeline pipeline, int64_t* (*allocator)(size_t length))
+{
+    CATCH(
+        auto sizes = (*pipeline)->stage_sizes();
+        auto nodes = (*pipeline)->stage_nodes();
+        int64_t* result = allocator(2 * sizes.size());
+        for (size_t i = 0; i < sizes.size(); i++) {
+            result[2 * i] = sizes[i];
+            result[2 * i + 1] = nodes[i];
+        }
+    );
+}
+
+void THSNN_Pipeline_dispose(const Pipeline pipeline)
+{
+    delete pipeline;
+}
+
 Tensor THSNN_one_hot(const Tensor self, const int64_t num_classes)
 {
     CATCH_RETURN_Tensor(
@@ -7,6 +7,9 @@
 
 #include "Utils.h"
 
+// Called whenever modules, parameters or buffers are registered, to invalidate cached parameter tables.
+void notify_module_structure_changed();
+
 // API.
 
 EXPORT_API(int)         THSNN_Module_has_parameter(const NNModule module, const char* name);
@@ -19,23 +22,46 @@ EXPORT_API(void)        THSNN_Module_get_parameters(const NNModule module, Tenso
 EXPORT_API(int)         THSNN_Module_is_training(NNModule module);
 EXPORT_API(void)        THSNN_Module_train(NNModule module);
 EXPORT_API(void)        THSNN_Module_eval(NNModule module);
+EXPORT_API(ParameterTable) THSNN_Module_parameter_table(const NNModule module);
+EXPORT_API(int)         THSNN_ParameterTable_refresh(const ParameterTable table);
+EXPORT_API(void)        THSNN_ParameterTable_get_parameters(const ParameterTable table, Tensor* (*allocator1)(size_t length), const char** (*allocator2)(size_t length));
+EXPORT_API(void)        THSNN_ParameterTable_get_buffers(const ParameterTable table, Tensor* (*allocator1)(size_t length), const char** (*allocator2)(size_t length));
+EXPORT_API(void)        THSNN_ParameterTable_get_modules(const ParameterTable table, NNModule* (*allocator1)(size_t length), const char** (*allocator2)(size_t length));
+EXPORT_API(void)        THSNN_ParameterTable_dispose(const ParameterTable table);
+EXPORT_API(WeightAverage) THSNN_Module_weight_average(const NNModule module, const double decay, const bool warmup, const bool include_buffers);
+EXPORT_API(void)        THSNN_WeightAverage_update(const WeightAverage average);
+EXPORT_API(void)        THSNN_WeightAverage_swap(const WeightAverage average);
+EXPORT_API(int)         THSNN_WeightAverage_is_swapped(const WeightAverage average);
+EXPORT_API(int64_t)     THSNN_WeightAverage_updates(const WeightAverage average);
+EXPORT_API(double)      THSNN_WeightAverage_decay(const WeightAverage average);
+EXPORT_API(void)        THSNN_WeightAverage_get_averages(const WeightAverage average, Tensor* (*allocator1)(size_t length), const char** (*allocator2)(size_t length));
+EXPORT_API(void)        THSNN_WeightAverage_dispose(const WeightAverage average);
 EXPORT_API(long)        THSNN_Module_children_size(const NNModule module);
 EXPORT_API(NNModule)    THSNN_Module_child(const NNModule module, const int index);
 EXPORT_API(const char*) THSNN_Module_name(const NNModule module);
 EXPORT_API(void)        THSNN_Module_zero_grad(const NNModule module);
 EXPORT_API(void)        THSNN_Module_save(const NNModule module, const char* location);
 EXPORT_API(NNModule)    THSNN_Module_load(const char* location);
+EXPORT_API(void)        THSNN_Module_load_state_dict_file(const NNModule module, const char* location, bool strict, bool zero_copy);
+EXPORT_API(AsyncCheckpoint) THSNN_Module_save_async(const NNModule module, const char* location, const Optimizer optimizer, const char* optimizer_location);
+EXPORT_API(int)         THSNN_AsyncCheckpoint_is_completed(const AsyncCheckpoint checkpoint);
+EXPORT_API(void)        THSNN_AsyncCheckpoint_wait(const AsyncCheckpoint checkpoint);
+EXPORT_API(void)        THSNN_AsyncCheckpoint_dispose(const AsyncCheckpoint checkpoint);
+EXPORT_API(void)        THSNN_Module_load_checkpoint(const NNModule module, const char* location);
+EXPORT_API(void)        THSNN_Module_clear_checkpoint_staging();
 EXPORT_API(void)        THSNN_Module_register_buffer(const NNModule module, const char* name, const Tensor submodule);
 EXPORT_API(void)        THSNN_Module_register_parameter(const NNModule module, const char* name, const Tensor tensor, bool requires_grad);
 EXPORT_API(void)        THSNN_Module_register_module(const NNModule module, const char* name, const NNModule submodule);
 EXPORT_API(void)        THSNN_Module_dispose(const NNModule module);
 EXPORT_API(void)        THSNN_Module_to_device(NNModule module, int64_t device, int64_t index);
 EXPORT_API(void)        THSNN_Module_to_dtype(NNModule module, int8_t dtype);
+EXPORT_API(void)        THSNN_Module_profile_cost(const NNModule module, const int64_t* shape, const int length, const int8_t dtype, int64_t* (*allocator1)(size_t length), const char** (*allocator2)(size_t length));
 
 EXPORT_API(void)        THSNN_AnyModule_dispose(const NNAnyModule module);
 //EXPORT_API(NNModule)    THSNN_AnyModule_get(const NNAnyModule module);
 
 EXPORT_API(NNModule) THSNN_custom_module(const char* name, Tensor(*forward)(Tensor), NNAnyModule* outAsAnyModule);
+EXPORT_API(NNModule) THSNN_custom_module_batched(const char* name, void(*forward)(const Tensor*, int, Tensor*), int traits, NNAnyModule* outAsAnyModule);
 
 // Pooling
 
@@ -174,6 +200,10 @@ EXPORT_API(Tensor)     THSNN_BatchNorm1d_get_var(const NNModule module);
 EXPORT_API(Tensor)     THSNN_BatchNorm2d_get_var(const NNModule module);
 EXPORT_API(Tensor)     THSNN_BatchNorm3d_get_var(const NNModule module);
 
+EXPORT_API(NNModule) THSNN_SyncBatchNorm_ctor(const int64_t features, const double eps, const double momentum, const bool affine, const bool track_running_stats, const ProcessGroup group, NNAnyModule* outAsAnyModule);
+EXPORT_API(Tensor)   THSNN_SyncBatchNorm_forward(const NNModule module, const Tensor tensor);
+EXPORT_API(void)     THSNN_SyncBatchNorm_reset_stats(const NNModule module);
+
 EXPORT_API(NNModule) THSNN_InstanceNorm1d_ctor(const int64_t features, const double eps, const double momentum, const bool affine, const bool track_running_stats, NNAnyModule* outAsAnyModule);
 EXPORT_API(Tensor)   THSNN_InstanceNorm1d_forward(const NNModule module, const Tensor tensor);
 EXPORT_API(NNModule) THSNN_InstanceNorm2d_ctor(const int64_t features, const double eps, const double momentum, const bool affine, const bool track_running_stats, NNAnyModule* outAsAnyModule);
@@ -326,6 +356,20 @@ EXPORT_API(Tensor)   THSNN_LSTMCell_forward(const NNModule module, const Tensor
 EXPORT_API(NNModule) THSNN_Sequential_ctor();
 EXPORT_API(void)     THSNN_Sequential_push_back(const NNModule module, const char* name, const NNAnyModule submodule);
 EXPORT_API(Tensor)   THSNN_Sequential_forward(const NNModule module, const Tensor tensor);
+EXPORT_API(void)     THSNN_Sequential_forward_batch(const NNModule module, const Tensor* inputs, const int length, Tensor* outputs);
+EXPORT_API(SequentialPlan) THSNN_Sequential_plan(const NNModule module, const Tensor example);
+EXPORT_API(Tensor)   THSNN_SequentialPlan_forward(const SequentialPlan plan, const Tensor input);
+EXPORT_API(int64_t)  THSNN_SequentialPlan_workspace_bytes(const SequentialPlan plan);
+EXPORT_API(void)     THSNN_SequentialPlan_dispose(const SequentialPlan plan);
+EXPORT_API(PerSampleTrace) THSNN_Sequential_per_sample_forward(const NNModule module, const Tensor input, Tensor* output);
+EXPORT_API(void)     THSNN_PerSampleTrace_grads(const PerSampleTrace trace, const Tensor loss, Tensor* (*allocator)(size_t length));
+EXPORT_API(Tensor)   THSNN_PerSampleTrace_clip_and_accumulate(const PerSampleTrace trace, const Tensor loss, const double max_norm);
+EXPORT_API(void)     THSNN_PerSampleTrace_dispose(const PerSampleTrace trace);
+EXPORT_API(Pipeline) THSNN_Sequential_pipeline(const NNModule module, const int64_t* boundaries, const int boundaries_length, const int stages, const int* nodes, const int nodes_length, const int capacity);
+EXPORT_API(void)     THSNN_Pipeline_forward(const Pipeline pipeline, const Tensor input, const int64_t micro_batches, const bool train, Tensor* (*allocator)(size_t length));
+EXPORT_API(void)     THSNN_Pipeline_backward(const Pipeline pipeline, const Tensor* losses, const int length);
+EXPORT_API(void)     THSNN_Pipeline_stages(const Pipeline pipeline, int64_t* (*allocator)(size_t length));
+EXPORT_API(void)     THSNN_Pipeline_dispose(const Pipeline pipeline);
 
 // Loss functions
 
@@ -368,6 +412,12 @@ EXPORT_API(void)   THSNN_Optimizer_zero_grad(const Optimizer optimizer);
 EXPORT_API(void)   THSNN_Optimizer_getParameters(const Optimizer optimizer, Tensor* (*allocator)(size_t length));
 EXPORT_API(Tensor) THSNN_Optimizer_step(const Optimizer optimizer, Tensor(*loss_closure)());
 
+// One training iteration - zero_grad, forward, loss, backward, optional gradient clipping and step - in a single call.
+EXPORT_API(double) THSNN_train_step(const NNModule module, const NNAnyModule boxed, const Tensor input, const Tensor target, const int64_t loss_kind, const Optimizer optimizer, const double max_norm, const int64_t accumulation_steps);
+
+EXPORT_API(void) THSNN_Optimizer_save(const Optimizer optimizer, const char* location);
+EXPORT_API(void) THSNN_Optimizer_load(const Optimizer optimizer, const char* location);
+
 EXPORT_API(void) THSNN_Optimizer_dispose(const Optimizer optimizer);
 
 EXPORT_API(void) THSNN_Adagrad_set_lr(const Optimizer optimizer, const double lr);
@@ -57,6 +57,174 @@ Tensor THSNN_BatchNorm3d_forward(const NNModule module, const Tensor tensor)
     CATCH_TENSOR((*module)->as<torch::nn::BatchNorm3d>()->forward(*tensor));
 }
 
+// Gathers a tensor from all ranks of a process group, stacked in rank order along a new leading dimension.
+// Every rank uses every rank's contribution, so the gradient of a rank's input is the sum over all ranks of
+// the gradients of its row; backward therefore has to be run by all ranks as well.
+class AllGatherFunction : public torch::autograd::Function<AllGatherFunction>
+{
+public:
+    static torch::Tensor forward(torch::autograd::AutogradContext* ctx, const torch::Tensor& input, int64_t group_id)
+    {
+        ctx->saved_data["group"] = group_id;
+        return find_group(group_id)->all_gather(input);
+    }
+
+    static torch::autograd::variable_list backward(torch::autograd::AutogradContext* ctx, torch::autograd::variable_list grad_outputs)
+    {
+        torch::NoGradGuard no_grad;
+        auto group = find_group(ctx->saved_data["group"].toInt());
+        auto grad = grad_outputs[0].clone();
+        group->all_reduce_sum_(grad);
+        return { grad[group->rank()], torch::Tensor() };
+    }
+
+private:
+    static std::shared_ptr<SharedMemoryProcessGroup> find_group(int64_t id)
+    {
+        auto group = SharedMemoryProcessGroup::find(id);
+        if (group == nullptr)
+            throw std::runtime_error("The process group used by SyncBatchNorm has been disposed.");
+        return group;
+    }
+};
+
+// Batch normalization over the union of the batches of all ranks of a process group. Each rank computes the
+// per-channel count, mean and sum of squared deviations (M2) of its local batch, and the ranks exchange them in
+// a single collective of 3 x C values each. The global statistics are combined from those with Chan et al.'s
+// parallel formula, as PyTorch's batch_norm_gather_stats_with_counts does, which stays accurate when the
+// activations have a large mean relative to their spread. Backward costs one more collective.
+class SyncBatchNormImpl : public torch::nn::Cloneable<SyncBatchNormImpl>
+{
+public:
+    SyncBatchNormImpl(const torch::nn::BatchNormOptions& options, std::shared_ptr<SharedMemoryProcessGroup> group)
+        : options(options), group(std::move(group))
+    {
+        reset();
+    }
+
+    void reset() override
+    {
+        const auto features = options.num_features();
+        if (options.affine()) {
+            weight = register_parameter("weight", torch::ones({ features }));
+            bias = register_parameter("bias", torch::zeros({ features }));
+        }
+        if (options.track_running_stats()) {
+            running_mean = register_buffer("running_mean", torch::zeros({ features }));
+            running_var = register_buffer("running_var", torch::ones({ features }));
+            num_batches_tracked = register_buffer("num_batches_tracked", torch::tensor(0, torch::dtype(torch::kLong)));
+        }
+    }
+
+    void reset_running_stats()
+    {
+        if (options.track_running_stats()) {
+            torch::NoGradGuard no_grad;
+            running_mean.zero_();
+            running_var.fill_(1);
+            num_batches_tracked.zero_();
+        }
+    }
+
+    torch::Tensor forward(const torch::Tensor& input)
+    {
+        const auto features = options.num_features();
+        if (input.dim() < 2 || input.size(1) != features)
+            throw std::runtime_error("SyncBatchNorm expects an input of shape (N, C, ...) with C equal to the number of features.");
+
+        std::vector<int64_t> shape(input.dim(), 1);
+        shape[1] = features;
+
+        torch::Tensor mean, var;
+        if (is_training() || !options.track_running_stats()) {
+            std::vector<int64_t> dims;
+            for (int64_t d = 0; d < input.dim(); d++)
+                if (d != 1) dims.push_back(d);
+
+            const double n = (double)(input.numel() / features);
+            auto local_mean = input.sum(dims) / std::max(n, 1.0);
+            auto local_m2 = (input - local_mean.view(shape)).pow(2).sum(dims);
+            auto count = torch::full({ features }, n, input.options().requires_grad(false));
+            auto gathered = AllGatherFunction::apply(torch::stack({ count, local_mean, local_m2 }), group->id());
+
+            // gathered is [world_size, 3, C]: per rank, the count, mean and M2 of each channel.
+            auto counts = gathered.select(1, 0);
+            auto means = gathered.select(1, 1);
+            auto m2s = gathered.select(1, 2);
+            auto total = counts.sum(0);
+            mean = (counts * means).sum(0) / total;
+            var = (m2s + counts * (means - mean.unsqueeze(0)).pow(2)).sum(0) / total;
+
+            if (is_training() && options.track_running_stats()) {
+                torch::NoGradGuard no_grad;
+                num_batches_tracked += 1;
+                const double momentum = options.momentum().has_value()
+                    ? options.momentum().value()
+                    : 1.0 / num_batches_tracked.item<double>();
+                auto unbiased = var * total / (total - 1).clamp_min(1);
+                running_mean.mul_(1 - momentum).add_(mean.detach() * momentum);
+                running_var.mul_(1 - momentum).add_(unbiased.detach() * momentum);
+            }
+        }
+        else {
+            mean = running_mean;
+            var = running_var;
+        }
+
+        auto output = (input - mean.view(shape)) * torch::rsqrt(var.view(shape) + options.eps());
+        if (options.affine())
+            output = output * weight.view(shape) + bias.view(shape);
+        return output;
+    }
+
+    void pretty_print(std::ostream& stream) const override
+    {
+        stream << "SyncBatchNorm(" << options.num_features()
+            << ", eps=" << options.eps()
+            << ", affine=" << options.affine()
+            << ", track_running_stats=" << options.track_running_stats()
+            << ", world_size=" << group->world_size() << ")";
+    }
+
+    torch::nn::BatchNormOptions options;
+    std::shared_ptr<SharedMemoryProcessGroup> group;
+
+    torch::Tensor weight;
+    torch::Tensor bias;
+    torch::Tensor running_mean;
+    torch::Tensor running_var;
+    torch::Tensor num_batches_tracked;
+};
+
+NNModule THSNN_SyncBatchNorm_ctor(const int64_t features, const double eps, const double momentum, const bool affine, const bool track_running_stats, const ProcessGroup group, NNAnyModule* outAsAnyModule)
+{
+    CATCH_RETURN_NNModule(
+        auto opts = torch::nn::BatchNormOptions(features)
+        .eps(eps)
+        .momentum(momentum)
+        .affine(affine)
+        .track_running_stats(track_running_stats);
+
+    auto mod = std::make_shared<SyncBatchNormImpl>(opts, *group);
+    if (outAsAnyModule != NULL)
+    {
+        auto wrapped = std::make_shared<torch::nn::AnyModule>(torch::nn::ModuleHolder<SyncBatchNormImpl>(mod));
+        *outAsAnyModule = new std::shared_ptr<torch::nn::AnyModule>(wrapped);
+    }
+    res = new std::shared_ptr<torch::nn::Module>(mod);
+    );
+}
+
+Tensor THSNN_SyncBatchNorm_forward(const NNModule module, const Tensor tensor)
+{
+    CATCH_TENSOR((*module)->as<SyncBatchNormImpl>()->forward(*tensor));
+}
+
+void THSNN_SyncBatchNorm_reset_stats(const NNModule module)
+{
+    CATCH((*module)->as<SyncBatchNormImpl>()->reset_running_stats(););
+}
+
 NNModule THSNN_GroupNorm_ctor(const int64_t num_groups, const int64_t num_channels, const double eps, const bool affine, NNAnyModule* outAsAnyModule)
 {
     CATCH_RETURN_NNModule(
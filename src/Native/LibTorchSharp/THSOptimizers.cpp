@@ -177,6 +177,26 @@ void THSNN_SGD_set_lr(const Optimizer optimizer, const double lr)
     SetLearningRate<torch::optim::SGDOptions>(optimizer, lr);
 }
 
+void THSNN_Optimizer_save(const Optimizer optimizer, const char* location)
+{
+    CATCH(
+        auto output = torch::serialize::OutputArchive();
+
+    (*optimizer)->save(output);
+    output.save_to(location);
+    );
+}
+
+void THSNN_Optimizer_load(const Optimizer optimizer, const char* location)
+{
+    CATCH(
+        auto input = torch::serialize::InputArchive();
+
+    input.load_from(location);
+    (*optimizer)->load(input);
+    );
+}
+
 void THSNN_Optimizer_dispose(const Optimizer optimizer)
 {
     delete optimizer; // NOTE: this reduces the ref count on the shared_ptr
@@ -51,6 +51,98 @@ Tensor THSTensor_multinomial(const Tensor tensor, const int64_t num_samples, con
     CATCH_TENSOR(gen == nullptr ? tensor->multinomial(num_samples, replacement) : tensor->multinomial(num_samples, replacement, *gen));
 }
 
+// Walker's alias method: after an O(n) setup, each sample costs one uniform draw and one table lookup,
+// independently of the number of categories. Samples are drawn as a batch of tensor operations.
+class AliasTable
+{
+public:
+    at::Tensor probabilities; // The probability of keeping category i rather than taking alias[i].
+    at::Tensor aliases;
+
+    at::Tensor sample(at::IntArrayRef shape, const Generator gen) const
+    {
+        const auto n = probabilities.size(0);
+        auto generator = gen == nullptr ? c10::optional<at::Generator>() : c10::optional<at::Generator>(*gen);
+
+        // One uniform draw gives both the column, from its integer part, and the coin, from its fraction.
+        auto u = torch::rand(shape, generator, probabilities.options()).mul_(n);
+        auto column = u.floor().clamp_max_(n - 1);
+        auto coin = u.sub_(column);
+        auto index = column.to(at::kLong);
+
+        auto keep = coin.lt(probabilities.take(index));
+        return torch::where(keep, index, aliases.take(index));
+    }
+};
+
+// Vose's construction of the alias table, in double precision on the CPU.
+static std::shared_ptr<AliasTable> build_alias_table(const at::Tensor& probs)
+{
+    if (probs.dim() != 1 || probs.size(0) == 0)
+        throw std::runtime_error("The probabilities must be a non-empty vector.");
+
+    auto p = probs.detach().to(at::kCPU, at::kDouble).contiguous();
+    const auto n = p.size(0);
+    const auto total = p.sum().item<double>();
+    if (!(total > 0) || !std::isfinite(total) || p.lt(0).any().item<bool>())
+        throw std::runtime_error("The probabilities must be non-negative and finite, with a positive sum.");
+
+    std::vector<double> scaled(p.data_ptr<double>(), p.data_ptr<double>() + n);
+    for (auto& x : scaled)
+        x = x * n / total;
+
+    auto probabilities = torch::ones({ n }, at::kDouble);
+    auto aliases = torch::arange(n, at::kLong);
+    auto prob = probabilities.data_ptr<double>();
+    auto alias = aliases.data_ptr<int64_t>();
+
+    std::vector<int64_t> small, large;
+    for (int64_t i = 0; i < n; i++)
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+
+    while (!small.empty() && !large.empty()) {
+        auto s = small.back();
+        small.pop_back();
+        auto l = large.back();
+        large.pop_back();
+
+        prob[s] = scaled[s];
+        alias[s] = l;
+        scaled[l] = (scaled[l] + scaled[s]) - 1.0;
+        (scaled[l] < 1.0 ? small : large).push_back(l);
+    }
+    // Whatever remains is, up to rounding, exactly 1, and keeps the probability of 1 set above.
+
+    auto table = std::make_shared<AliasTable>();
+    table->probabilities = probabilities.to(probs.device());
+    table->aliases = aliases.to(probs.device());
+    return table;
+}
+
+AliasSampler THSTensor_alias_sampler_create(const Tensor probs)
+{
+    AliasSampler res = nullptr;
+    CATCH(
+        res = new std::shared_ptr<AliasTable>(build_alias_table(*probs));
+    );
+    return res;
+}
+
+Tensor THSTensor_alias_sampler_sample(const AliasSampler sampler, const int64_t* shape, const int length, const Generator gen)
+{
+    CATCH_TENSOR((*sampler)->sample(at::ArrayRef<int64_t>(shape, length), gen));
+}
+
+int64_t THSTensor_alias_sampler_categories(const AliasSampler sampler)
+{
+    return (*sampler)->probabilities.size(0);
+}
+
+void THSTensor_alias_sampler_dispose(const AliasSampler sampler)
+{
+    delete sampler;
+}
+
 Tensor THSTensor_poisson(const Tensor tensor, const Generator gen)
 {
     CATCH_TENSOR(gen == nullptr ? torch::poisson(*tensor) : torch::poisson(*tensor, *gen))
@@ -370,7 +370,7 @@ void THSTensor_free(const Tensor tensor)
 
 void THSTensor_dispose(const Tensor tensor)
 {
-    delete tensor;
+    dispose_tensor_handle(tensor);
 }
 
 Tensor THSTensor_digamma(const Tensor tensor)
@@ -470,6 +470,11 @@ Tensor THSTensor_gelu(const Tensor tensor)
     CATCH_TENSOR(torch::gelu(*tensor));
 }
 
+Tensor THSTensor_gelu_out(const Tensor tensor, const Tensor out)
+{
+    CATCH_TENSOR(torch::gelu_out(*out, *tensor));
+}
+
 Tensor THSTensor_get1(const Tensor tensor, int64_t index)
 {
     CATCH_TENSOR((*tensor)[index]);
@@ -725,6 +730,108 @@ Tensor THSTensor_index_put_scalar_(Tensor tensor,
     CATCH_TENSOR(tensor->index_put_(indices, *value));
 }
 
+// An indexing expression decoded once by THSTensor_index_plan_create, so that applying it
+// to many tensors skips completeTensorIndices.
+class TensorIndexPlan
+{
+public:
+    std::vector<at::indexing::TensorIndex> indices;
+    // True when every entry is an integer or a slice; such plans are applied as a chain of
+    // select/slice views instead of going through the generic indexing dispatcher.
+    bool is_view;
+};
+
+static at::Tensor apply_view_plan(const at::Tensor& tensor, const TensorIndexPlan& plan)
+{
+    at::Tensor result = tensor;
+    int64_t dim = 0;
+    for (const auto& idx : plan.indices) {
+        if (idx.is_integer()) {
+            result = result.select(dim, idx.integer());
+        }
+        else {
+            const auto& slice = idx.slice();
+            result = result.slice(dim, slice.start(), slice.stop(), slice.step());
+            dim += 1;
+        }
+    }
+    return result;
+}
+
+static at::Tensor apply_index_plan(const at::Tensor& tensor, const TensorIndexPlan& plan)
+{
+    return plan.is_view ? apply_view_plan(tensor, plan) : tensor.index(plan.indices);
+}
+
+static at::Tensor& put_index_plan(at::Tensor& tensor, const TensorIndexPlan& plan, const at::Tensor& value)
+{
+    if (plan.is_view)
+        apply_view_plan(tensor, plan).copy_(value);
+    else
+        tensor.index_put_(plan.indices, value);
+    return tensor;
+}
+
+static at::Tensor& put_index_plan(at::Tensor& tensor, const TensorIndexPlan& plan, const at::Scalar& value)
+{
+    if (plan.is_view)
+        apply_view_plan(tensor, plan).fill_(value);
+    else
+        tensor.index_put_(plan.indices, value);
+    return tensor;
+}
+
+IndexPlan THSTensor_index_plan_create(
+    const int64_t* indexStarts,
+    const int64_t* indexEnds,
+    const int64_t* indexSteps,
+    const Tensor* indexTensors,
+    const int indicesLength)
+{
+    IndexPlan res = nullptr;
+    at::indexing::TensorIndex* indicesArray = (at::indexing::TensorIndex*)alloca(indicesLength * sizeof(at::indexing::TensorIndex));
+    memset(indicesArray, 0, indicesLength * sizeof(at::indexing::TensorIndex));
+    CATCH(
+        completeTensorIndices(indexStarts, indexEnds, indexSteps, indexTensors, indicesArray, indicesLength);
+
+        auto plan = std::make_shared<TensorIndexPlan>();
+        plan->indices.reserve(indicesLength);
+        plan->is_view = true;
+        for (int i = 0; i < indicesLength; i++) {
+            plan->indices.push_back(indicesArray[i]);
+            if (!indicesArray[i].is_integer() && !indicesArray[i].is_slice())
+                plan->is_view = false;
+        }
+        res = new std::shared_ptr<TensorIndexPlan>(plan);
+    );
+    return res;
+}
+
+int THSTensor_index_plan_is_view(const IndexPlan plan)
+{
+    return (*plan)->is_view;
+}
+
+void THSTensor_index_plan_dispose(const IndexPlan plan)
+{
+    delete plan;
+}
+
+Tensor THSTensor_index_plan_apply(const Tensor tensor, const IndexPlan plan)
+{
+    CATCH_TENSOR(apply_index_plan(*tensor, **plan));
+}
+
+Tensor THSTensor_index_plan_put_(Tensor tensor, const IndexPlan plan, const Tensor value)
+{
+    CATCH_TENSOR(put_index_plan(*tensor, **plan, *value));
+}
+
+Tensor THSTensor_index_plan_put_scalar_(Tensor tensor, const IndexPlan plan, const Scalar value)
+{
+    CATCH_TENSOR(put_index_plan(*tensor, **plan, *value));
+}
+
 Tensor THSTensor_index_select(Tensor tensor, int64_t dim, Tensor index)
 {
     CATCH_TENSOR(tensor->index_select(dim, *index));
@@ -780,6 +887,130 @@ Tensor THSTensor_load(const char* location)
     );
 }
 
+// The mapped tensor container format. Everything is little-endian:
+//
+//   header:  magic "THSM", uint32 version, uint64 entry count
+//   entries: uint32 name length, name bytes, int32 dtype, uint32 rank, int64 dims[rank], uint64 offset, uint64 byte count
+//   data:    each tensor's contiguous bytes, starting at a page-aligned offset from the start of the file
+//
+// Because the data is page-aligned, a mapped file can be viewed in place, and loading costs only the page faults
+// for the data that is actually touched.
+
+static const char mapped_magic[4] = { 'T', 'H', 'S', 'M' };
+static const uint32_t mapped_version = 1;
+static const uint64_t mapped_alignment = 4096;
+
+template<typename T>
+static T read_mapped(const uint8_t*& ptr, const uint8_t* end)
+{
+    if ((size_t)(end - ptr) < sizeof(T))
+        throw std::runtime_error("Malformed tensor file: truncated header.");
+    T value;
+    memcpy(&value, ptr, sizeof(T));
+    ptr += sizeof(T);
+    return value;
+}
+
+// Creates views of the tensors laid out in a memory region, either a MappedFile or SharedMemory.
+template<typename Region>
+static void view_mapped(const std::shared_ptr<Region>& file, const char* location, std::vector<std::string>& names, std::vector<at::Tensor>& tensors)
+{
+    const uint8_t* ptr = file->data();
+    const uint8_t* end = ptr + file->size();
+
+    if (file->size() < sizeof(mapped_magic) || memcmp(ptr, mapped_magic, sizeof(mapped_magic)) != 0)
+        throw std::runtime_error(std::string("Not a mapped tensor file: ") + location);
+    ptr += sizeof(mapped_magic);
+
+    auto version = read_mapped<uint32_t>(ptr, end);
+    if (version != mapped_version)
+        throw std::runtime_error("Unsupported mapped tensor file version: " + std::to_string(version));
+
+    auto count = read_mapped<uint64_t>(ptr, end);
+
+    for (uint64_t i = 0; i < count; i++)
+    {
+        auto nameLength = read_mapped<uint32_t>(ptr, end);
+        if ((size_t)(end - ptr) < nameLength)
+            throw std::runtime_error("Malformed tensor file: truncated header.");
+        names.emplace_back((const char*)ptr, nameLength);
+        ptr += nameLength;
+
+        auto dtype = read_mapped<int32_t>(ptr, end);
+        if (dtype < 0 || dtype >= (int32_t)at::ScalarType::NumOptions)
+            throw std::runtime_error("Unsupported element type for '" + names.back() + "' in mapped tensor file.");
+
+        auto rank = read_mapped<uint32_t>(ptr, end);
+        std::vector<int64_t> shape(rank);
+        uint64_t numel = 1;
+        for (uint32_t d = 0; d < rank; d++)
+        {
+            shape[d] = read_mapped<int64_t>(ptr, end);
+            if (shape[d] < 0)
+                throw std::runtime_error("Malformed tensor file: negative dimension for '" + names.back() + "'.");
+            numel *= (uint64_t)shape[d];
+        }
+
+        auto offset = read_mapped<uint64_t>(ptr, end);
+        auto nbytes = read_mapped<uint64_t>(ptr, end);
+
+        auto options = at::TensorOptions().dtype((at::ScalarType)dtype);
+        if (offset > file->size() || nbytes > file->size() - offset || nbytes != numel * c10::elementSize((at::ScalarType)dtype))
+            throw std::runtime_error("Malformed tensor file: bad data extent for '" + names.back() + "'.");
+
+        // Every tensor holds on to the mapping, which goes away with the last one.
+        tensors.push_back(torch::from_blob(file->data() + offset, shape, [file](void*) {}, options));
+    }
+}
+
+static void load_mapped(const char* location, std::vector<std::string>& names, std::vector<at::Tensor>& tensors)
+{
+    view_mapped(std::make_shared<MappedFile>(location), location, names, tensors);
+}
+
+void THSTensor_load_mapped(const char* location, Tensor* (*allocator1)(size_t length), const char** (*allocator2)(size_t length))
+{
+    CATCH(
+        std::vector<std::string> names;
+        std::vector<at::Tensor> tensors;
+        load_mapped(location, names, tensors);
+
+        Tensor* result1 = allocator1(tensors.size());
+        const char** result2 = allocator2(names.size());
+
+        for (size_t i = 0; i < tensors.size(); i++)
+        {
+            result1[i] = ResultTensor(tensors[i]);
+            result2[i] = make_sharable_string(names[i]);
+        }
+    );
+}
+
+void THSTensor_load_shared(const char* name, Tensor* (*allocator1)(size_t length), const char** (*allocator2)(size_t length))
+{
+    CATCH(
+        std::vector<std::string> names;
+        std::vector<at::Tensor> tensors;
+        view_mapped(std::make_shared<SharedMemory>(name), name, names, tensors);
+
+        Tensor* result1 = allocator1(tensors.size());
+        const char** result2 = allocator2(names.size());
+
+        for (size_t i = 0; i < tensors.size(); i++)
+        {
+            result1[i] = ResultTensor(tensors[i]);
+            result2[i] = make_sharable_string(names[i]);
+        }
+    );
+}
+
+void THSTensor_unlink_shared(const char* name)
+{
+    CATCH(
+        SharedMemory::unlink(name);
+    );
+}
+
 Tensor THSTensor_log_sigmoid(const Tensor tensor)
 {
     CATCH_TENSOR(torch::log_sigmoid(*tensor));
@@ -859,6 +1090,15 @@ Tensor THSTensor_mean_along_dimensions(const Tensor tensor, const int64_t* dimen
         tensor->mean(at::ArrayRef<int64_t>(dimensions, length), keepdim))
 }
 
+Tensor THSTensor_mean_along_dimensions_out(const Tensor tensor, const int64_t* dimensions, int length, bool keepdim, bool has_type, const int8_t dtype, const Tensor out)
+{
+    CATCH_TENSOR(
+        has_type ?
+        torch::mean_out(*out, *tensor, at::ArrayRef<int64_t>(dimensions, length), keepdim, (c10::ScalarType)dtype)
+        :
+        torch::mean_out(*out, *tensor, at::ArrayRef<int64_t>(dimensions, length), keepdim))
+}
+
 Tensor THSTensor_median(const Tensor tensor)
 {
     CATCH_TENSOR(tensor->median());
@@ -1005,6 +1245,12 @@ Tensor THSTensor_relu(const Tensor tensor)
     CATCH_TENSOR(torch::relu(*tensor));
 }
 
+Tensor THSTensor_relu_out(const Tensor tensor, const Tensor out)
+{
+    // ATen has no relu.out overload; clamp_min.out computes the same values.
+    CATCH_TENSOR(torch::clamp_min_out(*out, *tensor, 0));
+}
+
 Tensor THSTensor_relu_(const Tensor tensor)
 {
     CATCH_TENSOR(torch::relu_(*tensor));
@@ -1042,6 +1288,123 @@ void THSTensor_save(const Tensor tensor, const char* location)
     );
 }
 
+template<typename T>
+static void append_mapped(std::string& header, const T value)
+{
+    header.append((const char*)&value, sizeof(T));
+}
+
+// Lays out the header, so that all data offsets are known before anything is written. Returns the total size.
+static uint64_t layout_mapped(const std::vector<at::Tensor>& tensors, const std::vector<std::string>& names, std::string& header, std::vector<uint64_t>& offsets)
+{
+    uint64_t headerSize = sizeof(mapped_magic) + sizeof(uint32_t) + sizeof(uint64_t);
+    for (size_t i = 0; i < tensors.size(); i++)
+        headerSize += sizeof(uint32_t) + names[i].size() + sizeof(int32_t) + sizeof(uint32_t) + tensors[i].dim() * sizeof(int64_t) + 2 * sizeof(uint64_t);
+
+    uint64_t offset = headerSize;
+    for (auto& t : tensors)
+    {
+        offset = (offset + mapped_alignment - 1) / mapped_alignment * mapped_alignment;
+        offsets.push_back(offset);
+        offset += t.nbytes();
+    }
+
+    header.reserve(headerSize);
+    header.append(mapped_magic, sizeof(mapped_magic));
+    append_mapped<uint32_t>(header, mapped_version);
+    append_mapped<uint64_t>(header, tensors.size());
+
+    for (size_t i = 0; i < tensors.size(); i++)
+    {
+        append_mapped<uint32_t>(header, (uint32_t)names[i].size());
+        header.append(names[i]);
+        append_mapped<int32_t>(header, (int32_t)tensors[i].scalar_type());
+        append_mapped<uint32_t>(header, (uint32_t)tensors[i].dim());
+        for (auto d : tensors[i].sizes())
+            append_mapped<int64_t>(header, d);
+        append_mapped<uint64_t>(header, offsets[i]);
+        append_mapped<uint64_t>(header, tensors[i].nbytes());
+    }
+    return offset;
+}
+
+static void save_mapped(const std::vector<at::Tensor>& tensors, const std::vector<std::string>& names, const char* location)
+{
+    std::string header;
+    std::vector<uint64_t> offsets;
+    layout_mapped(tensors, names, header, offsets);
+
+    std::ofstream stream(location, std::ios::binary | std::ios::trunc);
+    if (!stream)
+        throw std::runtime_error(std::string("Could not open file for writing: ") + location);
+
+    stream.write(header.data(), header.size());
+
+    uint64_t position = header.size();
+    for (size_t i = 0; i < tensors.size(); i++)
+    {
+        static const char padding[mapped_alignment] = { 0 };
+        stream.write(padding, offsets[i] - position);
+        stream.write((const char*)tensors[i].data_ptr(), tensors[i].nbytes());
+        position = offsets[i] + tensors[i].nbytes();
+    }
+
+    if (!stream.flush())
+        throw std::runtime_error(std::string("Failed writing to file: ") + location);
+}
+
+// Copies the tensors into a new named shared memory segment, in the mapped format, and returns views of the copies.
+static std::vector<at::Tensor> save_shared(const std::vector<at::Tensor>& tensors, const std::vector<std::string>& names, const char* name)
+{
+    std::string header;
+    std::vector<uint64_t> offsets;
+    auto size = layout_mapped(tensors, names, header, offsets);
+
+    // New segments are zero-filled, so the padding needs no writes.
+    auto segment = std::make_shared<SharedMemory>(name, (size_t)size);
+    memcpy(segment->data(), header.data(), header.size());
+
+    std::vector<at::Tensor> views;
+    for (size_t i = 0; i < tensors.size(); i++)
+    {
+        memcpy(segment->data() + offsets[i], tensors[i].data_ptr(), tensors[i].nbytes());
+        views.push_back(torch::from_blob(segment->data() + offsets[i], tensors[i].sizes(), [segment](void*) {}, tensors[i].options()));
+    }
+    return views;
+}
+
+void THSTensor_save_mapped(const Tensor* tensors, const char** names, const int length, const char* location)
+{
+    CATCH(
+        std::vector<at::Tensor> contiguous;
+        std::vector<std::string> keys;
+        for (int i = 0; i < length; i++)
+        {
+            contiguous.push_back(tensors[i]->detach().to(at::kCPU).contiguous());
+            keys.push_back(names[i]);
+        }
+        save_mapped(contiguous, keys, location);
+    );
+}
+
+void THSTensor_save_shared(const Tensor* tensors, const char** names, const int length, const char* name, Tensor* (*allocator)(size_t length))
+{
+    CATCH(
+        std::vector<at::Tensor> contiguous;
+        std::vector<std::string> keys;
+        for (int i = 0; i < length; i++)
+        {
+            contiguous.push_back(tensors[i]->detach().to(at::kCPU).contiguous());
+            keys.push_back(names[i]);
+        }
+        auto views = save_shared(contiguous, keys, name);
+
+        Tensor* result = allocator(views.size());
+        for (size_t i = 0; i < views.size(); i++)
+            result[i] = ResultTensor(views[i]);
+    );
+}
+
 Tensor THSTensor_scatter(
     const Tensor tensor,
     const int64_t dim,
@@ -1078,6 +1441,177 @@ Tensor THSTensor_scatter_add_(
     CATCH_TENSOR(tensor->scatter_add_(dim, *index, *source));
 }
 
+// Segment reductions over the rows of a tensor, where segment s is rows [offsets[s], offsets[s+1]).
+// On the CPU, segments are reduced in parallel, each by a single thread with a contiguous inner loop,
+// so there are neither atomics nor conflicts on shared outputs. Empty segments reduce to zero.
+enum class SegmentReduction : int8_t { Sum = 0, Mean = 1, Max = 2, Min = 3 };
+
+static at::Tensor segment_reduce_cpu(const at::Tensor& values, const at::Tensor& offsets, const SegmentReduction reduction, at::Tensor& arg)
+{
+    const auto segments = offsets.size(0) - 1;
+    const auto rows = values.size(0);
+    auto v = values.reshape({ rows, -1 }).contiguous();
+    const auto columns = v.size(1);
+
+    auto out_sizes = values.sizes().vec();
+    out_sizes[0] = segments;
+    auto result = torch::zeros({ segments, columns }, v.options());
+    const bool is_extremum = reduction == SegmentReduction::Max || reduction == SegmentReduction::Min;
+    if (is_extremum)
+        arg = torch::full({ segments, columns }, -1, v.options().dtype(at::kLong));
+
+    const auto off = offsets.data_ptr<int64_t>();
+
+    AT_DISPATCH_FLOATING_TYPES_AND2(at::kHalf, at::kBFloat16, v.scalar_type(), "segment_reduce", [&] {
+        const auto in = v.data_ptr<scalar_t>();
+        const auto out = result.data_ptr<scalar_t>();
+        const auto arg_out = is_extremum ? arg.data_ptr<int64_t>() : nullptr;
+
+        at::parallel_for(0, segments, 1, [&](int64_t first, int64_t last) {
+            for (auto s = first; s < last; s++) {
+                const auto begin = off[s];
+                const auto end = off[s + 1];
+                if (begin == end) continue;
+
+                auto o = out + s * columns;
+                if (!is_extremum) {
+                    for (auto r = begin; r < end; r++) {
+                        const auto row = in + r * columns;
+                        for (int64_t c = 0; c < columns; c++)
+                            o[c] += row[c];
+                    }
+                    if (reduction == SegmentReduction::Mean) {
+                        const scalar_t count = static_cast<scalar_t>(end - begin);
+                        for (int64_t c = 0; c < columns; c++)
+                            o[c] /= count;
+                    }
+                }
+                else {
+                    auto a = arg_out + s * columns;
+                    const bool is_max = reduction == SegmentReduction::Max;
+                    for (int64_t c = 0; c < columns; c++) {
+                        o[c] = in[begin * columns + c];
+                        a[c] = begin;
+                    }
+                    for (auto r = begin + 1; r < end; r++) {
+                        const auto row = in + r * columns;
+                        for (int64_t c = 0; c < columns; c++) {
+                            if (is_max ? row[c] > o[c] : row[c] < o[c]) {
+                                o[c] = row[c];
+                                a[c] = r;
+                            }
+                        }
+                    }
+                }
+            }
+        });
+    });
+    return result.reshape(out_sizes);
+}
+
+class SegmentReduceFunction : public torch::autograd::Function<SegmentReduceFunction>
+{
+public:
+    static at::Tensor forward(torch::autograd::AutogradContext* ctx, const at::Tensor& values, const at::Tensor& offsets, int64_t reduction)
+    {
+        at::Tensor arg;
+        auto result = segment_reduce_cpu(values, offsets, (SegmentReduction)reduction, arg);
+        ctx->save_for_backward({ offsets, arg });
+        ctx->saved_data["reduction"] = reduction;
+        ctx->saved_data["sizes"] = values.sizes().vec();
+        return result;
+    }
+
+    static torch::autograd::variable_list backward(torch::autograd::AutogradContext* ctx, torch::autograd::variable_list grad_outputs)
+    {
+        auto saved = ctx->get_saved_variables();
+        auto offsets = saved[0];
+        auto arg = saved[1];
+        auto reduction = (SegmentReduction)ctx->saved_data["reduction"].toInt();
+        auto sizes = ctx->saved_data["sizes"].toIntVector();
+
+        const auto segments = offsets.size(0) - 1;
+        auto lengths = offsets.narrow(0, 1, segments) - offsets.narrow(0, 0, segments);
+        auto grad = grad_outputs[0].reshape({ segments, -1 });
+
+        at::Tensor grad_values;
+        switch (reduction) {
+        case SegmentReduction::Sum:
+            grad_values = grad.repeat_interleave(lengths, 0);
+            break;
+        case SegmentReduction::Mean:
+            grad_values = (grad / lengths.clamp_min(1).unsqueeze(1).to(grad.scalar_type())).repeat_interleave(lengths, 0);
+            break;
+        default: {
+            // Each (segment, column) gradient goes to the row that won it; segments are disjoint, so no two writes collide.
+            auto nonempty = lengths > 0;
+            grad_values = torch::zeros({ sizes[0], grad.size(1) }, grad.options())
+                .scatter_(0, arg.index({ nonempty }), grad.index({ nonempty }));
+            break;
+        }
+        }
+        return { grad_values.reshape(sizes), at::Tensor(), at::Tensor() };
+    }
+};
+
+static at::Tensor segment_reduce(const at::Tensor& values, const at::Tensor& offsets, const SegmentReduction reduction)
+{
+    if (values.dim() == 0)
+        throw std::runtime_error("The values must have at least one dimension.");
+    if (offsets.dim() != 1 || offsets.size(0) < 1 || offsets.scalar_type() != at::kLong)
+        throw std::runtime_error("The offsets must be a non-empty int64 vector.");
+
+    auto off = offsets.to(at::kCPU).contiguous();
+    const auto segments = off.size(0) - 1;
+    if (off[0].item<int64_t>() != 0 || off[segments].item<int64_t>() != values.size(0) ||
+        (segments > 0 && (off.narrow(0, 1, segments) < off.narrow(0, 0, segments)).any().item<bool>()))
+        throw std::runtime_error("The offsets must be non-decreasing, from 0 to the number of rows.");
+
+    if (values.is_cpu())
+        return SegmentReduceFunction::apply(values, off, (int64_t)reduction);
+
+    // Elsewhere, sums and means are computed with index_add.
+    if (reduction == SegmentReduction::Max || reduction == SegmentReduction::Min)
+        throw std::runtime_error("Segment max and min are only implemented for CPU tensors.");
+
+    auto lengths = (off.narrow(0, 1, segments) - off.narrow(0, 0, segments)).to(values.device());
+    auto ids = torch::arange(segments, lengths.options()).repeat_interleave(lengths);
+    auto sizes = values.sizes().vec();
+    sizes[0] = segments;
+    auto result = torch::zeros(sizes, values.options()).index_add(0, ids, values);
+    if (reduction == SegmentReduction::Mean) {
+        std::vector<int64_t> shape(values.dim(), 1);
+        shape[0] = segments;
+        result = result / lengths.clamp_min(1).view(shape).to(values.scalar_type());
+    }
+    return result;
+}
+
+// Sorted segment ids are turned into offsets by counting.
+static at::Tensor segment_offsets(const at::Tensor& segment_ids, const int64_t segments)
+{
+    if (segment_ids.dim() != 1 || segment_ids.scalar_type() != at::kLong)
+        throw std::runtime_error("The segment ids must be an int64 vector.");
+    const auto n = segment_ids.size(0);
+    if (n > 0 && (segment_ids.narrow(0, 1, n - 1) < segment_ids.narrow(0, 0, n - 1)).any().item<bool>())
+        throw std::runtime_error("The segment ids must be sorted.");
+    if (n > 0 && (segment_ids[0].item<int64_t>() < 0 || segment_ids[n - 1].item<int64_t>() >= segments))
+        throw std::runtime_error("The segment ids must be between 0 and the number of segments.");
+
+    auto counts = torch::bincount(segment_ids, {}, segments);
+    return torch::cat({ torch::zeros({ 1 }, counts.options()), counts.cumsum(0) });
+}
+
+Tensor THSTensor_segment_reduce(const Tensor values, const Tensor offsets, const int8_t reduction)
+{
+    CATCH_TENSOR(segment_reduce(*values, *offsets, (SegmentReduction)reduction));
+}
+
+Tensor THSTensor_segment_reduce_ids(const Tensor values, const Tensor segment_ids, const int64_t segments, const int8_t reduction)
+{
+    CATCH_TENSOR(segment_reduce(*values, segment_offsets(*segment_ids, segments), (SegmentReduction)reduction));
+}
+
 Tensor THSTensor_selu(const Tensor tensor)
 {
     CATCH_TENSOR(torch::selu(*tensor));
@@ -1093,6 +1627,11 @@ Tensor THSTensor_silu(const Tensor tensor)
     CATCH_TENSOR(torch::silu(*tensor));
 }
 
+Tensor THSTensor_silu_out(const Tensor tensor, const Tensor out)
+{
+    CATCH_TENSOR(torch::silu_out(*out, *tensor));
+}
+
 Tensor THSTensor_silu_(const Tensor tensor)
 {
     CATCH_TENSOR(torch::silu_(*tensor));
@@ -1175,11 +1714,82 @@ Tensor THSTensor_sparse(
     CATCH_TENSOR(torch::sparse_coo_tensor(*indices, *values, at::ArrayRef<int64_t>(sizes, length), options));
 }
 
+Tensor THSTensor_sparse_csr(
+    Tensor crow_indices,
+    Tensor col_indices,
+    Tensor values,
+    const int64_t* sizes,
+    const int length,
+    const int8_t scalar_type,
+    const int device_type, const int device_index,
+    const bool requires_grad)
+{
+    auto options = at::TensorOptions()
+        .dtype(at::ScalarType(scalar_type))
+        .device(c10::Device((c10::DeviceType)device_type, (c10::DeviceIndex)device_index))
+        .layout(at::kSparseCsr)
+        .requires_grad(requires_grad);
+
+    CATCH_TENSOR(torch::sparse_csr_tensor(*crow_indices, *col_indices, *values, at::ArrayRef<int64_t>(sizes, length), options));
+}
+
+Tensor THSTensor_to_sparse(const Tensor tensor, const int64_t sparse_dim)
+{
+    CATCH_TENSOR(sparse_dim < 0 ? tensor->to_sparse() : tensor->to_sparse(sparse_dim));
+}
+
+Tensor THSTensor_to_sparse_csr(const Tensor tensor)
+{
+    CATCH_TENSOR(tensor->to_sparse_csr());
+}
+
+Tensor THSTensor_coalesce(const Tensor tensor)
+{
+    CATCH_TENSOR(tensor->coalesce());
+}
+
+int THSTensor_is_coalesced(const Tensor tensor)
+{
+    CATCH_RETURN(int, 0, tensor->is_coalesced());
+}
+
+int THSTensor_is_sparse_csr(const Tensor tensor)
+{
+    CATCH_RETURN(int, 0, tensor->is_sparse_csr());
+}
+
+Tensor THSTensor_crow_indices(const Tensor tensor)
+{
+    CATCH_TENSOR(tensor->crow_indices());
+}
+
+Tensor THSTensor_col_indices(const Tensor tensor)
+{
+    CATCH_TENSOR(tensor->col_indices());
+}
+
+// Unlike mm(), these support backward through the sparse operand (for COO), as torch.sparse.mm and torch.sparse.addmm do.
+
+Tensor THSTensor_sparse_mm(const Tensor sparse, const Tensor dense)
+{
+    CATCH_TENSOR(sparse->is_sparse() ? torch::_sparse_mm(*sparse, *dense) : torch::mm(*sparse, *dense));
+}
+
+Tensor THSTensor_sparse_addmm(const Tensor mat, const Tensor sparse, const Tensor dense, const float beta, const float alpha)
+{
+    CATCH_TENSOR(sparse->is_sparse() ? torch::_sparse_addmm(*mat, *sparse, *dense, beta, alpha) : torch::addmm(*mat, *sparse, *dense, beta, alpha));
+}
+
 Tensor THSTensor_sigmoid(const Tensor tensor)
 {
     CATCH_TENSOR(tensor->sigmoid());
 }
 
+Tensor THSTensor_sigmoid_out(const Tensor tensor, const Tensor out)
+{
+    CATCH_TENSOR(torch::sigmoid_out(*out, *tensor));
+}
+
 Tensor THSTensor_sigmoid_(const Tensor tensor)
 {
     CATCH_TENSOR(tensor->sigmoid_());
@@ -1475,6 +2085,15 @@ Tensor THSTensor_sum_along_dimensions(const Tensor tensor, const int64_t* dimens
         tensor->sum(at::ArrayRef<int64_t>(dimensions, length), keepdim))
 }
 
+Tensor THSTensor_sum_along_dimensions_out(const Tensor tensor, const int64_t* dimensions, int length, bool keepdim, bool has_type, const int8_t dtype, const Tensor out)
+{
+    CATCH_TENSOR(
+        has_type ?
+        torch::sum_out(*out, *tensor, at::ArrayRef<int64_t>(dimensions, length), keepdim, (c10::ScalarType)dtype)
+        :
+        torch::sum_out(*out, *tensor, at::ArrayRef<int64_t>(dimensions, length), keepdim))
+}
+
 Tensor THSTensor_take(const Tensor tensor, const Tensor indices)
 {
     CATCH_TENSOR(tensor->take(*indices));
@@ -1506,6 +2125,222 @@ void THSTensor_topk(const Tensor tensor, Tensor* (*allocator)(size_t length), co
     )
 }
 
+// Fused similarity search: the corpus is processed in tiles of rows, and only the running top-k of
+// each query is kept between tiles, so the full queries x corpus score matrix is never materialized.
+static void merge_topk(at::Tensor& best_values, at::Tensor& best_indices, const at::Tensor& values, const at::Tensor& indices, const int64_t k)
+{
+    auto all_values = best_values.defined() ? torch::cat({ best_values, values }, 1) : values;
+    auto all_indices = best_indices.defined() ? torch::cat({ best_indices, indices }, 1) : indices;
+    auto top = all_values.topk(std::min(k, all_values.size(1)), 1, /*largest=*/true, /*sorted=*/true);
+    best_values = std::get<0>(top);
+    best_indices = all_indices.gather(1, std::get<1>(top));
+}
+
+static at::Tensor normalize_rows(const at::Tensor& rows)
+{
+    return rows / rows.norm(2, { 1 }, /*keepdim=*/true).clamp_min(1e-12);
+}
+
+static void search_tiles(const at::Tensor& queries, const at::Tensor& corpus, const int64_t begin, const int64_t end,
+    const int64_t k, const bool cosine, const int64_t tile_size, at::Tensor& values, at::Tensor& indices)
+{
+    for (int64_t start = begin; start < end; start += tile_size) {
+        auto length = std::min(tile_size, end - start);
+        auto tile = corpus.narrow(0, start, length);
+        if (cosine) tile = normalize_rows(tile);
+
+        auto top = queries.mm(tile.t()).topk(std::min(k, length), 1, /*largest=*/true, /*sorted=*/false);
+        merge_topk(values, indices, std::get<0>(top), std::get<1>(top).add(start), k);
+    }
+}
+
+static std::tuple<at::Tensor, at::Tensor> topk_similarity(const at::Tensor& queries, const at::Tensor& corpus, const int64_t k, const bool cosine, const int64_t tile_size)
+{
+    if (queries.dim() != 2 || corpus.dim() != 2 || queries.size(1) != corpus.size(1))
+        throw std::runtime_error("Queries and corpus must be matrices with the same number of columns.");
+    if (corpus.size(0) == 0)
+        throw std::runtime_error("The corpus is empty.");
+    if (tile_size < 1)
+        throw std::runtime_error("The tile size must be positive.");
+
+    torch::NoGradGuard no_grad;
+    auto q = cosine ? normalize_rows(queries) : queries;
+    const auto rows = corpus.size(0);
+
+    at::Tensor values, indices;
+    if (!corpus.is_cpu()) {
+        search_tiles(q, corpus, 0, rows, k, cosine, tile_size, values, indices);
+        return std::make_tuple(values, indices);
+    }
+
+    // On the CPU, give each thread a contiguous range of whole tiles, and merge the per-thread results.
+    const auto tiles = (rows + tile_size - 1) / tile_size;
+    const auto chunks = std::max<int64_t>(1, std::min<int64_t>(tiles, at::get_num_threads()));
+    const auto tiles_per_chunk = (tiles + chunks - 1) / chunks;
+
+    std::vector<at::Tensor> chunk_values(chunks), chunk_indices(chunks);
+    at::parallel_for(0, chunks, 1, [&](int64_t first, int64_t last) {
+        for (auto c = first; c < last; c++) {
+            auto begin = std::min(rows, c * tiles_per_chunk * tile_size);
+            auto end = std::min(rows, (c + 1) * tiles_per_chunk * tile_size);
+            search_tiles(q, corpus, begin, end, k, cosine, tile_size, chunk_values[c], chunk_indices[c]);
+        }
+    });
+
+    for (int64_t c = 0; c < chunks; c++) {
+        if (chunk_values[c].defined())
+            merge_topk(values, indices, chunk_values[c], chunk_indices[c], k);
+    }
+    return std::make_tuple(values, indices);
+}
+
+void THSTensor_topk_similarity(const Tensor queries, const Tensor corpus, const int64_t k, const bool cosine, const int64_t tile_size, Tensor* (*allocator)(size_t length))
+{
+    CATCH(
+        auto topk = topk_similarity(*queries, *corpus, k, cosine, tile_size);
+        Tensor * result = allocator(2);
+        result[0] = ResultTensor(std::get<0>(topk));
+        result[1] = ResultTensor(std::get<1>(topk));
+    );
+}
+
+// An inverted-file index: the corpus is partitioned by k-means into lists, and a query is compared only
+// with the rows in the lists whose centroids score highest against it.
+class IVFSimilarityIndex
+{
+public:
+    at::Tensor rows;         // The corpus rows, grouped by list; normalized for cosine similarity.
+    at::Tensor ids;          // The original corpus index of each grouped row.
+    at::Tensor centroids;
+    std::vector<int64_t> offsets;
+    bool cosine;
+};
+
+// Assigns each row to its nearest centroid, a tile of rows at a time.
+static at::Tensor assign_to_centroids(const at::Tensor& rows, const at::Tensor& centroids, const bool cosine, const int64_t tile_size)
+{
+    // For Euclidean distance, argmin |x - c|^2 = argmax (x.c - |c|^2 / 2).
+    auto bias = cosine ? at::Tensor() : centroids.pow(2).sum(1).mul(0.5);
+
+    std::vector<at::Tensor> assignments;
+    for (int64_t start = 0; start < rows.size(0); start += tile_size) {
+        auto scores = rows.narrow(0, start, std::min(tile_size, rows.size(0) - start)).mm(centroids.t());
+        if (bias.defined()) scores.sub_(bias);
+        assignments.push_back(scores.argmax(1));
+    }
+    return torch::cat(assignments);
+}
+
+static std::shared_ptr<IVFSimilarityIndex> build_ivf_index(const at::Tensor& corpus, const int64_t lists, const int64_t iterations, const bool cosine)
+{
+    if (corpus.dim() != 2)
+        throw std::runtime_error("The corpus must be a matrix.");
+    if (lists < 1 || lists > corpus.size(0))
+        throw std::runtime_error("The number of lists must be between one and the number of corpus rows.");
+
+    const int64_t tile_size = 4096;
+
+    torch::NoGradGuard no_grad;
+    auto index = std::make_shared<IVFSimilarityIndex>();
+    index->cosine = cosine;
+
+    auto rows = cosine ? normalize_rows(corpus) : corpus.contiguous();
+    auto centroids = rows.index_select(0, torch::randperm(rows.size(0), rows.options().dtype(at::kLong)).narrow(0, 0, lists)).clone();
+
+    at::Tensor assignment;
+    for (int64_t i = 0; i < iterations; i++) {
+        assignment = assign_to_centroids(rows, centroids, cosine, tile_size);
+        auto sums = torch::zeros_like(centroids).index_add_(0, assignment, rows);
+        auto counts = torch::bincount(assignment, {}, lists).unsqueeze(1);
+
+        // Lists that lost all their rows keep their previous centroid.
+        auto updated = sums / counts.clamp_min(1).to(sums.scalar_type());
+        centroids = torch::where(counts > 0, updated, centroids);
+        if (cosine) centroids = normalize_rows(centroids);
+    }
+    assignment = assign_to_centroids(rows, centroids, cosine, tile_size);
+
+    auto order = assignment.argsort();
+    index->rows = rows.index_select(0, order);
+    index->ids = order;
+    index->centroids = centroids;
+
+    auto counts = torch::bincount(assignment, {}, lists).cpu();
+    auto accessor = counts.accessor<int64_t, 1>();
+    index->offsets.push_back(0);
+    for (int64_t l = 0; l < lists; l++)
+        index->offsets.push_back(index->offsets.back() + accessor[l]);
+    return index;
+}
+
+static std::tuple<at::Tensor, at::Tensor> ivf_search(const IVFSimilarityIndex& index, const at::Tensor& queries, const int64_t k, const int64_t probes)
+{
+    if (queries.dim() != 2 || queries.size(1) != index.rows.size(1))
+        throw std::runtime_error("The queries must be a matrix with as many columns as the corpus.");
+
+    torch::NoGradGuard no_grad;
+    auto q = index.cosine ? normalize_rows(queries) : queries;
+    const auto lists = index.centroids.size(0);
+    const auto n = q.size(0);
+
+    auto probed = std::get<1>(q.mm(index.centroids.t()).topk(std::min(probes, lists), 1)).cpu();
+    auto probed_accessor = probed.accessor<int64_t, 2>();
+
+    // Queries whose probed lists hold fewer than k rows are padded with -inf and index -1.
+    auto values = torch::full({ n, k }, -std::numeric_limits<double>::infinity(), q.options());
+    auto indices = torch::full({ n, k }, -1, q.options().dtype(at::kLong));
+
+    at::parallel_for(0, n, 1, [&](int64_t first, int64_t last) {
+        for (auto i = first; i < last; i++) {
+            std::vector<at::Tensor> scores, ids;
+            for (int64_t p = 0; p < probed.size(1); p++) {
+                auto l = probed_accessor[i][p];
+                auto length = index.offsets[l + 1] - index.offsets[l];
+                if (length == 0) continue;
+                scores.push_back(index.rows.narrow(0, index.offsets[l], length).mv(q[i]));
+                ids.push_back(index.ids.narrow(0, index.offsets[l], length));
+            }
+            if (scores.empty()) continue;
+
+            auto all_scores = torch::cat(scores);
+            auto top = all_scores.topk(std::min(k, all_scores.size(0)));
+            auto count = std::get<0>(top).size(0);
+            values[i].narrow(0, 0, count).copy_(std::get<0>(top));
+            indices[i].narrow(0, 0, count).copy_(torch::cat(ids).index_select(0, std::get<1>(top)));
+        }
+    });
+    return std::make_tuple(values, indices);
+}
+
+IVFIndex THSTensor_ivf_index_create(const Tensor corpus, const int64_t lists, const int64_t iterations, const bool cosine)
+{
+    IVFIndex res = nullptr;
+    CATCH(
+        res = new std::shared_ptr<IVFSimilarityIndex>(build_ivf_index(*corpus, lists, iterations, cosine));
+    );
+    return res;
+}
+
+void THSTensor_ivf_index_search(const IVFIndex index, const Tensor queries, const int64_t k, const int64_t probes, Tensor* (*allocator)(size_t length))
+{
+    CATCH(
+        auto topk = ivf_search(**index, *queries, k, probes);
+        Tensor * result = allocator(2);
+        result[0] = ResultTensor(std::get<0>(topk));
+        result[1] = ResultTensor(std::get<1>(topk));
+    );
+}
+
+Tensor THSTensor_ivf_index_centroids(const IVFIndex index)
+{
+    CATCH_TENSOR((*index)->centroids);
+}
+
+void THSTensor_ivf_index_dispose(const IVFIndex index)
+{
+    delete index;
+}
+
 Tensor THSTensor_trunc(const Tensor tensor)
 {
     CATCH_TENSOR(tensor->trunc());
@@ -1610,7 +2445,7 @@ void THSTensor_unbind(const Tensor tensor, Tensor* (*allocator)(size_t length),
 
 Tensor THSTensor_values(Tensor tensor)
 {
-    CATCH_TENSOR(tensor->_values());
+    CATCH_TENSOR(tensor->is_sparse_csr() ? tensor->values() : tensor->_values());
 }
 
 Tensor THSTensor_vander(const Tensor tensor, const int64_t N, const bool increasing)
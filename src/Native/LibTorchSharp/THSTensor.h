@@ -26,6 +26,8 @@ EXPORT_API(Tensor) THSTensor_adaptive_avg_pool3d_backward_out(const Tensor grad_
 
 EXPORT_API(Tensor) THSTensor_add(const Tensor left, const Tensor right, const Scalar alpha);
 
+EXPORT_API(Tensor) THSTensor_add_out(const Tensor left, const Tensor right, const Scalar alpha, const Tensor out);
+
 EXPORT_API(Tensor) THSTensor_add_(const Tensor left, const Tensor right, const Scalar alpha);
 
 EXPORT_API(Tensor) THSTensor_add_scalar(const Tensor left, const Scalar right, const Scalar alpha);
@@ -46,6 +48,8 @@ EXPORT_API(Tensor) THSTensor_addcmul_(const Tensor left, const Tensor tensor1, c
 
 EXPORT_API(Tensor) THSTensor_addmm(const Tensor left, const Tensor mat1, const Tensor mat2, const float beta, const float alpha);
 
+EXPORT_API(Tensor) THSTensor_addmm_out(const Tensor left, const Tensor mat1, const Tensor mat2, const float beta, const float alpha, const Tensor out);
+
 EXPORT_API(Tensor) THSTensor_addmm_(const Tensor left, const Tensor mat1, const Tensor mat2, const float beta, const float alpha);
 
 EXPORT_API(Tensor) THSTensor_addmv(const Tensor left, const Tensor mat1, const Tensor vec2, const float beta, const float alpha);
@@ -192,6 +196,8 @@ EXPORT_API(Tensor) THSTensor_block_diag(const Tensor* tensor, const int length);
 
 EXPORT_API(Tensor) THSTensor_bmm(const Tensor b1wrapper, const Tensor b2wrapper);
 
+EXPORT_API(Tensor) THSTensor_bmm_out(const Tensor b1wrapper, const Tensor b2wrapper, const Tensor out);
+
 EXPORT_API(Tensor) THSTensor_broadcast_to(const Tensor tensor, const int64_t* shape, const int shape_len);
 
 EXPORT_API(void) THSTensor_broadcast_tensors(const Tensor* tensor, const int length, Tensor* (*allocator)(size_t length));
@@ -342,6 +348,8 @@ EXPORT_API(Tensor) THSTensor_dist(const Tensor tensor, const Tensor other, const
 
 EXPORT_API(Tensor) THSTensor_div(const Tensor left, const Tensor right, const char* rounding_mode);
 
+EXPORT_API(Tensor) THSTensor_div_out(const Tensor left, const Tensor right, const char* rounding_mode, const Tensor out);
+
 EXPORT_API(Tensor) THSTensor_div_(const Tensor left, const Tensor right, const char* rounding_mode);
 
 EXPORT_API(Tensor) THSTensor_div_scalar(const Tensor left, const Scalar right, const char* rounding_mode);
@@ -352,6 +360,9 @@ EXPORT_API(Tensor) THSTensor_dot(const Tensor left, const Tensor right);
 
 EXPORT_API(Tensor) THSTensor_einsum(const char* equation, const Tensor* tensors, const int length);
 
+// Describes the pairwise contractions einsum performs for three or more operands, or returns an empty string.
+EXPORT_API(const char*) THSTensor_einsum_path(const char* equation, const Tensor* tensors, const int length);
+
 EXPORT_API(int64_t) THSTensor_element_size(const Tensor tensor);
 
 EXPORT_API(Tensor) THSTensor_elu(const Tensor tensor, const Scalar alpha, const Scalar scale, const Scalar input_scale);
@@ -402,6 +413,8 @@ EXPORT_API(int) THSTensor_equal(const Tensor left, const Tensor right);
 
 EXPORT_API(Tensor) THSTensor_exp(const Tensor tensor);
 
+EXPORT_API(Tensor) THSTensor_exp_out(const Tensor tensor, const Tensor out);
+
 EXPORT_API(Tensor) THSTensor_exp_(const Tensor tensor);
 
 EXPORT_API(Tensor) THSTensor_exp2(const Tensor tensor);
@@ -490,6 +503,8 @@ EXPORT_API(Tensor) THSTensor_ge_scalar_(const Tensor left, const Scalar right);
 
 EXPORT_API(Tensor) THSTensor_gelu(const Tensor tensor);
 
+EXPORT_API(Tensor) THSTensor_gelu_out(const Tensor tensor, const Tensor out);
+
 EXPORT_API(Tensor) THSTensor_get1(const Tensor tensor, int64_t index);
 
 EXPORT_API(Tensor) THSTensor_get2(const Tensor tensor, int64_t index1, int64_t index2);
@@ -567,6 +582,23 @@ EXPORT_API(Tensor) THSTensor_index_put_(Tensor tensor,
     const int indicesLength,
     const Tensor value);
 
+EXPORT_API(IndexPlan) THSTensor_index_plan_create(
+    const int64_t* indexStarts,
+    const int64_t* indexEnds,
+    const int64_t* indexSteps,
+    const Tensor* indexTensors,
+    const int indicesLength);
+
+EXPORT_API(int) THSTensor_index_plan_is_view(const IndexPlan plan);
+
+EXPORT_API(void) THSTensor_index_plan_dispose(const IndexPlan plan);
+
+EXPORT_API(Tensor) THSTensor_index_plan_apply(const Tensor tensor, const IndexPlan plan);
+
+EXPORT_API(Tensor) THSTensor_index_plan_put_(Tensor tensor, const IndexPlan plan, const Tensor value);
+
+EXPORT_API(Tensor) THSTensor_index_plan_put_scalar_(Tensor tensor, const IndexPlan plan, const Scalar value);
+
 EXPORT_API(Tensor) THSTensor_index_select(Tensor tensor, int64_t dim, Tensor index);
 
 EXPORT_API(Tensor) THSTensor_inner(const Tensor left, const Tensor right);
@@ -626,6 +658,9 @@ EXPORT_API(Tensor) THSTensor_logspace(const double start, const double end, cons
 
 EXPORT_API(Tensor) THSTensor_load(const char* location);
 
+EXPORT_API(void) THSTensor_load_mapped(const char* location, Tensor* (*allocator1)(size_t length), const char** (*allocator2)(size_t length));
+EXPORT_API(void) THSTensor_load_shared(const char* name, Tensor* (*allocator1)(size_t length), const char** (*allocator2)(size_t length));
+
 EXPORT_API(Tensor) THSTensor_log(const Tensor tensor);
 
 EXPORT_API(Tensor) THSTensor_log_(const Tensor tensor);
@@ -697,6 +732,8 @@ EXPORT_API(Tensor) THSTensor_masked_select(const Tensor tensor, const Tensor mas
 
 EXPORT_API(Tensor) THSTensor_matmul(const Tensor left, const Tensor right);
 
+EXPORT_API(Tensor) THSTensor_matmul_out(const Tensor left, const Tensor right, const Tensor out);
+
 EXPORT_API(Tensor) THSTensor_matrix_exp(const Tensor input);
 
 EXPORT_API(Tensor) THSTensor_max(const Tensor tensor);
@@ -772,6 +809,8 @@ EXPORT_API(Tensor) THSTensor_mean(const Tensor tensor);
 
 EXPORT_API(Tensor) THSTensor_mean_along_dimensions(const Tensor tensor, const int64_t* dimensions, int length, bool keepdim, bool has_type, const int8_t dtype);
 
+EXPORT_API(Tensor) THSTensor_mean_along_dimensions_out(const Tensor tensor, const int64_t* dimensions, int length, bool keepdim, bool has_type, const int8_t dtype, const Tensor out);
+
 EXPORT_API(Tensor) THSTensor_median(const Tensor tensor);
 
 EXPORT_API(void) THSTensor_mode(const Tensor tensor, Tensor* (*allocator)(size_t length), const int64_t dim, const bool keep_dim);
@@ -784,6 +823,8 @@ EXPORT_API(void) THSTensor_min_along_dimension(const Tensor tensor, Tensor* (*al
 
 EXPORT_API(Tensor) THSTensor_mm(const Tensor left, const Tensor right);
 
+EXPORT_API(Tensor) THSTensor_mm_out(const Tensor left, const Tensor right, const Tensor out);
+
 EXPORT_API(Tensor) THSTensor_mv(const Tensor left, const Tensor right);
 
 EXPORT_API(Tensor) THSTensor_movedim(const Tensor tensor, const int64_t* src, const int src_len, const int64_t* dst, const int dst_len);
@@ -792,6 +833,8 @@ EXPORT_API(Tensor) THSTensor_msort(const Tensor tensor);
 
 EXPORT_API(Tensor) THSTensor_mul(const Tensor left, const Tensor right);
 
+EXPORT_API(Tensor) THSTensor_mul_out(const Tensor left, const Tensor right, const Tensor out);
+
 EXPORT_API(Tensor) THSTensor_mul_(const Tensor left, const Tensor right);
 
 EXPORT_API(Tensor) THSTensor_mul_scalar(const Tensor tensor, const Scalar scalar);
@@ -953,6 +996,8 @@ EXPORT_API(Tensor) THSTensor_reciprocal_(const Tensor tensor);
 
 EXPORT_API(Tensor) THSTensor_relu(const Tensor tensor);
 
+EXPORT_API(Tensor) THSTensor_relu_out(const Tensor tensor, const Tensor out);
+
 EXPORT_API(Tensor) THSTensor_relu_(const Tensor tensor);
 
 EXPORT_API(Tensor) THSTensor_relu6(const Tensor tensor);
@@ -991,6 +1036,8 @@ EXPORT_API(Tensor) THSTensor_selu_(const Tensor tensor);
 
 EXPORT_API(Tensor) THSTensor_sigmoid(const Tensor tensor);
 
+EXPORT_API(Tensor) THSTensor_sigmoid_out(const Tensor tensor, const Tensor out);
+
 EXPORT_API(Tensor) THSTensor_sigmoid_(const Tensor tensor);
 
 EXPORT_API(Tensor) THSTensor_sign(const Tensor tensor);
@@ -1001,6 +1048,8 @@ EXPORT_API(Tensor) THSTensor_signbit(const Tensor tensor);
 
 EXPORT_API(Tensor) THSTensor_silu(const Tensor tensor);
 
+EXPORT_API(Tensor) THSTensor_silu_out(const Tensor tensor, const Tensor out);
+
 EXPORT_API(Tensor) THSTensor_silu_(const Tensor tensor);
 
 EXPORT_API(Tensor) THSTensor_sin(const Tensor tensor);
@@ -1029,6 +1078,8 @@ EXPORT_API(Tensor) THSTensor_std_along_dimensions(const Tensor tensor, const int
 
 EXPORT_API(Tensor) THSTensor_sub(const Tensor left, const Tensor right);
 
+EXPORT_API(Tensor) THSTensor_sub_out(const Tensor left, const Tensor right, const Tensor out);
+
 EXPORT_API(Tensor) THSTensor_sub_(const Tensor left, const Tensor right);
 
 EXPORT_API(Tensor) THSTensor_sub_scalar(const Tensor left, const Scalar right);
@@ -1039,14 +1090,22 @@ EXPORT_API(Tensor) THSTensor_sum(const Tensor tensor, bool has_type, const int8_
 
 EXPORT_API(Tensor) THSTensor_sum_along_dimensions(const Tensor tensor, const int64_t * dimensions, int length, bool keepdim, bool has_type, const int8_t dtype);
 
+EXPORT_API(Tensor) THSTensor_sum_along_dimensions_out(const Tensor tensor, const int64_t* dimensions, int length, bool keepdim, bool has_type, const int8_t dtype, const Tensor out);
+
 EXPORT_API(void) THSTensor_save(const Tensor tensor, const char* location);
 
+EXPORT_API(void) THSTensor_save_mapped(const Tensor* tensors, const char** names, const int length, const char* location);
+EXPORT_API(void) THSTensor_save_shared(const Tensor* tensors, const char** names, const int length, const char* name, Tensor* (*allocator)(size_t length));
+
 EXPORT_API(Tensor) THSTensor_scatter(const Tensor tensor, const int64_t dim, const Tensor index, const Tensor source);
 EXPORT_API(Tensor) THSTensor_scatter_(const Tensor tensor, const int64_t dim, const Tensor index, const Tensor source);
 
 EXPORT_API(Tensor) THSTensor_scatter_add(const Tensor tensor, const int64_t dim, const Tensor index, const Tensor source);
 EXPORT_API(Tensor) THSTensor_scatter_add_(const Tensor tensor, const int64_t dim, const Tensor index, const Tensor source);
 
+EXPORT_API(Tensor) THSTensor_segment_reduce(const Tensor values, const Tensor offsets, const int8_t reduction);
+EXPORT_API(Tensor) THSTensor_segment_reduce_ids(const Tensor values, const Tensor segment_ids, const int64_t segments, const int8_t reduction);
+
 EXPORT_API(Tensor) THSTensor_set_(Tensor tensor, const Tensor source);
 
 EXPORT_API(Tensor) THSTensor_set_requires_grad(const Tensor tensor, const bool requires_grad);
@@ -1078,6 +1137,29 @@ EXPORT_API(Tensor) THSTensor_sparse(
     const int device_type, const int device_index,
     const bool requires_grad);
 
+EXPORT_API(Tensor) THSTensor_sparse_csr(
+    Tensor crow_indices,
+    Tensor col_indices,
+    Tensor values,
+    const int64_t* sizes,
+    const int length,
+    const int8_t scalar_type,
+    const int device_type, const int device_index,
+    const bool requires_grad);
+
+EXPORT_API(Tensor) THSTensor_to_sparse(const Tensor tensor, const int64_t sparse_dim);
+EXPORT_API(Tensor) THSTensor_to_sparse_csr(const Tensor tensor);
+
+EXPORT_API(Tensor) THSTensor_coalesce(const Tensor tensor);
+EXPORT_API(int) THSTensor_is_coalesced(const Tensor tensor);
+EXPORT_API(int) THSTensor_is_sparse_csr(const Tensor tensor);
+
+EXPORT_API(Tensor) THSTensor_crow_indices(const Tensor tensor);
+EXPORT_API(Tensor) THSTensor_col_indices(const Tensor tensor);
+
+EXPORT_API(Tensor) THSTensor_sparse_mm(const Tensor sparse, const Tensor dense);
+EXPORT_API(Tensor) THSTensor_sparse_addmm(const Tensor mat, const Tensor sparse, const Tensor dense, const float beta, const float alpha);
+
 EXPORT_API(void) THSTensor_split_with_size(const Tensor tensor, Tensor* (*allocator)(size_t length), const int64_t split_size, const int64_t dim);
 EXPORT_API(void) THSTensor_split_with_sizes(const Tensor tensor, Tensor* (*allocator)(size_t length), const int64_t* sizes, const int length, const int64_t dim);
 
@@ -1111,6 +1193,8 @@ EXPORT_API(Tensor) THSTensor_tan_(const Tensor tensor);
 
 EXPORT_API(Tensor) THSTensor_tanh(const Tensor tensor);
 
+EXPORT_API(Tensor) THSTensor_tanh_out(const Tensor tensor, const Tensor out);
+
 EXPORT_API(Tensor) THSTensor_tanh_(const Tensor tensor);
 
 EXPORT_API(Tensor) THSTensor_t(const Tensor tensor);
@@ -1154,6 +1238,13 @@ EXPORT_API(Tensor) THSTensor_to_type_and_device(const Tensor tensor, int8_t scal
 
 EXPORT_API(void) THSTensor_topk(const Tensor tensor, Tensor* (*allocator)(size_t length), const int k, const int64_t dim, const bool largest, const bool sorted);
 
+EXPORT_API(void) THSTensor_topk_similarity(const Tensor queries, const Tensor corpus, const int64_t k, const bool cosine, const int64_t tile_size, Tensor* (*allocator)(size_t length));
+
+EXPORT_API(IVFIndex) THSTensor_ivf_index_create(const Tensor corpus, const int64_t lists, const int64_t iterations, const bool cosine);
+EXPORT_API(void) THSTensor_ivf_index_search(const IVFIndex index, const Tensor queries, const int64_t k, const int64_t probes, Tensor* (*allocator)(size_t length));
+EXPORT_API(Tensor) THSTensor_ivf_index_centroids(const IVFIndex index);
+EXPORT_API(void) THSTensor_ivf_index_dispose(const IVFIndex index);
+
 EXPORT_API(Tensor) THSTensor_trunc(const Tensor tensor);
 
 EXPORT_API(Tensor) THSTensor_trunc_(const Tensor tensor);
@@ -1162,6 +1253,8 @@ EXPORT_API(int8_t) THSTensor_type(const Tensor tensor);
 
 EXPORT_API(void) THSTensor_unbind(const Tensor tensor, Tensor* (*allocator)(size_t length), const int64_t dim);
 
+EXPORT_API(void) THSTensor_unlink_shared(const char* name);
+
 EXPORT_API(Tensor) THSTensor_unsqueeze(Tensor tensor, int64_t dim);
 EXPORT_API(Tensor) THSTensor_unsqueeze_(Tensor tensor, int64_t dim);
 
@@ -1231,6 +1324,11 @@ EXPORT_API(Tensor) THSTensor_binomial(const Tensor count, const Tensor prob, con
 
 EXPORT_API(Tensor) THSTensor_multinomial(const Tensor tensor, const int64_t num_samples, const bool replacement, const Generator gen);
 
+EXPORT_API(AliasSampler) THSTensor_alias_sampler_create(const Tensor probs);
+EXPORT_API(Tensor) THSTensor_alias_sampler_sample(const AliasSampler sampler, const int64_t* shape, const int length, const Generator gen);
+EXPORT_API(int64_t) THSTensor_alias_sampler_categories(const AliasSampler sampler);
+EXPORT_API(void) THSTensor_alias_sampler_dispose(const AliasSampler sampler);
+
 EXPORT_API(Tensor) THSTensor_poisson(const Tensor tensor, const Generator gen);
 
 EXPORT_API(Tensor) THSTensor_sample_dirichlet_(Tensor tensor, const Generator gen);
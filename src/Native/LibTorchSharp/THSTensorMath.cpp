@@ -3,6 +3,9 @@
 
 #include <iostream>
 #include <fstream>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 
 Tensor THSTensor_abs(const Tensor tensor)
 {
@@ -29,6 +32,11 @@ Tensor THSTensor_add(const Tensor left, const Tensor right, const Scalar alpha)
     CATCH_TENSOR(left->add(*right, *alpha));
 }
 
+Tensor THSTensor_add_out(const Tensor left, const Tensor right, const Scalar alpha, const Tensor out)
+{
+    CATCH_TENSOR(torch::add_out(*out, *left, *right, *alpha));
+}
+
 Tensor THSTensor_add_(const Tensor left, const Tensor right, const Scalar alpha)
 {
     CATCH_TENSOR(left->add_(*right, *alpha));
@@ -79,6 +87,11 @@ Tensor THSTensor_addmm(const Tensor mat, const Tensor mat1, const Tensor mat2, c
     CATCH_TENSOR(mat->addmm(*mat1, *mat2, beta, alpha));
 }
 
+Tensor THSTensor_addmm_out(const Tensor mat, const Tensor mat1, const Tensor mat2, const float beta, const float alpha, const Tensor out)
+{
+    CATCH_TENSOR(torch::addmm_out(*out, *mat, *mat1, *mat2, beta, alpha));
+}
+
 Tensor THSTensor_addmm_(const Tensor mat, const Tensor mat1, const Tensor mat2, const float beta, const float alpha)
 {
     CATCH_TENSOR(mat->addmm_(*mat1, *mat2, beta, alpha));
@@ -221,6 +234,11 @@ Tensor THSTensor_bmm(const Tensor batch1, const Tensor batch2)
     CATCH_TENSOR(batch1->bmm(*batch2));
 }
 
+Tensor THSTensor_bmm_out(const Tensor batch1, const Tensor batch2, const Tensor out)
+{
+    CATCH_TENSOR(torch::bmm_out(*out, *batch1, *batch2));
+}
+
 Tensor THSTensor_ceil(const Tensor tensor)
 {
     CATCH_TENSOR(tensor->ceil());
@@ -265,6 +283,11 @@ Tensor THSTensor_div(const Tensor left, const Tensor right, const char* rounding
     CATCH_TENSOR(rounding_mode == nullptr ? left->div(*right) : left->div(*right, rounding_mode));
 }
 
+Tensor THSTensor_div_out(const Tensor left, const Tensor right, const char* rounding_mode, const Tensor out)
+{
+    CATCH_TENSOR(rounding_mode == nullptr ? torch::div_out(*out, *left, *right) : torch::div_out(*out, *left, *right, rounding_mode));
+}
+
 Tensor THSTensor_div_(const Tensor left, const Tensor right, const char* rounding_mode)
 {
     CATCH_TENSOR(rounding_mode == nullptr ? left->div_(*right) : left->div_(*right, rounding_mode));
@@ -285,9 +308,275 @@ Tensor THSTensor_dot(const Tensor left, const Tensor right)
     CATCH_TENSOR(left->dot(*right));
 }
 
+// Einsum contraction paths. torch::einsum contracts its operands left to right, which for three or more
+// operands can cost orders of magnitude more than the best pairwise order. For those, a path is chosen
+// from the operand sizes -- exhaustively for a few operands, greedily otherwise -- and cached by equation
+// and shapes, keeping the most recently used. Each pairwise contraction is then a two-operand einsum,
+// which ATen maps onto bmm.
+struct EinsumStep
+{
+    size_t left;
+    size_t right;
+    std::string equation;
+};
+
+struct EinsumProblem
+{
+    std::string output;
+    std::map<char, int64_t> sizes;
+
+    double size(const std::string& subscripts) const
+    {
+        double result = 1;
+        for (auto c : subscripts)
+            result *= (double)sizes.at(c);
+        return result;
+    }
+};
+
+// Pairwise contractions of more than this many operands are searched greedily.
+static const size_t einsum_exhaustive_limit = 5;
+
+static std::string unique_subscripts(const std::string& subscripts)
+{
+    std::string result;
+    for (auto c : subscripts) {
+        if (result.find(c) == std::string::npos)
+            result.push_back(c);
+    }
+    return result;
+}
+
+// The subscripts of the result of contracting operands i and j: those still needed by another operand or
+// the output. The last contraction produces the output itself.
+static std::string contraction_result(const std::vector<std::string>& operands, size_t i, size_t j, const EinsumProblem& problem)
+{
+    if (operands.size() == 2)
+        return problem.output;
+
+    std::string result;
+    for (auto c : unique_subscripts(operands[i] + operands[j])) {
+        bool needed = problem.output.find(c) != std::string::npos;
+        for (size_t k = 0; k < operands.size() && !needed; k++)
+            needed = k != i && k != j && operands[k].find(c) != std::string::npos;
+        if (needed)
+            result.push_back(c);
+    }
+    return result;
+}
+
+static std::vector<std::string> contract(const std::vector<std::string>& operands, size_t i, size_t j, const std::string& result)
+{
+    std::vector<std::string> next;
+    for (size_t k = 0; k < operands.size(); k++) {
+        if (k != i && k != j)
+            next.push_back(operands[k]);
+    }
+    next.push_back(result);
+    return next;
+}
+
+static void search_einsum_path(const std::vector<std::string>& operands, const EinsumProblem& problem,
+    std::vector<EinsumStep>& current, double cost, std::vector<EinsumStep>& best, double& best_cost)
+{
+    if (cost >= best_cost)
+        return;
+    if (operands.size() == 1) {
+        best = current;
+        best_cost = cost;
+        return;
+    }
+    for (size_t i = 0; i < operands.size(); i++) {
+        for (size_t j = i + 1; j < operands.size(); j++) {
+            auto result = contraction_result(operands, i, j, problem);
+            auto flops = problem.size(unique_subscripts(operands[i] + operands[j]));
+            current.push_back({ i, j, operands[i] + "," + operands[j] + "->" + result });
+            search_einsum_path(contract(operands, i, j, result), problem, current, cost + flops, best, best_cost);
+            current.pop_back();
+        }
+    }
+}
+
+// At each step, contracts the pair that shrinks the total operand size the most, breaking ties by cost.
+static std::vector<EinsumStep> greedy_einsum_path(std::vector<std::string> operands, const EinsumProblem& problem)
+{
+    std::vector<EinsumStep> path;
+    while (operands.size() > 1) {
+        size_t best_i = 0, best_j = 1;
+        std::string best_result;
+        double best_growth = std::numeric_limits<double>::infinity();
+        double best_flops = std::numeric_limits<double>::infinity();
+
+        for (size_t i = 0; i < operands.size(); i++) {
+            for (size_t j = i + 1; j < operands.size(); j++) {
+                auto result = contraction_result(operands, i, j, problem);
+                auto growth = problem.size(result) - problem.size(operands[i]) - problem.size(operands[j]);
+                auto flops = problem.size(unique_subscripts(operands[i] + operands[j]));
+                if (growth < best_growth || (growth == best_growth && flops < best_flops)) {
+                    best_i = i;
+                    best_j = j;
+                    best_result = result;
+                    best_growth = growth;
+                    best_flops = flops;
+                }
+            }
+        }
+        path.push_back({ best_i, best_j, operands[best_i] + "," + operands[best_j] + "->" + best_result });
+        operands = contract(operands, best_i, best_j, best_result);
+    }
+    return path;
+}
+
+// Returns false if the equation is outside what paths are computed for, leaving it to torch::einsum.
+static bool parse_einsum(const std::string& equation, const std::vector<at::Tensor>& tensors, std::vector<std::string>& operands, EinsumProblem& problem)
+{
+    std::string compact;
+    for (auto c : equation) {
+        if (c == '.') return false;
+        if (!isspace((unsigned char)c)) compact.push_back(c);
+    }
+
+    auto arrow = compact.find("->");
+    auto inputs = compact.substr(0, arrow);
+    size_t start = 0;
+    while (true) {
+        auto comma = inputs.find(',', start);
+        operands.push_back(inputs.substr(start, comma == std::string::npos ? std::string::npos : comma - start));
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+    if (operands.size() != tensors.size())
+        return false;
+
+    std::map<char, int> counts;
+    for (size_t i = 0; i < operands.size(); i++) {
+        if ((int64_t)operands[i].size() != tensors[i].dim())
+            return false;
+        for (size_t d = 0; d < operands[i].size(); d++) {
+            auto c = operands[i][d];
+            if (!isalpha((unsigned char)c))
+                return false;
+            counts[c]++;
+            // Dimensions of size one broadcast.
+            auto& size = problem.sizes[c];
+            size = std::max(size, tensors[i].size(d));
+        }
+    }
+
+    if (arrow != std::string::npos) {
+        problem.output = compact.substr(arrow + 2);
+        for (auto c : problem.output) {
+            if (problem.sizes.find(c) == problem.sizes.end())
+                return false;
+        }
+    }
+    else {
+        // Implicit output: the subscripts appearing exactly once, in alphabetical order.
+        for (const auto& kv : counts) {
+            if (kv.second == 1)
+                problem.output.push_back(kv.first);
+        }
+    }
+    return true;
+}
+
+// The most recently used paths. Shapes that vary from call to call, such as batch or sequence lengths,
+// would otherwise grow the cache without bound.
+static const size_t einsum_paths_capacity = 256;
+
+typedef std::pair<std::string, std::shared_ptr<std::vector<EinsumStep>>> EinsumPathEntry;
+
+static std::mutex einsum_paths_mutex;
+static std::list<EinsumPathEntry> einsum_paths_lru; // Most recently used first.
+static std::unordered_map<std::string, std::list<EinsumPathEntry>::iterator> einsum_paths;
+
+// Returns nullptr when torch::einsum should be used as is.
+static std::shared_ptr<std::vector<EinsumStep>> einsum_path(const std::string& equation, const std::vector<at::Tensor>& tensors)
+{
+    if (tensors.size() < 3)
+        return nullptr;
+
+    std::string key = equation;
+    for (const auto& t : tensors) {
+        key += "|";
+        for (auto d : t.sizes())
+            key += std::to_string(d) + ",";
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(einsum_paths_mutex);
+        auto found = einsum_paths.find(key);
+        if (found != einsum_paths.end()) {
+            einsum_paths_lru.splice(einsum_paths_lru.begin(), einsum_paths_lru, found->second);
+            return found->second->second;
+        }
+    }
+
+    std::vector<std::string> operands;
+    EinsumProblem problem;
+    if (!parse_einsum(equation, tensors, operands, problem))
+        return nullptr;
+
+    auto path = std::make_shared<std::vector<EinsumStep>>();
+    if (operands.size() <= einsum_exhaustive_limit) {
+        std::vector<EinsumStep> current;
+        double best_cost = std::numeric_limits<double>::infinity();
+        search_einsum_path(operands, problem, current, 0, *path, best_cost);
+    }
+    else {
+        *path = greedy_einsum_path(operands, problem);
+    }
+
+    std::lock_guard<std::mutex> lock(einsum_paths_mutex);
+    auto found = einsum_paths.find(key);
+    if (found != einsum_paths.end()) {
+        // Another thread planned the same problem meanwhile.
+        einsum_paths_lru.splice(einsum_paths_lru.begin(), einsum_paths_lru, found->second);
+        return found->second->second;
+    }
+    einsum_paths_lru.emplace_front(key, path);
+    einsum_paths[key] = einsum_paths_lru.begin();
+    if (einsum_paths_lru.size() > einsum_paths_capacity) {
+        einsum_paths.erase(einsum_paths_lru.back().first);
+        einsum_paths_lru.pop_back();
+    }
+    return path;
+}
+
+static at::Tensor einsum(const char* equation, const std::vector<at::Tensor>& tensors)
+{
+    auto path = einsum_path(equation, tensors);
+    if (!path)
+        return torch::einsum(equation, tensors);
+
+    auto operands = tensors;
+    for (const auto& step : *path) {
+        auto result = torch::einsum(step.equation, { operands[step.left], operands[step.right] });
+        operands.erase(operands.begin() + step.right);
+        operands.erase(operands.begin() + step.left);
+        operands.push_back(result);
+    }
+    return operands[0];
+}
+
 Tensor THSTensor_einsum(const char* equation, const Tensor* tensors, const int length)
 {
-    CATCH_TENSOR(torch::einsum(equation, toTensors<at::Tensor>((torch::Tensor**)tensors, length)));
+    CATCH_TENSOR(einsum(equation, toTensors<at::Tensor>((torch::Tensor**)tensors, length)));
+}
+
+const char* THSTensor_einsum_path(const char* equation, const Tensor* tensors, const int length)
+{
+    const char* res = nullptr;
+    CATCH(
+        auto path = einsum_path(equation, toTensors<at::Tensor>((torch::Tensor**)tensors, length));
+        std::string description;
+        if (path) {
+            for (const auto& step : *path)
+                description += (description.empty() ? "" : "; ") + step.equation;
+        }
+        res = make_sharable_string(description);
+    );
+    return res;
 }
 
 Tensor THSTensor_eq(const Tensor left, const Tensor right)
@@ -320,6 +609,11 @@ Tensor THSTensor_exp(const Tensor tensor)
     CATCH_TENSOR(tensor->exp());
 }
 
+Tensor THSTensor_exp_out(const Tensor tensor, const Tensor out)
+{
+    CATCH_TENSOR(torch::exp_out(*out, *tensor));
+}
+
 Tensor THSTensor_exp2(const Tensor tensor)
 {
     CATCH_TENSOR(tensor->exp2());
@@ -636,6 +930,11 @@ Tensor THSTensor_matmul(const Tensor left, const Tensor right)
     return  new torch::Tensor(left->matmul(*right));
 }
 
+Tensor THSTensor_matmul_out(const Tensor left, const Tensor right, const Tensor out)
+{
+    CATCH_TENSOR(torch::matmul_out(*out, *left, *right));
+}
+
 Tensor THSTensor_matrix_exp(const Tensor input)
 {
     CATCH_TENSOR(input->matrix_exp());
@@ -646,6 +945,11 @@ Tensor THSTensor_mm(const Tensor left, const Tensor right)
     CATCH_TENSOR(left->mm(*right));
 }
 
+Tensor THSTensor_mm_out(const Tensor left, const Tensor right, const Tensor out)
+{
+    CATCH_TENSOR(torch::mm_out(*out, *left, *right));
+}
+
 Tensor THSTensor_mv(const Tensor left, const Tensor right)
 {
     CATCH_TENSOR(left->mv(*right));
@@ -661,6 +965,11 @@ Tensor THSTensor_mul(const Tensor left, const Tensor right)
     CATCH_TENSOR(left->mul(*right));
 }
 
+Tensor THSTensor_mul_out(const Tensor left, const Tensor right, const Tensor out)
+{
+    CATCH_TENSOR(torch::mul_out(*out, *left, *right));
+}
+
 Tensor THSTensor_mul_(const Tensor left, const Tensor right)
 {
     CATCH_TENSOR(left->mul_(*right));
@@ -851,6 +1160,11 @@ Tensor THSTensor_sub(const Tensor left, const Tensor right)
     CATCH_TENSOR(left->sub(*right));
 }
 
+Tensor THSTensor_sub_out(const Tensor left, const Tensor right, const Tensor out)
+{
+    CATCH_TENSOR(torch::sub_out(*out, *left, *right));
+}
+
 Tensor THSTensor_sub_(const Tensor left, const Tensor right)
 {
     CATCH_TENSOR(left->sub_(*right));
@@ -876,6 +1190,11 @@ Tensor THSTensor_tanh(const Tensor tensor)
     CATCH_TENSOR(tensor->tanh());
 }
 
+Tensor THSTensor_tanh_out(const Tensor tensor, const Tensor out)
+{
+    CATCH_TENSOR(torch::tanh_out(*out, *tensor));
+}
+
 Tensor THSTensor_tanh_(const Tensor tensor)
 {
     CATCH_TENSOR(tensor->tanh_());
@@ -3,6 +3,9 @@
 
 #include "torch/torch.h"
 #include "torch/cuda.h"
+#include "torch/csrc/jit/frontend/tracer.h"
+#include "torch/csrc/jit/passes/dead_code_elimination.h"
+#include "torch/csrc/jit/runtime/graph_executor.h"
 
 void THSTorch_manual_seed(const int64_t seed)
 {
@@ -93,6 +96,191 @@ const char * THSTorch_get_and_reset_last_err()
     return tmp;
 }
 
+void THSTorch_set_instrumentation(bool enabled)
+{
+    set_instrumentation(enabled);
+}
+
+int THSTorch_is_instrumentation_enabled()
+{
+    return torch_instrumentation_enabled.load(std::memory_order_relaxed);
+}
+
+void THSTorch_reset_instrumentation()
+{
+    reset_instrumentation();
+}
+
+const char * THSTorch_get_instrumentation_report()
+{
+    return make_sharable_string(instrumentation_report());
+}
+
+void THSTorch_set_tensor_tracking(bool enabled)
+{
+    set_tensor_tracking(enabled);
+}
+
+int THSTorch_is_tensor_tracking_enabled()
+{
+    return torch_tensor_tracking_enabled.load(std::memory_order_relaxed);
+}
+
+const char * THSTorch_dump_live_tensors(bool details)
+{
+    return make_sharable_string(live_tensors_report(details));
+}
+
+// Capture and replay of sequences of native calls. While a capture is active on a thread, the JIT
+// tracer records every ATen operation issued on that thread -- whichever THSTensor_ or THSNN_ export
+// it came from -- into a graph whose inputs are the tensors passed to capture_begin. Module parameters
+// and buffers are passed to capture_begin as state: they become further graph inputs, which the graph
+// keeps references to and supplies on every replay, so replays see the current weights. Any other tensor
+// is inserted as a constant, which the tracer refuses to do for tensors that require grad.
+class CapturedCallGraph
+{
+public:
+    CapturedCallGraph(const std::shared_ptr<torch::jit::Graph>& graph, std::vector<at::Tensor> state)
+        : graph(graph), executor(graph, "captured"), state(std::move(state)) { }
+
+    // The number of inputs supplied by the caller on replay.
+    size_t input_count() const { return graph->inputs().size() - state.size(); }
+
+    std::shared_ptr<torch::jit::Graph> graph;
+    torch::jit::GraphExecutor executor;
+    std::vector<at::Tensor> state;
+};
+
+// The state tensors of the capture in progress on this thread.
+static thread_local std::vector<at::Tensor> capture_state;
+
+void THSTorch_capture_begin(const Tensor* inputs, const int length, const Tensor* state, const int state_length)
+{
+    CATCH(
+        if (torch::jit::tracer::isTracing())
+            throw std::runtime_error("A capture is already in progress on this thread.");
+
+        auto tracing = std::make_shared<torch::jit::tracer::TracingState>();
+        auto add_input = [&](const at::Tensor& tensor) {
+            auto value = tracing->graph->addInput();
+            value->setType(c10::TensorType::create(tensor));
+            tracing->setValue(tensor, value);
+        };
+        for (int i = 0; i < length; i++)
+            add_input(*inputs[i]);
+
+        capture_state.clear();
+        for (int i = 0; i < state_length; i++) {
+            add_input(*state[i]);
+            capture_state.push_back(*state[i]);
+        }
+        torch::jit::tracer::setTracingState(tracing);
+    );
+}
+
+void THSTorch_capture_abort()
+{
+    torch::jit::tracer::setTracingState(nullptr);
+    capture_state.clear();
+}
+
+static CapturedGraph capture_end(const Tensor* outputs, const int length)
+{
+    auto state = torch::jit::tracer::getTracingState();
+    if (!state)
+        throw std::runtime_error("There is no capture in progress on this thread.");
+
+    // Stop recording before touching the graph, so that nothing below is captured.
+    torch::jit::tracer::setTracingState(nullptr);
+
+    for (int i = 0; i < length; i++)
+        state->graph->registerOutput(state->getValue(*outputs[i]));
+    torch::jit::EliminateDeadCode(state->graph);
+
+    auto captured = std::make_shared<CapturedCallGraph>(state->graph, std::move(capture_state));
+    capture_state.clear();
+    return new std::shared_ptr<CapturedCallGraph>(captured);
+}
+
+CapturedGraph THSTorch_capture_end(const Tensor* outputs, const int length)
+{
+    CapturedGraph res = nullptr;
+    CATCH(
+        res = capture_end(outputs, length);
+    );
+    return res;
+}
+
+void THSTorch_graph_replay(const CapturedGraph graph, const Tensor* inputs, const int length, Tensor* (*allocator)(size_t length))
+{
+    CATCH(
+        if ((size_t)length != (*graph)->input_count())
+            throw std::runtime_error("The number of inputs does not match the captured graph.");
+
+        torch::jit::Stack stack;
+        stack.reserve((*graph)->graph->inputs().size());
+        for (int i = 0; i < length; i++)
+            stack.emplace_back(*inputs[i]);
+        for (const auto& t : (*graph)->state)
+            stack.emplace_back(t);
+
+        (*graph)->executor.run(stack);
+
+        Tensor* result = allocator(stack.size());
+        for (size_t i = 0; i < stack.size(); i++)
+            result[i] = ResultTensor(stack[i].toTensor());
+    );
+}
+
+const char * THSTorch_graph_str(const CapturedGraph graph)
+{
+    return make_sharable_string((*graph)->graph->toString());
+}
+
+void THSTorch_graph_dispose(const CapturedGraph graph)
+{
+    delete graph;
+}
+
+ProcessGroup THSTorch_process_group_create(const char* name, const int64_t rank, const int64_t world_size, const int64_t slot_bytes, const int64_t timeout_ms)
+{
+    ProcessGroup res = nullptr;
+    CATCH(
+        auto group = std::make_shared<SharedMemoryProcessGroup>(name, rank, world_size, slot_bytes, timeout_ms);
+        SharedMemoryProcessGroup::add(group);
+        res = new std::shared_ptr<SharedMemoryProcessGroup>(group);
+    );
+    return res;
+}
+
+void THSTorch_process_group_all_reduce_(const ProcessGroup group, const Tensor tensor)
+{
+    CATCH(
+        torch::NoGradGuard no_grad;
+        (*group)->all_reduce_sum_(*tensor);
+    );
+}
+
+void THSTorch_process_group_barrier(const ProcessGroup group)
+{
+    CATCH((*group)->barrier(););
+}
+
+int64_t THSTorch_process_group_rank(const ProcessGroup group)
+{
+    return (*group)->rank();
+}
+
+int64_t THSTorch_process_group_size(const ProcessGroup group)
+{
+    return (*group)->world_size();
+}
+
+void THSTorch_process_group_dispose(const ProcessGroup group)
+{
+    delete group;
+}
+
 Scalar THSTorch_int8_to_scalar(int8_t value)
 {
     return new torch::Scalar(value);
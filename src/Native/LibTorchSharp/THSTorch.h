@@ -31,6 +31,33 @@ EXPORT_API(void) THSTorchCuda_synchronize(const int64_t device);
 // Returns the latest error. This is thread-local.
 EXPORT_API(const char *) THSTorch_get_and_reset_last_err();
 
+// Instrumentation of the exported API: call counts, latency and result sizes per export.
+EXPORT_API(void) THSTorch_set_instrumentation(bool enabled);
+EXPORT_API(int)  THSTorch_is_instrumentation_enabled();
+EXPORT_API(void) THSTorch_reset_instrumentation();
+EXPORT_API(const char *) THSTorch_get_instrumentation_report();
+
+// Tracking of live tensor handles, to find handles that are never disposed.
+EXPORT_API(void) THSTorch_set_tensor_tracking(bool enabled);
+EXPORT_API(int)  THSTorch_is_tensor_tracking_enabled();
+EXPORT_API(const char *) THSTorch_dump_live_tensors(bool details);
+
+// Recording a sequence of calls on the current thread into a graph that can be replayed natively.
+EXPORT_API(void) THSTorch_capture_begin(const Tensor* inputs, const int length, const Tensor* state, const int state_length);
+EXPORT_API(void) THSTorch_capture_abort();
+EXPORT_API(CapturedGraph) THSTorch_capture_end(const Tensor* outputs, const int length);
+EXPORT_API(void) THSTorch_graph_replay(const CapturedGraph graph, const Tensor* inputs, const int length, Tensor* (*allocator)(size_t length));
+EXPORT_API(const char *) THSTorch_graph_str(const CapturedGraph graph);
+EXPORT_API(void) THSTorch_graph_dispose(const CapturedGraph graph);
+
+// Process groups on one host that communicate through shared memory, used by SyncBatchNorm.
+EXPORT_API(ProcessGroup) THSTorch_process_group_create(const char* name, const int64_t rank, const int64_t world_size, const int64_t slot_bytes, const int64_t timeout_ms);
+EXPORT_API(void) THSTorch_process_group_all_reduce_(const ProcessGroup group, const Tensor tensor);
+EXPORT_API(void) THSTorch_process_group_barrier(const ProcessGroup group);
+EXPORT_API(int64_t) THSTorch_process_group_rank(const ProcessGroup group);
+EXPORT_API(int64_t) THSTorch_process_group_size(const ProcessGroup group);
+EXPORT_API(void) THSTorch_process_group_dispose(const ProcessGroup group);
+
 EXPORT_API(Scalar) THSTorch_int8_to_scalar(int8_t value);
 EXPORT_API(Scalar) THSTorch_uint8_to_scalar(uint8_t value);
 EXPORT_API(Scalar) THSTorch_int16_to_scalar(short value);
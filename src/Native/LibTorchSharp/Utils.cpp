@@ -1,17 +1,36 @@
 // Copyright (c) .NET Foundation and Contributors.  All Rights Reserved.  See LICENSE in the project root for license information.
 #include "Utils.h"
 
+#include <algorithm>
 #include <cstring>
 #include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 #if _WINDOWS
+#include <windows.h>
 #include <combaseapi.h>
 #define TP_CoTaskMemAlloc(t) CoTaskMemAlloc(t)
 #else
+#include <cerrno>
+#include <fcntl.h>
+#if __linux__
+#include <sched.h>
+#endif
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #define TP_CoTaskMemAlloc(t) malloc(t)
 #endif
 
 thread_local char * torch_last_err = NULL;
 
+std::atomic<bool> torch_instrumentation_enabled(false);
+std::atomic<bool> torch_tensor_tracking_enabled(false);
+
 const char * make_sharable_string(const std::string str)
 {
     size_t n = str.length();
@@ -21,3 +40,591 @@ const char * make_sharable_string(const std::string str)
     return result;
 }
 
+// Instrumentation. Each thread records into its own table, which is only contended when a report is made.
+// Tables are keyed by the address of the export's __func__, which is unique and stable for the life of the process.
+
+static const int instrumentation_buckets = 16;
+
+struct InstrumentationStats
+{
+    int64_t calls = 0;
+    int64_t exceptions = 0;
+    int64_t total_ns = 0;
+    int64_t max_ns = 0;
+    int64_t result_bytes = 0;
+    // Latency histogram: bucket 0 is below 1us, bucket i covers [2^(i-1), 2^i) us, and the last one is open-ended.
+    int64_t histogram[instrumentation_buckets] = { 0 };
+
+    void merge(const InstrumentationStats& other)
+    {
+        calls += other.calls;
+        exceptions += other.exceptions;
+        total_ns += other.total_ns;
+        max_ns = std::max(max_ns, other.max_ns);
+        result_bytes += other.result_bytes;
+        for (int i = 0; i < instrumentation_buckets; i++)
+            histogram[i] += other.histogram[i];
+    }
+};
+
+typedef std::unordered_map<const char*, InstrumentationStats> InstrumentationTable;
+
+struct ThreadInstrumentation;
+
+static std::mutex instrumentation_lock;
+static std::vector<ThreadInstrumentation*> instrumentation_threads;
+// Statistics from threads that have exited.
+static InstrumentationTable instrumentation_retired;
+
+struct ThreadInstrumentation
+{
+    std::mutex lock;
+    InstrumentationTable table;
+
+    ThreadInstrumentation()
+    {
+        std::lock_guard<std::mutex> guard(instrumentation_lock);
+        instrumentation_threads.push_back(this);
+    }
+
+    ~ThreadInstrumentation()
+    {
+        std::lock_guard<std::mutex> guard(instrumentation_lock);
+        for (auto& entry : table)
+            instrumentation_retired[entry.first].merge(entry.second);
+        instrumentation_threads.erase(std::find(instrumentation_threads.begin(), instrumentation_threads.end(), this));
+    }
+};
+
+void record_instrumentation(const char* function, int64_t nanoseconds, bool failed, int64_t result_bytes)
+{
+    static thread_local ThreadInstrumentation instrumentation;
+
+    int bucket = 0;
+    for (int64_t us = nanoseconds / 1000; us > 0 && bucket < instrumentation_buckets - 1; us >>= 1)
+        bucket++;
+
+    std::lock_guard<std::mutex> guard(instrumentation.lock);
+    auto& stats = instrumentation.table[function];
+    stats.calls += 1;
+    stats.exceptions += failed ? 1 : 0;
+    stats.total_ns += nanoseconds;
+    stats.max_ns = std::max(stats.max_ns, nanoseconds);
+    stats.result_bytes += result_bytes;
+    stats.histogram[bucket] += 1;
+}
+
+void set_instrumentation(bool enabled)
+{
+    torch_instrumentation_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void reset_instrumentation()
+{
+    std::lock_guard<std::mutex> guard(instrumentation_lock);
+    instrumentation_retired.clear();
+    for (auto thread : instrumentation_threads) {
+        std::lock_guard<std::mutex> threadGuard(thread->lock);
+        thread->table.clear();
+    }
+}
+
+std::string instrumentation_report()
+{
+    std::unordered_map<std::string, InstrumentationStats> merged;
+    {
+        std::lock_guard<std::mutex> guard(instrumentation_lock);
+        for (auto& entry : instrumentation_retired)
+            merged[entry.first].merge(entry.second);
+        for (auto thread : instrumentation_threads) {
+            std::lock_guard<std::mutex> threadGuard(thread->lock);
+            for (auto& entry : thread->table)
+                merged[entry.first].merge(entry.second);
+        }
+    }
+
+    std::vector<std::pair<std::string, InstrumentationStats>> rows(merged.begin(), merged.end());
+    std::sort(rows.begin(), rows.end(), [](const std::pair<std::string, InstrumentationStats>& a, const std::pair<std::string, InstrumentationStats>& b) {
+        return a.second.total_ns > b.second.total_ns;
+    });
+
+    // Tab-separated, one export per line, most expensive first.
+    std::ostringstream report;
+    report << "function\tcalls\texceptions\ttotal_us\tmean_us\tmax_us\tresult_bytes\thistogram_us(<1";
+    for (int i = 1; i < instrumentation_buckets; i++)
+        report << ",<" << (1LL << i);
+    report << ",inf)\n";
+
+    report << std::fixed << std::setprecision(3);
+    for (auto& row : rows)
+    {
+        auto& stats = row.second;
+        report << row.first << '\t' << stats.calls << '\t' << stats.exceptions << '\t'
+            << stats.total_ns / 1000.0 << '\t' << (stats.calls > 0 ? stats.total_ns / 1000.0 / stats.calls : 0.0) << '\t'
+            << stats.max_ns / 1000.0 << '\t' << stats.result_bytes << '\t';
+        for (int i = 0; i < instrumentation_buckets; i++)
+            report << (i > 0 ? "," : "") << stats.histogram[i];
+        report << '\n';
+    }
+
+    return report.str();
+}
+
+// Tensor handle tracking.
+
+struct TrackedTensor
+{
+    const char* origin;
+    uint64_t serial;
+};
+
+static std::mutex tracking_lock;
+static std::unordered_map<const torch::Tensor*, TrackedTensor> tracked_tensors;
+static uint64_t tracking_serial = 0;
+
+void track_tensor(const torch::Tensor* handle, const char* origin)
+{
+    std::lock_guard<std::mutex> guard(tracking_lock);
+    tracked_tensors[handle] = TrackedTensor{ origin, tracking_serial++ };
+}
+
+void untrack_tensor(const torch::Tensor* handle)
+{
+    std::lock_guard<std::mutex> guard(tracking_lock);
+    tracked_tensors.erase(handle);
+}
+
+void set_tensor_tracking(bool enabled)
+{
+    std::lock_guard<std::mutex> guard(tracking_lock);
+    // Handles created while tracking was on are forgotten, so that a later session starts from a clean slate.
+    if (!enabled)
+        tracked_tensors.clear();
+    torch_tensor_tracking_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+// Shapes and sizes are read when the report is made, since tensors may have been resized since they were created.
+// Bytes are those of the underlying storage, i.e. what the handle keeps alive; handles sharing a storage each count it.
+std::string live_tensors_report(bool details)
+{
+    struct OriginTotals
+    {
+        int64_t count = 0;
+        int64_t bytes = 0;
+    };
+
+    std::ostringstream report;
+    std::unordered_map<std::string, OriginTotals> totals;
+    std::vector<std::pair<uint64_t, std::string>> lines;
+    int64_t allCount = 0;
+    int64_t allBytes = 0;
+
+    {
+        std::lock_guard<std::mutex> guard(tracking_lock);
+        for (auto& entry : tracked_tensors)
+        {
+            auto& t = *entry.first;
+            int64_t bytes = t.has_storage() ? t.storage().nbytes() : t.nbytes();
+
+            auto& origin = totals[entry.second.origin];
+            origin.count += 1;
+            origin.bytes += bytes;
+            allCount += 1;
+            allBytes += bytes;
+
+            if (details) {
+                std::ostringstream line;
+                line << entry.second.serial << '\t' << entry.second.origin << '\t' << t.sizes() << '\t' << t.scalar_type() << '\t' << t.device() << '\t' << bytes << '\n';
+                lines.emplace_back(entry.second.serial, line.str());
+            }
+        }
+    }
+
+    std::vector<std::pair<std::string, OriginTotals>> rows(totals.begin(), totals.end());
+    std::sort(rows.begin(), rows.end(), [](const std::pair<std::string, OriginTotals>& a, const std::pair<std::string, OriginTotals>& b) {
+        return a.second.bytes > b.second.bytes;
+    });
+
+    report << "origin\tlive\tbytes\n";
+    for (auto& row : rows)
+        report << row.first << '\t' << row.second.count << '\t' << row.second.bytes << '\n';
+    report << "total\t" << allCount << '\t' << allBytes << '\n';
+
+    if (details) {
+        std::sort(lines.begin(), lines.end());
+        report << "\nserial\torigin\tshape\tdtype\tdevice\tbytes\n";
+        for (auto& line : lines)
+            report << line.second;
+    }
+
+    return report.str();
+}
+
+#if _WINDOWS
+
+MappedFile::MappedFile(const char* location)
+{
+    _file = CreateFileA(location, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (_file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error(std::string("Could not open file: ") + location);
+
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx(_file, &sz) || sz.QuadPart == 0) {
+        CloseHandle(_file);
+        throw std::runtime_error(std::string("Could not map empty or unreadable file: ") + location);
+    }
+    _size = (size_t)sz.QuadPart;
+
+    _mapping = CreateFileMappingA(_file, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if (_mapping == NULL) {
+        CloseHandle(_file);
+        throw std::runtime_error(std::string("Could not map file: ") + location);
+    }
+
+    _data = (uint8_t*)MapViewOfFile(_mapping, FILE_MAP_COPY, 0, 0, 0);
+    if (_data == NULL) {
+        CloseHandle(_mapping);
+        CloseHandle(_file);
+        throw std::runtime_error(std::string("Could not map file: ") + location);
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    UnmapViewOfFile(_data);
+    CloseHandle(_mapping);
+    CloseHandle(_file);
+}
+
+SharedMemory::SharedMemory(const char* name, size_t size)
+{
+    _mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, NULL, PAGE_READWRITE, (DWORD)((uint64_t)size >> 32), (DWORD)size, name);
+    if (_mapping == NULL)
+        throw std::runtime_error(std::string("Could not create shared memory: ") + name);
+    if (GetLastError() == ERROR_ALREADY_EXISTS) {
+        CloseHandle(_mapping);
+        throw std::runtime_error(std::string("Shared memory already exists: ") + name);
+    }
+
+    _data = (uint8_t*)MapViewOfFile(_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (_data == NULL) {
+        CloseHandle(_mapping);
+        throw std::runtime_error(std::string("Could not map shared memory: ") + name);
+    }
+    _size = size;
+}
+
+SharedMemory::SharedMemory(const char* name)
+{
+    _mapping = OpenFileMappingA(FILE_MAP_ALL_ACCESS, FALSE, name);
+    if (_mapping == NULL)
+        throw std::runtime_error(std::string("Could not open shared memory: ") + name);
+
+    _data = (uint8_t*)MapViewOfFile(_mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+    if (_data == NULL) {
+        CloseHandle(_mapping);
+        throw std::runtime_error(std::string("Could not map shared memory: ") + name);
+    }
+
+    // The size of a named mapping is not recorded anywhere else; the view covers whole pages of it.
+    MEMORY_BASIC_INFORMATION info;
+    VirtualQuery(_data, &info, sizeof(info));
+    _size = info.RegionSize;
+}
+
+SharedMemory::~SharedMemory()
+{
+    UnmapViewOfFile(_data);
+    CloseHandle(_mapping);
+}
+
+void SharedMemory::unlink(const char*)
+{
+}
+
+#else
+
+MappedFile::MappedFile(const char* location)
+{
+    int fd = open(location, O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error(std::string("Could not open file: ") + location);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        throw std::runtime_error(std::string("Could not map empty or unreadable file: ") + location);
+    }
+    _size = (size_t)st.st_size;
+
+    void* addr = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file.
+    close(fd);
+
+    if (addr == MAP_FAILED)
+        throw std::runtime_error(std::string("Could not map file: ") + location);
+
+    _data = (uint8_t*)addr;
+    madvise(_data, _size, MADV_SEQUENTIAL);
+}
+
+MappedFile::~MappedFile()
+{
+    munmap(_data, _size);
+}
+
+// POSIX shared memory names start with a single slash.
+static std::string shared_memory_name(const char* name)
+{
+    return name[0] == '/' ? std::string(name) : "/" + std::string(name);
+}
+
+static uint8_t* map_shared_memory(int fd, size_t size, const char* name)
+{
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED)
+        throw std::runtime_error(std::string("Could not map shared memory: ") + name);
+    return (uint8_t*)addr;
+}
+
+SharedMemory::SharedMemory(const char* name, size_t size)
+{
+    auto path = shared_memory_name(name);
+    int fd = shm_open(path.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        if (errno == EEXIST)
+            throw std::runtime_error(std::string("Shared memory already exists: ") + name + ". Unlink it first if it was left behind by a process that has exited.");
+        throw std::runtime_error(std::string("Could not create shared memory: ") + name);
+    }
+
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        shm_unlink(path.c_str());
+        throw std::runtime_error(std::string("Could not allocate shared memory: ") + name);
+    }
+
+    try {
+        _data = map_shared_memory(fd, size, name);
+    }
+    catch (...) {
+        shm_unlink(path.c_str());
+        throw;
+    }
+    _size = size;
+}
+
+SharedMemory::SharedMemory(const char* name)
+{
+    int fd = shm_open(shared_memory_name(name).c_str(), O_RDWR, 0);
+    if (fd < 0)
+        throw std::runtime_error(std::string("Could not open shared memory: ") + name);
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        throw std::runtime_error(std::string("Could not map empty or unreadable shared memory: ") + name);
+    }
+    _size = (size_t)st.st_size;
+    _data = map_shared_memory(fd, _size, name);
+}
+
+SharedMemory::~SharedMemory()
+{
+    munmap(_data, _size);
+}
+
+void SharedMemory::unlink(const char* name)
+{
+    if (shm_unlink(shared_memory_name(name).c_str()) != 0 && errno != ENOENT)
+        throw std::runtime_error(std::string("Could not unlink shared memory: ") + name);
+}
+
+#endif
+
+bool pin_thread_to_numa_node(int node)
+{
+    if (node < 0)
+        return false;
+#if _WINDOWS
+    GROUP_AFFINITY affinity;
+    if (!GetNumaNodeProcessorMaskEx((USHORT)node, &affinity))
+        return false;
+    return SetThreadGroupAffinity(GetCurrentThread(), &affinity, NULL) != 0;
+#elif __linux__
+    // The node's processors are listed as ranges, e.g. "0-15,32-47".
+    std::ifstream list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string text;
+    if (!std::getline(list, text))
+        return false;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    std::stringstream ranges(text);
+    std::string range;
+    while (std::getline(ranges, range, ',')) {
+        if (range.empty()) continue;
+        auto dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; cpu++)
+            CPU_SET(cpu, &set);
+    }
+    return CPU_COUNT(&set) > 0 && sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    return false;
+#endif
+}
+
+struct SharedMemoryProcessGroup::Control
+{
+    std::atomic<int64_t> ready;      // Set by rank 0 once the fields below are written.
+    int64_t world_size;
+    int64_t slot_bytes;
+    std::atomic<int64_t> attached;   // Ranks that have mapped the segment.
+    std::atomic<int64_t> arrived;    // Ranks waiting at the current barrier.
+    std::atomic<int64_t> generation; // Barriers completed.
+};
+
+static const int64_t process_group_alignment = 64;
+
+SharedMemoryProcessGroup::SharedMemoryProcessGroup(const char* name, int64_t rank, int64_t world_size, int64_t slot_bytes, int64_t timeout_ms)
+    : _rank(rank), _world_size(world_size), _slot_bytes((slot_bytes + process_group_alignment - 1) / process_group_alignment * process_group_alignment), _timeout_ms(timeout_ms)
+{
+    if (world_size < 1 || rank < 0 || rank >= world_size)
+        throw std::runtime_error("The rank must be between 0 and the world size.");
+    if (slot_bytes < 1)
+        throw std::runtime_error("The slot size must be positive.");
+
+    const size_t header = (sizeof(Control) + process_group_alignment - 1) / process_group_alignment * process_group_alignment;
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+
+    if (rank == 0) {
+        // A new segment is zero-filled, so the counters start at zero.
+        _segment = std::make_shared<SharedMemory>(name, header + (size_t)(_slot_bytes * world_size));
+        _control = (Control*)_segment->data();
+        _control->world_size = world_size;
+        _control->slot_bytes = _slot_bytes;
+        _control->ready.store(1, std::memory_order_release);
+    }
+    else {
+        for (;;) {
+            try {
+                _segment = std::make_shared<SharedMemory>(name);
+                _control = (Control*)_segment->data();
+                if (_control->ready.load(std::memory_order_acquire) != 0)
+                    break;
+            }
+            catch (const std::runtime_error&) {
+                // Rank 0 has not created the segment yet.
+            }
+            if (std::chrono::steady_clock::now() > deadline)
+                throw std::runtime_error(std::string("Timed out waiting for rank 0 to create the process group: ") + name);
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+        if (_control->world_size != world_size || _control->slot_bytes != _slot_bytes)
+            throw std::runtime_error(std::string("The process group was created with a different world size or slot size: ") + name);
+    }
+    _slots = _segment->data() + header;
+
+    _control->attached.fetch_add(1);
+    barrier();
+    if (rank == 0)
+        SharedMemory::unlink(name);
+}
+
+void SharedMemoryProcessGroup::barrier()
+{
+    const auto generation = _control->generation.load(std::memory_order_acquire);
+    if (_control->arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == _world_size) {
+        _control->arrived.store(0, std::memory_order_relaxed);
+        _control->generation.fetch_add(1, std::memory_order_acq_rel);
+        return;
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(_timeout_ms);
+    for (int spins = 0; _control->generation.load(std::memory_order_acquire) == generation; spins++) {
+        if (spins < 1000)
+            continue;
+        std::this_thread::yield();
+        if ((spins & 1023) == 0 && std::chrono::steady_clock::now() > deadline)
+            throw std::runtime_error("Timed out waiting for the other ranks of the process group.");
+    }
+}
+
+void SharedMemoryProcessGroup::all_reduce_sum_(at::Tensor& tensor)
+{
+    if (_world_size == 1)
+        return;
+
+    auto work = tensor.device().is_cpu() && tensor.is_contiguous() ? tensor : tensor.to(at::kCPU).contiguous();
+    auto bytes = (uint8_t*)work.data_ptr();
+    const int64_t element = work.element_size();
+    const int64_t per_chunk = _slot_bytes / element;
+
+    for (int64_t start = 0; start < work.numel(); start += per_chunk) {
+        const auto count = std::min(per_chunk, work.numel() - start);
+        memcpy(_slots + _rank * _slot_bytes, bytes + start * element, count * element);
+        barrier();
+
+        // Every rank adds the slots up in rank order, so all of them compute the same sum.
+        auto flat = work.view(-1).narrow(0, start, count);
+        flat.zero_();
+        for (int64_t r = 0; r < _world_size; r++)
+            flat.add_(torch::from_blob(_slots + r * _slot_bytes, { count }, work.options()));
+        barrier();
+    }
+
+    if (!work.is_same(tensor))
+        tensor.copy_(work);
+}
+
+at::Tensor SharedMemoryProcessGroup::all_gather(const at::Tensor& tensor)
+{
+    auto work = tensor.to(at::kCPU).contiguous();
+    std::vector<int64_t> sizes = work.sizes().vec();
+    sizes.insert(sizes.begin(), _world_size);
+    auto result = torch::empty(sizes, work.options());
+    if (_world_size == 1) {
+        result[0].copy_(work);
+        return result.to(tensor.device());
+    }
+
+    auto bytes = (uint8_t*)work.data_ptr();
+    auto gathered = (uint8_t*)result.data_ptr();
+    const int64_t element = work.element_size();
+    const int64_t total = work.numel() * element;
+
+    for (int64_t start = 0; start < total; start += _slot_bytes) {
+        const auto count = std::min(_slot_bytes, total - start);
+        memcpy(_slots + _rank * _slot_bytes, bytes + start, count);
+        barrier();
+        for (int64_t r = 0; r < _world_size; r++)
+            memcpy(gathered + r * total + start, _slots + r * _slot_bytes, count);
+        barrier();
+    }
+    return result.to(tensor.device());
+}
+
+static std::mutex process_group_mutex;
+static std::unordered_map<int64_t, std::weak_ptr<SharedMemoryProcessGroup>> process_groups;
+static int64_t process_group_next_id = 1;
+
+void SharedMemoryProcessGroup::add(const std::shared_ptr<SharedMemoryProcessGroup>& group)
+{
+    std::lock_guard<std::mutex> lock(process_group_mutex);
+    group->_id = process_group_next_id++;
+    process_groups[group->_id] = group;
+}
+
+std::shared_ptr<SharedMemoryProcessGroup> SharedMemoryProcessGroup::find(int64_t id)
+{
+    std::lock_guard<std::mutex> lock(process_group_mutex);
+    auto found = process_groups.find(id);
+    if (found == process_groups.end())
+        return nullptr;
+    auto group = found->second.lock();
+    if (group == nullptr)
+        process_groups.erase(found);
+    return group;
+}
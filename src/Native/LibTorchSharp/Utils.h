@@ -1,6 +1,8 @@
 // Copyright (c) .NET Foundation and Contributors.  All Rights Reserved.  See LICENSE in the project root for license information.
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <string>
 
 #include "TH/THGeneral.h"
@@ -15,6 +17,28 @@ typedef torch::Generator* Generator;
 typedef std::shared_ptr<torch::nn::Module>* NNModule;
 typedef std::shared_ptr<torch::nn::AnyModule> * NNAnyModule;
 typedef std::shared_ptr<torch::optim::Optimizer> * Optimizer;
+class AsyncCheckpointJob;
+typedef std::shared_ptr<AsyncCheckpointJob> * AsyncCheckpoint;
+class TensorIndexPlan;
+typedef std::shared_ptr<TensorIndexPlan> * IndexPlan;
+class ModuleParameterTable;
+typedef std::shared_ptr<ModuleParameterTable> * ParameterTable;
+class ModuleWeightAverage;
+typedef std::shared_ptr<ModuleWeightAverage> * WeightAverage;
+class CapturedCallGraph;
+typedef std::shared_ptr<CapturedCallGraph> * CapturedGraph;
+class SequentialInferencePlan;
+typedef std::shared_ptr<SequentialInferencePlan> * SequentialPlan;
+class PerSampleGradientTrace;
+typedef std::shared_ptr<PerSampleGradientTrace> * PerSampleTrace;
+class IVFSimilarityIndex;
+typedef std::shared_ptr<IVFSimilarityIndex> * IVFIndex;
+class AliasTable;
+typedef std::shared_ptr<AliasTable> * AliasSampler;
+class SequentialPipeline;
+typedef std::shared_ptr<SequentialPipeline> * Pipeline;
+class SharedMemoryProcessGroup;
+typedef std::shared_ptr<SharedMemoryProcessGroup> * ProcessGroup;
 typedef std::shared_ptr<torch::jit::Module> * JITModule;
 typedef std::shared_ptr<torch::jit::Method>* JITMethod;
 typedef std::shared_ptr<torch::jit::Function> * JITFunction;
@@ -23,14 +47,62 @@ typedef std::shared_ptr<c10::Type> * JITType;
 
 #define THS_API TH_API
 
+// Opt-in instrumentation of the exported API. Every export that goes through CATCH is attributed
+// by its function name; when instrumentation is off, the only cost is one relaxed atomic load.
+// The name is taken from __func__, so CATCH belongs at the top level of an export: inside a lambda
+// or a helper it would record "operator()" or the helper's name instead.
+extern std::atomic<bool> torch_instrumentation_enabled;
+
+void record_instrumentation(const char* function, int64_t nanoseconds, bool failed, int64_t result_bytes);
+void set_instrumentation(bool enabled);
+void reset_instrumentation();
+std::string instrumentation_report();
+
+class InstrumentationScope
+{
+public:
+    explicit InstrumentationScope(const char* function) : _function(function), _active(torch_instrumentation_enabled.load(std::memory_order_relaxed))
+    {
+        if (_active)
+            _start = std::chrono::steady_clock::now();
+    }
+
+    ~InstrumentationScope()
+    {
+        if (_active) {
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start).count();
+            record_instrumentation(_function, elapsed, failed, result_bytes);
+        }
+    }
+
+    void add_result(const at::Tensor& result)
+    {
+        if (_active && result.defined())
+            result_bytes += result.nbytes();
+    }
+
+    bool failed = false;
+    int64_t result_bytes = 0;
+
+private:
+    const char* _function;
+    bool _active;
+    std::chrono::steady_clock::time_point _start;
+};
+
 #define CATCH(x) \
+  { \
+  InstrumentationScope _instrumentation(__func__); \
   try { \
     torch_last_err = 0; \
     x \
   } catch (const c10::Error e) { \
+      _instrumentation.failed = true; \
       torch_last_err = strdup(e.what()); \
   } catch (const std::runtime_error e) { \
+      _instrumentation.failed = true; \
       torch_last_err = strdup(e.what()); \
+  } \
   }
 
 #define CATCH_RETURN_RES(ty, dflt, stmt) \
@@ -44,19 +116,46 @@ typedef std::shared_ptr<c10::Type> * JITType;
 #define CATCH_RETURN_NNModule(stmt) CATCH_RETURN_RES(NNModule, NULL, stmt)
 #define CATCH_RETURN_Tensor(stmt) CATCH_RETURN_RES(Tensor, NULL, stmt)
 
+// Debug-time tracking of the tensor handles handed out to .NET, used to find leaked handles.
+// When tracking is off, creating or disposing a handle costs one relaxed atomic load.
+extern std::atomic<bool> torch_tensor_tracking_enabled;
+
+void track_tensor(const torch::Tensor* handle, const char* origin);
+void untrack_tensor(const torch::Tensor* handle);
+void set_tensor_tracking(bool enabled);
+std::string live_tensors_report(bool details);
+
 // Return undefined tensors as NULL to C#
-inline Tensor ResultTensor(const at::Tensor & res)
+inline Tensor make_result_tensor(const at::Tensor & res, const char* origin)
 {
-    if (res.defined())
-        return new torch::Tensor(res);
+    if (res.defined()) {
+        auto handle = new torch::Tensor(res);
+        if (torch_tensor_tracking_enabled.load(std::memory_order_relaxed))
+            track_tensor(handle, origin);
+        return handle;
+    }
     else
         return NULL;
 }
 
+// Handles are attributed to the export that creates them, through __func__. Lambdas and helpers that
+// create handles on an export's behalf use ResultTensorFrom with the export's name instead.
+#define ResultTensor(res) make_result_tensor(res, __func__)
+#define ResultTensorFrom(res, origin) make_result_tensor(res, origin)
+
+// Deletes a tensor handle that was handed out to, or received from, .NET, forgetting it if it is tracked.
+inline void dispose_tensor_handle(const Tensor handle)
+{
+    if (torch_tensor_tracking_enabled.load(std::memory_order_relaxed))
+        untrack_tensor(handle);
+    delete handle;
+}
+
 #define CATCH_TENSOR(expr) \
     at::Tensor res = at::Tensor(); \
     CATCH(  \
         res = expr;  \
+        _instrumentation.add_result(res); \
     );  \
     return ResultTensor(res);
 
@@ -65,6 +164,8 @@ inline Tensor ResultTensor(const at::Tensor & res)
     at::Tensor snd = at::Tensor();  \
     CATCH(  \
         std::tie(fst,snd) = expr;  \
+        _instrumentation.add_result(fst); \
+        _instrumentation.add_result(snd); \
     );  \
     res1 = ResultTensor(fst); \
     res2 = ResultTensor(snd);     
@@ -80,6 +181,105 @@ inline Tensor ResultTensor(const at::Tensor & res)
 // Utility method used to built sharable strings.
 const char * make_sharable_string(const std::string str);
 
+// A private (copy-on-write) memory mapping of a whole file. Tensors created on top of the mapping
+// with from_blob() should hold a shared_ptr to it in their deleter, so that the mapping lives as
+// long as the last tensor viewing it. Writes to such tensors never reach the file.
+class MappedFile
+{
+public:
+    explicit MappedFile(const char* location);
+    ~MappedFile();
+
+    uint8_t* data() const { return _data; }
+    size_t size() const { return _size; }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+private:
+    uint8_t* _data = nullptr;
+    size_t _size = 0;
+#if _WINDOWS
+    void* _file = nullptr;
+    void* _mapping = nullptr;
+#endif
+};
+
+// A named, shared memory segment that other processes on the host can map by name: POSIX shared
+// memory (shm_open) on Linux and macOS, and a named, page-file backed mapping on Windows. Tensors
+// viewing the segment should hold a shared_ptr to it in their deleter, like with MappedFile.
+// Writes are visible to every process that has the segment mapped.
+class SharedMemory
+{
+public:
+    // Creates a new segment of the given size. Fails if a segment with that name exists.
+    SharedMemory(const char* name, size_t size);
+    // Maps an existing segment.
+    explicit SharedMemory(const char* name);
+    ~SharedMemory();
+
+    uint8_t* data() const { return _data; }
+    size_t size() const { return _size; }
+
+    // Removes the name, so that no further process can attach. Processes that have the segment mapped keep it.
+    // On Windows, segments have no persistent name and go away with the last mapping, so this does nothing.
+    static void unlink(const char* name);
+
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+private:
+    uint8_t* _data = nullptr;
+    size_t _size = 0;
+#if _WINDOWS
+    void* _mapping = nullptr;
+#endif
+};
+
+// A group of processes on one host that communicate through a named shared memory segment, with one
+// slot per rank. Collectives must be called by every rank, in the same order. Rank 0 creates the
+// segment; the other ranks attach to it, waiting for it to appear, and its name is removed once all
+// ranks have attached.
+class SharedMemoryProcessGroup
+{
+public:
+    SharedMemoryProcessGroup(const char* name, int64_t rank, int64_t world_size, int64_t slot_bytes, int64_t timeout_ms);
+
+    int64_t rank() const { return _rank; }
+    int64_t world_size() const { return _world_size; }
+
+    // Blocks until every rank has called it.
+    void barrier();
+
+    // Replaces a CPU tensor with the sum of the tensors of all ranks. Every rank gets bitwise identical results.
+    void all_reduce_sum_(at::Tensor& tensor);
+
+    // Returns the tensors of all ranks, stacked along a new leading dimension in rank order.
+    at::Tensor all_gather(const at::Tensor& tensor);
+
+    // Groups are looked up by id from autograd functions, which can only save plain values.
+    int64_t id() const { return _id; }
+    static std::shared_ptr<SharedMemoryProcessGroup> find(int64_t id);
+    static void add(const std::shared_ptr<SharedMemoryProcessGroup>& group);
+
+private:
+    struct Control;
+
+    std::shared_ptr<SharedMemory> _segment;
+    Control* _control = nullptr;
+    uint8_t* _slots = nullptr;
+    int64_t _rank;
+    int64_t _world_size;
+    int64_t _slot_bytes;
+    int64_t _timeout_ms;
+    int64_t _id = 0;
+};
+
+// Restricts the calling thread to the processors of a NUMA node. Threads it creates afterwards, such as
+// its intra-op worker threads, inherit the restriction. Returns false if the node does not exist or the
+// platform does not support it, leaving the thread unrestricted.
+bool pin_thread_to_numa_node(int node);
+
 // Method concerting arrays of tensor pointers into arrays of tensors.
 template<class T>
 std::vector<T> toTensors(torch::Tensor ** tensorPtrs, const int length)
@@ -0,0 +1,109 @@
+// Copyright (c) .NET Foundation and Contributors.  All Rights Reserved.  See LICENSE in the project root for license information.
+using System;
+using System.Runtime.InteropServices;
+
+namespace TorchSharp
+{
+    public static partial class torch
+    {
+        [DllImport("LibTorchSharp")]
+        private static extern IntPtr THSTensor_alias_sampler_create(IntPtr probs);
+
+        /// <summary>
+        /// Builds a sampler for the categorical distribution given by a vector of (unnormalized) probabilities,
+        /// using Walker's alias method. Building the sampler takes time proportional to the number of categories,
+        /// after which every sample takes constant time, which makes it much faster than multinomial() when
+        /// drawing repeatedly from the same large distribution.
+        /// </summary>
+        /// <param name="probs">Non-negative weights, one per category.</param>
+        public static AliasSampler alias_sampler(Tensor probs)
+        {
+            var res = THSTensor_alias_sampler_create(probs.Handle);
+            if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+            return new AliasSampler(res);
+        }
+
+        /// <summary>
+        /// A sampler for a fixed categorical distribution. See torch.alias_sampler().
+        /// </summary>
+        public sealed class AliasSampler : IDisposable
+        {
+            internal sealed class HType : SafeHandle
+            {
+                public HType(IntPtr preexistingHandle, bool ownsHandle) : base(IntPtr.Zero, ownsHandle)
+                {
+                    SetHandle(preexistingHandle);
+                }
+
+                public override bool IsInvalid => handle == IntPtr.Zero;
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSTensor_alias_sampler_dispose(HType handle);
+
+                protected override bool ReleaseHandle()
+                {
+                    if (!IsInvalid) THSTensor_alias_sampler_dispose(this);
+                    SetHandle(IntPtr.Zero);
+                    return true;
+                }
+
+                protected override void Dispose(bool disposing)
+                {
+                    if (disposing) {
+                        ReleaseHandle();
+                    }
+                }
+            }
+
+            internal HType handle;
+
+            internal AliasSampler(IntPtr handle)
+            {
+                this.handle = new HType(handle, true);
+            }
+
+            [DllImport("LibTorchSharp")]
+            private static extern IntPtr THSTensor_alias_sampler_sample(HType sampler, IntPtr shape, int length, IntPtr gen);
+
+            /// <summary>
+            /// Draws independent samples, with replacement, on the device of the probabilities the sampler was built from.
+            /// </summary>
+            /// <param name="shape">The shape of the tensor of category indices to return.</param>
+            /// <param name="generator">An optional random number generator.</param>
+            public Tensor sample(long[] shape, Generator generator = null)
+            {
+                unsafe {
+                    fixed (long* pShape = shape) {
+                        var res = THSTensor_alias_sampler_sample(handle, (IntPtr)pShape, shape.Length, (generator is null) ? IntPtr.Zero : generator.Handle);
+                        if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+                        return new Tensor(res);
+                    }
+                }
+            }
+
+            /// <summary>
+            /// Draws independent samples, with replacement.
+            /// </summary>
+            /// <param name="num_samples">The number of category indices to return.</param>
+            /// <param name="generator">An optional random number generator.</param>
+            public Tensor sample(long num_samples, Generator generator = null) => sample(new long[] { num_samples }, generator);
+
+            [DllImport("LibTorchSharp")]
+            private static extern long THSTensor_alias_sampler_categories(HType sampler);
+
+            /// <summary>
+            /// The number of categories.
+            /// </summary>
+            public long categories => THSTensor_alias_sampler_categories(handle);
+
+            /// <summary>
+            ///   Releases the sampler.
+            /// </summary>
+            public void Dispose()
+            {
+                handle.Dispose();
+                handle.SetHandleAsInvalid();
+            }
+        }
+    }
+}
@@ -154,6 +154,181 @@ namespace TorchSharp
 
 
             }
+
+            private delegate void BatchedProduct(
+             IntPtr outputs, long oLength,
+             IntPtr inputs, long iLength,
+             IntPtr vectors, long vLength,
+             bool retain_graph, bool create_graph,
+             AllocatePinnedArray allocator);
+
+            [DllImport("LibTorchSharp")]
+            private static extern void THSAutograd_batched_vjp(
+             IntPtr outputs, long oLength,
+             IntPtr inputs, long iLength,
+             IntPtr grad_outs, long gLength,
+             bool retain_graph, bool create_graph,
+             AllocatePinnedArray allocator);
+
+            [DllImport("LibTorchSharp")]
+            private static extern void THSAutograd_batched_jvp(
+             IntPtr outputs, long oLength,
+             IntPtr inputs, long iLength,
+             IntPtr tangents, long tLength,
+             bool retain_graph, bool create_graph,
+             AllocatePinnedArray allocator);
+
+            private static IList<Tensor> batched_product(BatchedProduct product, IList<Tensor> outputs, IList<Tensor> inputs, IList<Tensor> vectors, bool retain_graph, bool create_graph)
+            {
+                IntPtr[] result;
+
+                using (var outs = new PinnedArray<IntPtr>())
+                using (var ins = new PinnedArray<IntPtr>())
+                using (var vecs = new PinnedArray<IntPtr>())
+                using (var results = new PinnedArray<IntPtr>()) {
+
+                    IntPtr outsRef = outs.CreateArray(outputs.Select(p => p.Handle).ToArray());
+                    IntPtr insRef = ins.CreateArray(inputs.Select(p => p.Handle).ToArray());
+                    IntPtr vecsRef = vecs.CreateArray(vectors.Select(p => p.Handle).ToArray());
+
+                    product(outsRef, outs.Array.Length, insRef, ins.Array.Length, vecsRef, vecs.Array.Length, retain_graph, create_graph, results.CreateArray);
+                    torch.CheckForErrors();
+                    result = results.Array;
+                }
+
+                return result.Select(x => new Tensor(x)).ToList();
+            }
+
+            /// <summary>
+            /// Computes vector-Jacobian products for many vectors at once, in a single vectorized backward pass.
+            /// </summary>
+            /// <param name="outputs">Outputs of the differentiated function.</param>
+            /// <param name="inputs">Inputs w.r.t. which the products are computed.</param>
+            /// <param name="grad_outputs">One tensor per output, holding all the vectors stacked along dimension 0.</param>
+            /// <param name="retain_graph">If false, the graph used to compute the products will be freed.</param>
+            /// <param name="create_graph">If true, a graph of the products will be constructed, allowing higher order derivatives.</param>
+            /// <returns>One tensor per input, holding the products for all vectors stacked along dimension 0.</returns>
+            public static IList<Tensor> batched_vjp(IList<Tensor> outputs, IList<Tensor> inputs, IList<Tensor> grad_outputs, bool retain_graph = false, bool create_graph = false)
+            {
+                return batched_product(THSAutograd_batched_vjp, outputs, inputs, grad_outputs, retain_graph, create_graph);
+            }
+
+            /// <summary>
+            /// Computes Jacobian-vector products for many tangent directions at once, in a single vectorized pass.
+            /// </summary>
+            /// <param name="outputs">Outputs of the differentiated function.</param>
+            /// <param name="inputs">Inputs w.r.t. which the products are computed. They must require grad.</param>
+            /// <param name="tangents">One tensor per input, holding all the tangent directions stacked along dimension 0.</param>
+            /// <param name="retain_graph">If false, the graph used to compute the products will be freed.</param>
+            /// <param name="create_graph">If true, a graph of the products will be constructed, allowing higher order derivatives.</param>
+            /// <returns>One tensor per output, holding the products for all directions stacked along dimension 0.</returns>
+            public static IList<Tensor> batched_jvp(IList<Tensor> outputs, IList<Tensor> inputs, IList<Tensor> tangents, bool retain_graph = false, bool create_graph = false)
+            {
+                return batched_product(THSAutograd_batched_jvp, outputs, inputs, tangents, retain_graph, create_graph);
+            }
+
+            [DllImport("LibTorchSharp")]
+            private static extern void THSAutograd_batched_hvp(
+             IntPtr output,
+             IntPtr inputs, long iLength,
+             IntPtr directions, long dLength,
+             bool retain_graph, bool create_graph,
+             AllocatePinnedArray allocator);
+
+            /// <summary>
+            /// Computes Hessian-vector products of a scalar output for many directions at once, in a single vectorized pass.
+            /// </summary>
+            /// <param name="output">The scalar output of the differentiated function.</param>
+            /// <param name="inputs">Inputs w.r.t. which the products are computed.</param>
+            /// <param name="directions">One tensor per input, holding all the directions stacked along dimension 0.</param>
+            /// <param name="retain_graph">If false, the graph used to compute the products will be freed.</param>
+            /// <param name="create_graph">If true, a graph of the products will be constructed, allowing higher order derivatives.</param>
+            /// <returns>One tensor per input, holding the products for all directions stacked along dimension 0.</returns>
+            public static IList<Tensor> batched_hvp(Tensor output, IList<Tensor> inputs, IList<Tensor> directions, bool retain_graph = false, bool create_graph = false)
+            {
+                return batched_product(
+                    (outs, oLength, ins, iLength, dirs, dLength, retain, create, allocator) => THSAutograd_batched_hvp(output.Handle, ins, iLength, dirs, dLength, retain, create, allocator),
+                    new[] { output }, inputs, directions, retain_graph, create_graph);
+            }
+
+            /// <summary>
+            /// Forward-mode automatic differentiation, using dual tensors that carry a tangent alongside their value.
+            /// </summary>
+            public static class forward_ad
+            {
+                [DllImport("LibTorchSharp")]
+                private static extern long THSAutograd_enter_dual_level();
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSAutograd_exit_dual_level(long level);
+
+                [ThreadStatic]
+                private static long? _current_level;
+
+                private class DualLevel : IDisposable
+                {
+                    public DualLevel()
+                    {
+                        _level = THSAutograd_enter_dual_level();
+                        torch.CheckForErrors();
+                        _previous = _current_level;
+                        _current_level = _level;
+                    }
+
+                    public void Dispose()
+                    {
+                        if (_level < 0) return;
+                        _current_level = _previous;
+                        THSAutograd_exit_dual_level(_level);
+                        _level = -1;
+                        torch.CheckForErrors();
+                    }
+
+                    private long _level;
+                    private long? _previous;
+                }
+
+                /// <summary>
+                /// Context-manager for forward-mode AD. Dual tensors must be created, and are only dual, within this scope;
+                /// on exit, all tangents created in it are discarded.
+                /// </summary>
+                public static IDisposable dual_level() => new DualLevel();
+
+                private static long CurrentLevel()
+                {
+                    if (!_current_level.HasValue)
+                        throw new InvalidOperationException("Dual tensors can only be used inside a 'using (torch.autograd.forward_ad.dual_level())' scope.");
+                    return _current_level.Value;
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern IntPtr THSAutograd_make_dual(IntPtr primal, IntPtr tangent, long level);
+
+                /// <summary>
+                /// Associates a tangent with a tensor, returning a dual tensor whose operations also compute the directional derivative.
+                /// </summary>
+                /// <param name="tensor">The primal value.</param>
+                /// <param name="tangent">The direction, with the same shape as the tensor.</param>
+                public static Tensor make_dual(Tensor tensor, Tensor tangent)
+                {
+                    var res = THSAutograd_make_dual(tensor.Handle, tangent.Handle, CurrentLevel());
+                    if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+                    return new Tensor(res);
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern IntPtr THSAutograd_unpack_dual(IntPtr dual, long level, out IntPtr tangent);
+
+                /// <summary>
+                /// Splits a dual tensor into its primal value and its tangent, which is null if the tensor is not dual.
+                /// </summary>
+                public static (Tensor primal, Tensor tangent) unpack_dual(Tensor tensor)
+                {
+                    var res = THSAutograd_unpack_dual(tensor.Handle, CurrentLevel(), out var tangent);
+                    if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+                    return (new Tensor(res), tangent == IntPtr.Zero ? null : new Tensor(tangent));
+                }
+            }
         }
     }
 }
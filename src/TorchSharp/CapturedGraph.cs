@@ -0,0 +1,198 @@
+// Copyright (c) .NET Foundation and Contributors.  All Rights Reserved.  See LICENSE in the project root for license information.
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.InteropServices;
+
+namespace TorchSharp
+{
+    public static partial class torch
+    {
+        [DllImport("LibTorchSharp")]
+        private static extern void THSTorch_capture_begin(IntPtr inputs, int length, IntPtr state, int state_length);
+
+        /// <summary>
+        /// Start recording the tensor operations issued on the current thread, with the given tensors as the inputs of the recording.
+        /// Other tensors that require grad cannot be recorded; pass them, e.g. module parameters, with the state overload.
+        /// </summary>
+        /// <param name="inputs">The tensors that will be replaced by new data when the recording is replayed.</param>
+        public static void capture_begin(params Tensor[] inputs)
+        {
+            capture_begin(inputs, Array.Empty<Tensor>());
+        }
+
+        /// <summary>
+        /// Start recording the tensor operations issued on the current thread, with the given tensors as the inputs of the recording.
+        /// </summary>
+        /// <param name="inputs">The tensors that will be replaced by new data when the recording is replayed.</param>
+        /// <param name="state">Tensors, such as module parameters and buffers, that the recording refers to rather than copies,
+        /// so that replays see their current values.</param>
+        public static void capture_begin(Tensor[] inputs, IEnumerable<Tensor> state)
+        {
+            var stateArray = state.ToArray();
+            var handles = inputs.Select(t => t.Handle).ToArray();
+            var stateHandles = stateArray.Select(t => t.Handle).ToArray();
+            unsafe {
+                fixed (IntPtr* pInputs = handles, pState = stateHandles) {
+                    THSTorch_capture_begin((IntPtr)pInputs, handles.Length, (IntPtr)pState, stateHandles.Length);
+                }
+            }
+            torch.CheckForErrors();
+            GC.KeepAlive(inputs);
+            GC.KeepAlive(stateArray);
+        }
+
+        [DllImport("LibTorchSharp")]
+        private static extern void THSTorch_capture_abort();
+
+        /// <summary>
+        /// Stop recording on the current thread and discard the recording.
+        /// </summary>
+        public static void capture_abort()
+        {
+            THSTorch_capture_abort();
+        }
+
+        [DllImport("LibTorchSharp")]
+        private static extern IntPtr THSTorch_capture_end(IntPtr outputs, int length);
+
+        /// <summary>
+        /// Stop recording on the current thread and return the recorded graph, computing the given outputs.
+        /// </summary>
+        /// <param name="outputs">The tensors that replaying the graph should produce.</param>
+        public static CapturedGraph capture_end(params Tensor[] outputs)
+        {
+            var handles = outputs.Select(t => t.Handle).ToArray();
+            IntPtr res;
+            unsafe {
+                fixed (IntPtr* pOutputs = handles) {
+                    res = THSTorch_capture_end((IntPtr)pOutputs, handles.Length);
+                }
+            }
+            if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+            GC.KeepAlive(outputs);
+            return new CapturedGraph(res);
+        }
+
+        /// <summary>
+        /// Record the tensor operations performed by a function, so that they can later be replayed natively with one call.
+        /// </summary>
+        /// <param name="fn">The function to record. It must perform the same operations regardless of the values in its inputs.</param>
+        /// <param name="inputs">Example inputs, with the shapes and types the graph will be replayed with.</param>
+        public static CapturedGraph capture(Func<Tensor[], Tensor[]> fn, params Tensor[] inputs)
+        {
+            return capture_with_state(fn, Array.Empty<Tensor>(), inputs);
+        }
+
+        /// <summary>
+        /// Record the tensor operations performed by a function that uses a module, so that they can later be replayed natively with one call.
+        /// The module's parameters and buffers are referred to by the recording, so replays use their current values.
+        /// </summary>
+        /// <param name="fn">The function to record. It must perform the same operations regardless of the values in its inputs.</param>
+        /// <param name="module">The module whose parameters and buffers the function uses.</param>
+        /// <param name="inputs">Example inputs, with the shapes and types the graph will be replayed with.</param>
+        public static CapturedGraph capture(Func<Tensor[], Tensor[]> fn, nn.Module module, params Tensor[] inputs)
+        {
+            var state = module.parameters().Concat(module.named_buffers().Select(b => b.parameter)).ToArray();
+            return capture_with_state(fn, state, inputs);
+        }
+
+        private static CapturedGraph capture_with_state(Func<Tensor[], Tensor[]> fn, Tensor[] state, Tensor[] inputs)
+        {
+            capture_begin(inputs, state);
+            Tensor[] outputs;
+            try {
+                outputs = fn(inputs);
+            } catch {
+                capture_abort();
+                throw;
+            }
+            return capture_end(outputs);
+        }
+
+        /// <summary>
+        /// A sequence of tensor operations recorded by torch.capture_begin() / capture_end(), which can be re-executed against
+        /// new inputs natively, without a transition into .NET per operation.
+        /// </summary>
+        public sealed class CapturedGraph : IDisposable
+        {
+            internal sealed class HType : SafeHandle
+            {
+                public HType(IntPtr preexistingHandle, bool ownsHandle) : base(IntPtr.Zero, ownsHandle)
+                {
+                    SetHandle(preexistingHandle);
+                }
+
+                public override bool IsInvalid => handle == IntPtr.Zero;
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSTorch_graph_dispose(HType handle);
+
+                protected override bool ReleaseHandle()
+                {
+                    if (!IsInvalid) THSTorch_graph_dispose(this);
+                    SetHandle(IntPtr.Zero);
+                    return true;
+                }
+
+                protected override void Dispose(bool disposing)
+                {
+                    if (disposing) {
+                        ReleaseHandle();
+                    }
+                }
+            }
+
+            internal HType handle;
+
+            internal CapturedGraph(IntPtr handle)
+            {
+                this.handle = new HType(handle, true);
+            }
+
+            [DllImport("LibTorchSharp")]
+            private static extern void THSTorch_graph_replay(HType graph, IntPtr inputs, int length, AllocatePinnedArray allocator);
+
+            /// <summary>
+            /// Re-execute the recorded operations against new inputs.
+            /// </summary>
+            /// <param name="inputs">Tensors of the same shapes and types as the inputs given when recording.</param>
+            /// <returns>One tensor per output given to capture_end().</returns>
+            public Tensor[] replay(params Tensor[] inputs)
+            {
+                var handles = inputs.Select(t => t.Handle).ToArray();
+                IntPtr[] ptrArray;
+
+                using (var pa = new PinnedArray<IntPtr>()) {
+                    unsafe {
+                        fixed (IntPtr* pInputs = handles) {
+                            THSTorch_graph_replay(handle, (IntPtr)pInputs, handles.Length, pa.CreateArray);
+                        }
+                    }
+                    torch.CheckForErrors();
+                    ptrArray = pa.Array;
+                }
+                GC.KeepAlive(inputs);
+                return ptrArray.Select(x => new Tensor(x)).ToArray();
+            }
+
+            [DllImport("LibTorchSharp")]
+            [return: MarshalAs(UnmanagedType.LPStr)]
+            private static extern string THSTorch_graph_str(HType graph);
+
+            /// <summary>
+            /// A textual rendering of the recorded graph, for debugging.
+            /// </summary>
+            public override string ToString() => THSTorch_graph_str(handle);
+
+            /// <summary>
+            ///   Releases the recorded graph.
+            /// </summary>
+            public void Dispose()
+            {
+                handle.Dispose();
+                handle.SetHandleAsInvalid();
+            }
+        }
+    }
+}
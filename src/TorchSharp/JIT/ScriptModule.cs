@@ -0,0 +1,142 @@
+// Copyright (c) .NET Foundation and Contributors.  All Rights Reserved.  See LICENSE in the project root for license information.
+using System;
+using System.Linq;
+using System.Runtime.InteropServices;
+
+namespace TorchSharp
+{
+    public static partial class torch
+    {
+        public static partial class jit
+        {
+            /// <summary>
+            /// A TorchScript module, either traced from a TorchSharp module or loaded from a file.
+            /// </summary>
+            public sealed class ScriptModule : IDisposable
+            {
+                internal sealed class HType : SafeHandle
+                {
+                    public HType(IntPtr preexistingHandle, bool ownsHandle) : base(IntPtr.Zero, ownsHandle)
+                    {
+                        SetHandle(preexistingHandle);
+                    }
+
+                    public override bool IsInvalid => handle == IntPtr.Zero;
+
+                    [DllImport("LibTorchSharp")]
+                    private static extern void THSJIT_Module_dispose(HType handle);
+
+                    protected override bool ReleaseHandle()
+                    {
+                        if (!IsInvalid) THSJIT_Module_dispose(this);
+                        SetHandle(IntPtr.Zero);
+                        return true;
+                    }
+
+                    protected override void Dispose(bool disposing)
+                    {
+                        if (disposing) {
+                            ReleaseHandle();
+                        }
+                    }
+                }
+
+                internal HType handle;
+
+                internal ScriptModule(IntPtr handle)
+                {
+                    this.handle = new HType(handle, true);
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern IntPtr THSJIT_Module_forward(HType module, IntPtr tensors, int length);
+
+                /// <summary>
+                /// Run the module's TorchScript forward method.
+                /// </summary>
+                public Tensor forward(params Tensor[] inputs)
+                {
+                    var handles = inputs.Select(t => t.Handle).ToArray();
+                    IntPtr res;
+                    unsafe {
+                        fixed (IntPtr* pInputs = handles) {
+                            res = THSJIT_Module_forward(handle, (IntPtr)pInputs, handles.Length);
+                        }
+                    }
+                    if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+                    GC.KeepAlive(inputs);
+                    return new Tensor(res);
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSJIT_save(HType module, [MarshalAs(UnmanagedType.LPStr)] string filename, bool freeze);
+
+                /// <summary>
+                /// Write the module to a TorchScript file, which can be loaded with torch.jit.load() or by LibTorch and PyTorch.
+                /// </summary>
+                /// <param name="filename">The file to write.</param>
+                /// <param name="freeze">
+                /// Save a frozen, evaluation-mode copy of the module, with its parameters inlined into the graph
+                /// and the graph optimized for inference. A frozen module can no longer be trained.
+                /// </param>
+                public void save(string filename, bool freeze = true)
+                {
+                    THSJIT_save(handle, filename, freeze);
+                    torch.CheckForErrors();
+                }
+
+                /// <summary>
+                ///   Releases the module.
+                /// </summary>
+                public void Dispose()
+                {
+                    handle.Dispose();
+                    handle.SetHandleAsInvalid();
+                }
+            }
+
+            private delegate IntPtr ForwardFunctionC(IntPtr tensor);
+
+            [DllImport("LibTorchSharp")]
+            private static extern IntPtr THSJIT_trace(nn.Module.HType module, IntPtr input, ForwardFunctionC forward);
+
+            /// <summary>
+            /// Trace a module into TorchScript by running its forward() on an example input and recording the native operations it performs.
+            /// The parameters and buffers of the traced module are shared with the original.
+            /// </summary>
+            /// <param name="module">The module to trace.</param>
+            /// <param name="example">An example input.</param>
+            /// <remarks>As with any trace, control flow that depends on the data is recorded only as taken for the example.</remarks>
+            public static ScriptModule trace(nn.Module module, Tensor example)
+            {
+                ForwardFunctionC forwardNative = t => {
+                    var input = new Tensor(t);
+                    var output = module.forward(input);
+
+                    // The caller owns the input handle and takes ownership of the output handle.
+                    if (ReferenceEquals(output, input)) output = input.alias();
+                    input.DecoupleFromNativeHandle();
+                    return output.DecoupleFromNativeHandle();
+                };
+
+                var res = THSJIT_trace(module.handle, example.Handle, forwardNative);
+                if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+                GC.KeepAlive(forwardNative);
+                return new ScriptModule(res);
+            }
+
+            [DllImport("LibTorchSharp")]
+            private static extern IntPtr THSJIT_load([MarshalAs(UnmanagedType.LPStr)] string filename);
+
+            /// <summary>
+            /// Load a TorchScript module from a file.
+            /// </summary>
+            public static ScriptModule load(string filename)
+            {
+                var res = THSJIT_load(filename);
+                if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+                return new ScriptModule(res);
+            }
+        }
+    }
+}
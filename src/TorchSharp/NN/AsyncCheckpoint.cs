@@ -0,0 +1,82 @@
+// Copyright (c) .NET Foundation and Contributors.  All Rights Reserved.  See LICENSE in the project root for license information.
+using System;
+using System.Runtime.InteropServices;
+
+namespace TorchSharp
+{
+    public static partial class torch
+    {
+        public static partial class nn
+        {
+            /// <summary>
+            /// A handle to a checkpoint that is being written in the background by Module.save_async().
+            /// </summary>
+            public sealed class AsyncCheckpoint : IDisposable
+            {
+                internal sealed class HType : SafeHandle
+                {
+                    public HType(IntPtr preexistingHandle, bool ownsHandle) : base(IntPtr.Zero, ownsHandle)
+                    {
+                        SetHandle(preexistingHandle);
+                    }
+
+                    public override bool IsInvalid => handle == IntPtr.Zero;
+
+                    [DllImport("LibTorchSharp")]
+                    private static extern void THSNN_AsyncCheckpoint_dispose(HType handle);
+
+                    protected override bool ReleaseHandle()
+                    {
+                        if (!IsInvalid) THSNN_AsyncCheckpoint_dispose(this);
+                        SetHandle(IntPtr.Zero);
+                        return true;
+                    }
+
+                    protected override void Dispose(bool disposing)
+                    {
+                        if (disposing) {
+                            ReleaseHandle();
+                        }
+                    }
+                }
+
+                internal HType handle;
+
+                internal AsyncCheckpoint(IntPtr handle)
+                {
+                    this.handle = new HType(handle, true);
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern bool THSNN_AsyncCheckpoint_is_completed(HType handle);
+
+                /// <summary>
+                /// True if the checkpoint has been written (or failed), i.e. Wait() will not block.
+                /// </summary>
+                public bool IsCompleted => THSNN_AsyncCheckpoint_is_completed(handle);
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSNN_AsyncCheckpoint_wait(HType handle);
+
+                /// <summary>
+                /// Block until the checkpoint has been written and flushed to disk.
+                /// Throws if writing the checkpoint failed.
+                /// </summary>
+                public void Wait()
+                {
+                    THSNN_AsyncCheckpoint_wait(handle);
+                    torch.CheckForErrors();
+                }
+
+                /// <summary>
+                ///   Releases the handle. A checkpoint that is still being written will be completed regardless.
+                /// </summary>
+                public void Dispose()
+                {
+                    handle.Dispose();
+                    handle.SetHandleAsInvalid();
+                }
+            }
+        }
+    }
+}
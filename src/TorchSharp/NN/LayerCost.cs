@@ -0,0 +1,60 @@
+// Copyright (c) .NET Foundation and Contributors.  All Rights Reserved.  See LICENSE in the project root for license information.
+
+namespace TorchSharp
+{
+    public static partial class torch
+    {
+        public static partial class nn
+        {
+            /// <summary>
+            /// The estimated cost of one layer's forward pass, as reported by Module.profile_cost().
+            /// </summary>
+            public sealed class LayerCost
+            {
+                internal LayerCost(string name, string kind, long parameters, long activation_bytes, long? flops, long memory_traffic_bytes)
+                {
+                    this.name = name;
+                    this.kind = kind;
+                    this.parameters = parameters;
+                    this.activation_bytes = activation_bytes;
+                    this.flops = flops;
+                    this.memory_traffic_bytes = memory_traffic_bytes;
+                }
+
+                /// <summary>
+                /// The layer's dotted path within the module, e.g. '2.0'; empty for the module itself.
+                /// </summary>
+                public string name { get; }
+
+                /// <summary>
+                /// The layer type, e.g. 'Conv2d', or the name of a custom module.
+                /// </summary>
+                public string kind { get; }
+
+                /// <summary>
+                /// The number of parameter elements.
+                /// </summary>
+                public long parameters { get; }
+
+                /// <summary>
+                /// The bytes of the layer's output, plus any intermediates it materializes, such as attention weights.
+                /// Zero for layers whose output is a view of their input.
+                /// </summary>
+                public long activation_bytes { get; }
+
+                /// <summary>
+                /// Floating-point operations, counting a multiply-add as two; null if the layer type has no closed form.
+                /// </summary>
+                public long? flops { get; }
+
+                /// <summary>
+                /// Estimated bytes moved to and from memory: the input, the parameters read, the output, and
+                /// intermediates written and read back, each counted once.
+                /// </summary>
+                public long memory_traffic_bytes { get; }
+
+                public override string ToString() => $"{name} ({kind}): {parameters} parameters, {activation_bytes} activation bytes, {(flops.HasValue ? flops.Value.ToString() : "?")} FLOPs, {memory_traffic_bytes} bytes of traffic";
+            }
+        }
+    }
+}
@@ -447,6 +447,20 @@ namespace TorchSharp
                 Mean = 1,
                 Sum = 2
             }
+
+            /// <summary>
+            /// The losses Optimizer.train_step() can compute natively, each with mean reduction.
+            /// </summary>
+            public enum LossKind : long
+            {
+                MSE = 0,
+                L1 = 1,
+                CrossEntropy = 2,
+                NLL = 3,
+                BinaryCrossEntropyWithLogits = 4,
+                SmoothL1 = 5,
+                Huber = 6
+            }
         }
     }
 }
@@ -104,6 +104,7 @@ namespace TorchSharp
                         handle.Dispose();
                         handle.SetHandleAsInvalid();
                         boxedModule?.Dispose();
+                        _parameterTable?.Dispose();
                     }
                 }
 
@@ -233,6 +234,52 @@ namespace TorchSharp
                     THSNN_Module_save(handle, modelPath);
                 }
 
+                [DllImport("LibTorchSharp")]
+                private static extern IntPtr THSNN_Module_save_async(HType module, [MarshalAs(UnmanagedType.LPStr)] string location, optim.Optimizer.HType optimizer, [MarshalAs(UnmanagedType.LPStr)] string optimizer_location);
+
+                /// <summary>
+                /// Checkpoint the module, and optionally an optimizer, on a background thread.
+                /// Parameters, buffers and optimizer state are snapshotted before the call returns, so training may continue
+                /// right away. Only one checkpoint is written at a time; if one is still in flight, this call waits for it first.
+                /// </summary>
+                /// <param name="location">The file path of the module checkpoint, in the same format as Save().</param>
+                /// <param name="optimizer">An optional (native) optimizer whose state should be checkpointed as well.</param>
+                /// <param name="optimizer_location">The file path of the optimizer checkpoint.</param>
+                /// <returns>A handle that can be used to poll or wait for the checkpoint to be on disk.</returns>
+                public AsyncCheckpoint save_async(string location, optim.Optimizer optimizer = null, string optimizer_location = null)
+                {
+                    if (optimizer != null && (optimizer.handle == null || optimizer_location == null))
+                        throw new ArgumentException("The optimizer must be a native optimizer, and a location must be given for its state.");
+
+                    var res = THSNN_Module_save_async(handle, location, optimizer?.handle ?? new optim.Optimizer.HType(IntPtr.Zero, false), optimizer_location);
+                    if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+                    return new AsyncCheckpoint(res);
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSNN_Module_load_checkpoint(HType module, [MarshalAs(UnmanagedType.LPStr)] string location);
+
+                /// <summary>
+                /// Restore the parameters and buffers of this module from a checkpoint written by save_async() or Save().
+                /// </summary>
+                /// <param name="location">The file path of the module checkpoint.</param>
+                public void load_checkpoint(string location)
+                {
+                    THSNN_Module_load_checkpoint(handle, location);
+                    torch.CheckForErrors();
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSNN_Module_clear_checkpoint_staging();
+
+                /// <summary>
+                /// Release the CPU staging copies that save_async() keeps, one per parameter and buffer name, for reuse by later checkpoints.
+                /// </summary>
+                public static void clear_checkpoint_staging()
+                {
+                    THSNN_Module_clear_checkpoint_staging();
+                }
+
                 [DllImport("LibTorchSharp")]
                 private static extern void THSNN_Module_train(HType module);
 
@@ -383,6 +430,83 @@ namespace TorchSharp
                 }
 
 
+                [DllImport("LibTorchSharp")]
+                private static extern IntPtr THSNN_Module_parameter_table(HType module);
+
+                /// <summary>
+                /// A cached table of the module's named parameters, buffers and sub-modules, for code that enumerates them
+                /// in every step. The table is created on first use and is rebuilt only when the module structure changes.
+                /// </summary>
+                public ParameterTable parameter_table()
+                {
+                    if (_parameterTable == null) {
+                        var res = THSNN_Module_parameter_table(handle);
+                        if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+                        _parameterTable = new ParameterTable(res);
+                    }
+                    return _parameterTable;
+                }
+
+                private ParameterTable _parameterTable;
+
+                [DllImport("LibTorchSharp")]
+                private static extern IntPtr THSNN_Module_weight_average(HType module, double decay, bool warmup, bool include_buffers);
+
+                /// <summary>
+                /// Start an exponential moving average of the module's floating-point weights, initialized to their current values.
+                /// </summary>
+                /// <param name="decay">The weight of the old average in each update.</param>
+                /// <param name="warmup">If true, update n uses min(decay, (1 + n) / (10 + n)), so that early updates move the average faster.</param>
+                /// <param name="include_buffers">If true, floating-point buffers such as batch norm running statistics are averaged too.</param>
+                public WeightAverage weight_average(double decay = 0.999, bool warmup = false, bool include_buffers = true)
+                {
+                    var res = THSNN_Module_weight_average(handle, decay, warmup, include_buffers);
+                    if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+                    return new WeightAverage(res);
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSNN_Module_profile_cost(HType module, IntPtr shape, int length, sbyte dtype, AllocatePinnedArray allocator1, AllocatePinnedArray allocator2);
+
+                /// <summary>
+                /// Estimate the cost of a forward pass for an input of the given shape, without running it.
+                /// Sequential modules are walked layer by layer; Linear, convolution, pooling, normalization, recurrent,
+                /// attention, embedding and activation layers are estimated in closed form.
+                /// </summary>
+                /// <param name="input_shape">The shape of the input, including the batch dimension.</param>
+                /// <param name="dtype">The element type of the activations.</param>
+                /// <remarks>
+                /// Layers without a closed form, such as custom modules, are run once on zeros to learn their output shape,
+                /// and report unknown FLOPs. A MultiheadAttention layer is estimated as self-attention.
+                /// </remarks>
+                public IList<LayerCost> profile_cost(long[] input_shape, ScalarType dtype = ScalarType.Float32)
+                {
+                    long[] numbers;
+                    IntPtr[] strings;
+
+                    using (var pa = new PinnedArray<long>())
+                    using (var sa = new PinnedArray<IntPtr>()) {
+                        unsafe {
+                            fixed (long* pShape = input_shape) {
+                                THSNN_Module_profile_cost(handle, (IntPtr)pShape, input_shape.Length, (sbyte)dtype, pa.CreateArray, sa.CreateArray);
+                            }
+                        }
+                        torch.CheckForErrors();
+                        numbers = pa.Array;
+                        strings = sa.Array;
+                    }
+
+                    var result = new List<LayerCost>(strings.Length / 2);
+                    for (var i = 0; i < strings.Length / 2; i++) {
+                        var flops = numbers[4 * i + 2];
+                        result.Add(new LayerCost(
+                            Marshal.PtrToStringAnsi(strings[2 * i]),
+                            Marshal.PtrToStringAnsi(strings[2 * i + 1]),
+                            numbers[4 * i], numbers[4 * i + 1], flops < 0 ? (long?)null : flops, numbers[4 * i + 3]));
+                    }
+                    return result;
+                }
+
                 [DllImport("LibTorchSharp")]
                 private static extern void THSNN_Module_get_parameters(HType module, AllocatePinnedArray allocator, bool recurse);
 
@@ -495,6 +619,15 @@ namespace TorchSharp
 
                 public virtual Tensor forward(Tensor x, Tensor y) => throw new NotImplementedException("forward(x,y)");
 
+                /// <summary>
+                /// Run several independent inputs through the module, returning one output per input.
+                /// </summary>
+                /// <remarks>
+                /// Custom modules created with ForwardTraits receive all the inputs in a single call from native code.
+                /// The default implementation calls forward() once per input.
+                /// </remarks>
+                public virtual Tensor[] forward_batch(Tensor[] inputs) => inputs.Select(t => forward(t)).ToArray();
+
                 /// <summary>
                 /// Save the parameters and buffers of the module to a disk location.
                 /// </summary>
@@ -585,6 +718,112 @@ namespace TorchSharp
                 }
 
 
+                [DllImport("LibTorchSharp")]
+                private static extern void THSNN_Module_load_state_dict_file(HType module, [MarshalAs(UnmanagedType.LPStr)] string location, bool strict, bool zero_copy);
+
+                /// <summary>
+                /// Load the parameters and buffers from a file written by save() or by exportsd.py.
+                /// The file is memory-mapped and parsed natively, so tensor data is not routed through managed arrays.
+                /// </summary>
+                /// <param name="location">The file path.</param>
+                /// <param name="strict">
+                /// If true, will only load a module if it exactly corresponds to the current module's state.
+                /// If false, will load the parameters and buffers that it finds in the saved file,
+                /// leaving everything else alone.
+                /// </param>
+                /// <param name="zero_copy">
+                /// If true, parameters and buffers are made to view the mapped file instead of being copied from it.
+                /// The mapping is private, so later updates to the module are never written back to the file.
+                /// </param>
+                /// <returns></returns>
+                public Module load_mapped(string location, bool strict = true, bool zero_copy = false)
+                {
+                    var dt = _deviceType;
+                    var di = _deviceIndex;
+
+                    cpu();
+
+                    try {
+                        THSNN_Module_load_state_dict_file(handle, location, strict, zero_copy);
+                        torch.CheckForErrors();
+                    }
+                    finally {
+                        to(dt, di);
+                    }
+
+                    return this;
+                }
+
+                /// <summary>
+                /// Move the parameters and buffers into a new named shared memory segment, so that other processes on the
+                /// host can share them with attach_shared_memory() instead of loading their own copies.
+                /// </summary>
+                /// <param name="name">The name of the segment. It must not exist already.</param>
+                /// <remarks>
+                /// The module must be on the CPU. Updates to the parameters, e.g. by an optimizer, are seen by every process
+                /// sharing them. Use Tensor.unlink_shared() to remove the name once all processes have attached.
+                /// </remarks>
+                public Module share_memory(string name)
+                {
+                    if (_deviceType != DeviceType.CPU)
+                        throw new InvalidOperationException("Only modules on the CPU can be moved to shared memory.");
+
+                    var state = state_dict();
+                    var shared = Tensor.save_shared(state, name);
+                    set_shared_state(state, shared);
+                    return this;
+                }
+
+                /// <summary>
+                /// Make the parameters and buffers view a shared memory segment created by share_memory(), possibly in another
+                /// process, instead of their own memory.
+                /// </summary>
+                /// <param name="name">The name of the segment.</param>
+                /// <param name="strict">
+                /// If true, the segment must hold exactly the module's parameters and buffers.
+                /// If false, only the parameters and buffers found in the segment are replaced.
+                /// </param>
+                public Module attach_shared_memory(string name, bool strict = true)
+                {
+                    if (_deviceType != DeviceType.CPU)
+                        throw new InvalidOperationException("Only modules on the CPU can attach to shared memory.");
+
+                    var state = state_dict();
+                    var shared = Tensor.load_shared(name);
+
+                    try {
+                        if (strict && shared.Count != state.Count)
+                            throw new ArgumentException($"Mismatched state sizes: expected {state.Count}, but found {shared.Count} entries in shared memory.");
+
+                        foreach (var entry in shared) {
+                            if (!state.TryGetValue(entry.Key, out var target)) {
+                                if (strict) throw new ArgumentException($"The module has no parameter or buffer named '{entry.Key}'.");
+                                continue;
+                            }
+                            if (target.dtype != entry.Value.dtype || !target.shape.SequenceEqual(entry.Value.shape))
+                                throw new ArgumentException($"Mismatched tensor shape or data type for '{entry.Key}'.");
+                        }
+
+                        set_shared_state(state, shared);
+                    } catch {
+                        foreach (var t in shared.Values) t.Dispose();
+                        throw;
+                    }
+                    return this;
+                }
+
+                private static void set_shared_state(Dictionary<string, Tensor> state, Dictionary<string, Tensor> shared)
+                {
+                    using (torch.no_grad()) {
+                        foreach (var entry in shared) {
+                            // The parameter takes over the shared storage, which lives as long as any tensor uses it.
+                            if (state.TryGetValue(entry.Key, out var target))
+                                target.set_(entry.Value).Dispose();
+                            entry.Value.Dispose();
+                        }
+                    }
+                }
+
                 /// <summary>
                 /// Create a module and load its weights from disk.
                 /// </summary>
@@ -630,6 +869,47 @@ namespace TorchSharp
                     this.boxedModule = new BoxedModule(boxedHandle);
                 }
 
+                private delegate void ForwardBatchFunctionC(IntPtr inputs, int length, IntPtr outputs);
+
+                [DllImport("LibTorchSharp")]
+                private static extern IntPtr THSNN_custom_module_batched([MarshalAs(UnmanagedType.LPStr)] string name,
+                    ForwardBatchFunctionC forward, int traits, out IntPtr pBoxedModule);
+
+                /// <summary>
+                /// Constructor for custom modules whose forward is invoked from native code with a whole batch of inputs at a time.
+                /// Override forward_batch() to process the batch; the traits let native code concatenate inputs into a single call.
+                /// </summary>
+                /// <param name="name">The name of the module. Useful for debugging purposes, mostly.</param>
+                /// <param name="traits">What the module promises about its forward function.</param>
+                protected Module(string name, ForwardTraits traits) : this(IntPtr.Zero, IntPtr.Zero)
+                {
+                    this.name = name;
+
+                    ForwardBatchFunctionC forwardBatchNative = (pInputs, length, pOutputs) => {
+                        var inputs = new Tensor[length];
+                        for (int i = 0; i < length; i++)
+                            inputs[i] = new Tensor(Marshal.ReadIntPtr(pInputs, i * IntPtr.Size));
+
+                        var outputs = forward_batch(inputs);
+
+                        for (int i = 0; i < length && i < outputs.Length; i++) {
+                            // An output that is one of the inputs needs a handle of its own, since the caller owns the inputs.
+                            var output = Array.Exists(inputs, t => ReferenceEquals(t, outputs[i])) ? outputs[i].alias() : outputs[i];
+                            Marshal.WriteIntPtr(pOutputs, i * IntPtr.Size, output.DecoupleFromNativeHandle());
+                        }
+
+                        // The input handles must live on - we don't own them, but the managed objects should go away.
+                        foreach (var input in inputs)
+                            input.DecoupleFromNativeHandle();
+                    };
+
+                    var res = THSNN_custom_module_batched(name, forwardBatchNative, (int)traits, out var boxedHandle);
+                    torch.CheckForErrors();
+                    this.handle = new HType(res, true);
+                    this.forwardBatchNative = forwardBatchNative;
+                    this.boxedModule = new BoxedModule(boxedHandle);
+                }
+
                 protected virtual void RegisterComponents()
                 {
                     if (_registered) return;
@@ -656,9 +936,28 @@ namespace TorchSharp
 
                 /// Keeps the callback delegate alive
                 private ForwardFunctionC forwardNative;
+                private ForwardBatchFunctionC forwardBatchNative;
                 protected string name;
             }
 
+            /// <summary>
+            /// Properties of a custom module's forward function that native code may exploit to process
+            /// several inputs with a single call into .NET.
+            /// </summary>
+            [Flags]
+            public enum ForwardTraits
+            {
+                None = 0,
+                /// <summary>
+                /// Each output element depends only on the corresponding input element, so inputs of any shape may be flattened and concatenated.
+                /// </summary>
+                Elementwise = 1,
+                /// <summary>
+                /// Samples along the first dimension are processed independently, so inputs may be concatenated along it.
+                /// </summary>
+                BatchAgnostic = 2
+            }
+
             internal class BoxedModule : IDisposable
             {
                 internal sealed class HType : SafeHandle
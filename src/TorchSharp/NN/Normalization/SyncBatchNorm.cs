@@ -0,0 +1,80 @@
+// Copyright (c) .NET Foundation and Contributors.  All Rights Reserved.  See LICENSE in the project root for license information.
+using System;
+using System.Linq;
+using System.Runtime.InteropServices;
+using static TorchSharp.torch;
+
+#nullable enable
+namespace TorchSharp
+{
+    using Modules;
+
+    namespace Modules
+    {
+        /// <summary>
+        /// This class is used to represent a SyncBatchNorm module.
+        /// </summary>
+        public class SyncBatchNorm : torch.nn.Module
+        {
+            internal SyncBatchNorm(IntPtr handle, IntPtr boxedHandle) : base(handle, boxedHandle)
+            {
+            }
+
+            [DllImport("LibTorchSharp")]
+            private static extern IntPtr THSNN_SyncBatchNorm_forward(IntPtr module, IntPtr tensor);
+
+            public override Tensor forward(Tensor tensor)
+            {
+                if (tensor.Dimensions < 2) throw new ArgumentException($"Invalid number of dimensions for SyncBatchNorm argument: {tensor.Dimensions}");
+                var res = THSNN_SyncBatchNorm_forward(handle.DangerousGetHandle(), tensor.Handle);
+                if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+                return new Tensor(res);
+            }
+
+            [DllImport("LibTorchSharp")]
+            private static extern void THSNN_SyncBatchNorm_reset_stats(torch.nn.Module.HType module);
+
+            public Tensor? weight => get_parameter("weight");
+
+            public Tensor? bias => get_parameter("bias");
+
+            public Tensor? running_mean => named_buffers().Where(b => b.name == "running_mean").Select(b => b.parameter).FirstOrDefault();
+
+            public Tensor? running_var => named_buffers().Where(b => b.name == "running_var").Select(b => b.parameter).FirstOrDefault();
+
+            public void reset_running_stats()
+            {
+                THSNN_SyncBatchNorm_reset_stats(handle);
+                torch.CheckForErrors();
+            }
+        }
+    }
+
+    public static partial class torch
+    {
+        public static partial class nn
+        {
+            [DllImport("LibTorchSharp")]
+            extern static IntPtr THSNN_SyncBatchNorm_ctor(long features, double eps, double momentum, bool affine, bool track_running_stats, distributed.ProcessGroup.HType group, out IntPtr pBoxedModule);
+
+            /// <summary>
+            /// Applies Batch Normalization over an input of shape (N, C, ...), computing the batch statistics over the batches of all the
+            /// ranks of a process group, as if they were one large batch. Every rank must run forward, and backward, in step with the others.
+            /// </summary>
+            /// <param name="features">C from an expected input of size (N, C, ...)</param>
+            /// <param name="group">The process group whose ranks share batch statistics.</param>
+            /// <param name="eps">A value added to the denominator for numerical stability. Default: 1e-5</param>
+            /// <param name="momentum">The value used for the running_mean and running_var computation. Default: 0.1</param>
+            /// <param name="affine">A boolean value that when set to True, this module has learnable affine parameters. Default: true</param>
+            /// <param name="track_running_stats">A boolean value that when set to True, this module tracks the running mean and variance, and when set to False,
+            /// this module always uses batch statistics, in both training and eval modes. Default: true</param>
+            /// <returns></returns>
+            static public SyncBatchNorm SyncBatchNorm(long features, distributed.ProcessGroup group, double eps = 1e-05, double momentum = 0.1, bool affine = true, bool track_running_stats = true)
+            {
+                var handle = THSNN_SyncBatchNorm_ctor(features, eps, momentum, affine, track_running_stats, group.handle, out var boxedHandle);
+                if (handle == IntPtr.Zero) { torch.CheckForErrors(); }
+                return new SyncBatchNorm(handle, boxedHandle);
+            }
+        }
+    }
+}
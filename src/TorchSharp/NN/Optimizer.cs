@@ -113,6 +113,36 @@ namespace TorchSharp
                     return (res == IntPtr.Zero) ? null : new Tensor(res);
                 }
 
+                [DllImport("LibTorchSharp")]
+                private static extern void THSNN_Optimizer_save(HType optimizer, [MarshalAs(UnmanagedType.LPStr)] string location);
+
+                /// <summary>
+                /// Save the optimizer state, e.g. running averages and step counts, to a file.
+                /// </summary>
+                /// <param name="location">The file path.</param>
+                public void save(string location)
+                {
+                    if (handle == null)
+                        throw new NotSupportedException("Only native optimizers can be saved.");
+                    THSNN_Optimizer_save(handle, location);
+                    torch.CheckForErrors();
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSNN_Optimizer_load(HType optimizer, [MarshalAs(UnmanagedType.LPStr)] string location);
+
+                /// <summary>
+                /// Restore optimizer state saved by save() or by Module.save_async().
+                /// </summary>
+                /// <param name="location">The file path.</param>
+                public void load(string location)
+                {
+                    if (handle == null)
+                        throw new NotSupportedException("Only native optimizers can be loaded.");
+                    THSNN_Optimizer_load(handle, location);
+                    torch.CheckForErrors();
+                }
+
                 [DllImport("LibTorchSharp")]
                 private static extern void THSNN_Optimizer_getParameters(HType module, AllocatePinnedArray allocator);
 
@@ -127,6 +157,32 @@ namespace TorchSharp
                     }
                     return ptrArray.Select(x => new Tensor(x));
                 }
+
+                [DllImport("LibTorchSharp")]
+                private static extern double THSNN_train_step(torch.nn.Module.HType module, IntPtr boxed, IntPtr input, IntPtr target, long loss_kind, HType optimizer, double max_norm, long accumulation_steps);
+
+                /// <summary>
+                /// Run one training iteration in a single native call: zero the gradients, run the module forward, compute the loss,
+                /// back-propagate, optionally clip the gradient norm, and step the optimizer. No intermediate tensors are returned.
+                /// </summary>
+                /// <param name="module">The module to train. Sequential, custom and built-in modules are supported.</param>
+                /// <param name="input">The input batch.</param>
+                /// <param name="target">The target batch.</param>
+                /// <param name="loss">The loss to minimize.</param>
+                /// <param name="max_grad_norm">If given, the total 2-norm the gradients of the optimized parameters are clipped to before the step.</param>
+                /// <param name="accumulation_steps">The number of micro-batches the batch is split into along dimension 0. Gradients are accumulated
+                /// over them, so only one micro-batch of activations is alive at a time, and the optimizer steps once.</param>
+                /// <returns>The loss over the whole batch, before the step.</returns>
+                public double train_step(torch.nn.Module module, Tensor input, Tensor target, torch.nn.LossKind loss, double? max_grad_norm = null, long accumulation_steps = 1)
+                {
+                    if (handle == null)
+                        throw new NotSupportedException("Only native optimizers support native training steps.");
+                    var boxed = module.boxedModule?.handle.DangerousGetHandle() ?? IntPtr.Zero;
+                    var res = THSNN_train_step(module.handle, boxed, input.Handle, target.Handle, (long)loss, handle, max_grad_norm ?? 0.0, accumulation_steps);
+                    torch.CheckForErrors();
+                    GC.KeepAlive(module);
+                    return res;
+                }
             }
 
             public interface ILearningRateController
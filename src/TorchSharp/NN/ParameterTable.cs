@@ -0,0 +1,136 @@
+// Copyright (c) .NET Foundation and Contributors.  All Rights Reserved.  See LICENSE in the project root for license information.
+using System;
+using System.Linq;
+using System.Runtime.InteropServices;
+
+namespace TorchSharp
+{
+    public static partial class torch
+    {
+        public static partial class nn
+        {
+            /// <summary>
+            /// A cached enumeration of a module's named parameters, buffers and sub-modules.
+            /// The table is rebuilt only after modules, parameters or buffers have been registered, so enumerating it
+            /// in every training step costs a single native call and no allocations.
+            /// </summary>
+            /// <remarks>
+            /// The tensors and modules handed out are owned by the table and shared between calls; do not dispose them.
+            /// </remarks>
+            public sealed class ParameterTable : IDisposable
+            {
+                internal sealed class HType : SafeHandle
+                {
+                    public HType(IntPtr preexistingHandle, bool ownsHandle) : base(IntPtr.Zero, ownsHandle)
+                    {
+                        SetHandle(preexistingHandle);
+                    }
+
+                    public override bool IsInvalid => handle == IntPtr.Zero;
+
+                    [DllImport("LibTorchSharp")]
+                    private static extern void THSNN_ParameterTable_dispose(HType handle);
+
+                    protected override bool ReleaseHandle()
+                    {
+                        if (!IsInvalid) THSNN_ParameterTable_dispose(this);
+                        SetHandle(IntPtr.Zero);
+                        return true;
+                    }
+
+                    protected override void Dispose(bool disposing)
+                    {
+                        if (disposing) {
+                            ReleaseHandle();
+                        }
+                    }
+                }
+
+                internal HType handle;
+
+                internal ParameterTable(IntPtr handle)
+                {
+                    this.handle = new HType(handle, true);
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern bool THSNN_ParameterTable_refresh(HType table);
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSNN_ParameterTable_get_parameters(HType table, AllocatePinnedArray allocator1, AllocatePinnedArray allocator2);
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSNN_ParameterTable_get_buffers(HType table, AllocatePinnedArray allocator1, AllocatePinnedArray allocator2);
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSNN_ParameterTable_get_modules(HType table, AllocatePinnedArray allocator1, AllocatePinnedArray allocator2);
+
+                private void Refresh()
+                {
+                    var stale = THSNN_ParameterTable_refresh(handle);
+                    torch.CheckForErrors();
+                    if (!stale && _parameters != null) return;
+
+                    _parameters = Fetch(THSNN_ParameterTable_get_parameters, (name, h) => (name, new Modules.Parameter(h)));
+                    _buffers = Fetch(THSNN_ParameterTable_get_buffers, (name, h) => (name, new Tensor(h)));
+                    _modules = Fetch(THSNN_ParameterTable_get_modules, (name, h) => (name, new Module(h, IntPtr.Zero)));
+                }
+
+                private T[] Fetch<T>(Action<HType, AllocatePinnedArray, AllocatePinnedArray> get, Func<string, IntPtr, T> wrap)
+                {
+                    IntPtr[] ptrArray;
+                    IntPtr[] strArray;
+
+                    using (var pa = new PinnedArray<IntPtr>())
+                    using (var sa = new PinnedArray<IntPtr>()) {
+                        get(handle, pa.CreateArray, sa.CreateArray);
+                        torch.CheckForErrors();
+                        ptrArray = pa.Array;
+                        strArray = sa.Array;
+                    }
+                    return ptrArray.Select((x, i) => wrap(Marshal.PtrToStringAnsi(strArray[i]), x)).ToArray();
+                }
+
+                /// <summary>
+                /// The named parameters of the module and all its sub-modules.
+                /// </summary>
+                public (string name, Modules.Parameter parameter)[] named_parameters()
+                {
+                    Refresh();
+                    return _parameters;
+                }
+
+                /// <summary>
+                /// The named buffers of the module and all its sub-modules.
+                /// </summary>
+                public (string name, Tensor buffer)[] named_buffers()
+                {
+                    Refresh();
+                    return _buffers;
+                }
+
+                /// <summary>
+                /// The module itself and all its sub-modules, by name.
+                /// </summary>
+                public (string name, Module module)[] named_modules()
+                {
+                    Refresh();
+                    return _modules;
+                }
+
+                /// <summary>
+                ///   Releases the table.
+                /// </summary>
+                public void Dispose()
+                {
+                    handle.Dispose();
+                    handle.SetHandleAsInvalid();
+                }
+
+                private (string name, Modules.Parameter parameter)[] _parameters;
+                private (string name, Tensor buffer)[] _buffers;
+                private (string name, Module module)[] _modules;
+            }
+        }
+    }
+}
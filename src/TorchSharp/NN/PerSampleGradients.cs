@@ -0,0 +1,112 @@
+// Copyright (c) .NET Foundation and Contributors.  All Rights Reserved.  See LICENSE in the project root for license information.
+using System;
+using System.Collections.Generic;
+using System.Linq;
+using System.Runtime.InteropServices;
+
+namespace TorchSharp
+{
+    public static partial class torch
+    {
+        public static partial class nn
+        {
+            /// <summary>
+            /// The record of a forward pass through a Sequential, from which per-sample gradients of a loss can be computed
+            /// with a single backward pass, as needed for differentially private training.
+            /// </summary>
+            /// <remarks>
+            /// The batch must be along dimension 0, and the loss must be a sum of per-sample losses, i.e. use reduction 'sum'.
+            /// Layers with trainable parameters must be Linear, Conv1d, Conv2d, Embedding or LayerNorm.
+            /// </remarks>
+            public sealed class PerSampleGradients : IDisposable
+            {
+                internal sealed class HType : SafeHandle
+                {
+                    public HType(IntPtr preexistingHandle, bool ownsHandle) : base(IntPtr.Zero, ownsHandle)
+                    {
+                        SetHandle(preexistingHandle);
+                    }
+
+                    public override bool IsInvalid => handle == IntPtr.Zero;
+
+                    [DllImport("LibTorchSharp")]
+                    private static extern void THSNN_PerSampleTrace_dispose(HType handle);
+
+                    protected override bool ReleaseHandle()
+                    {
+                        if (!IsInvalid) THSNN_PerSampleTrace_dispose(this);
+                        SetHandle(IntPtr.Zero);
+                        return true;
+                    }
+
+                    protected override void Dispose(bool disposing)
+                    {
+                        if (disposing) {
+                            ReleaseHandle();
+                        }
+                    }
+                }
+
+                internal HType handle;
+
+                internal PerSampleGradients(IntPtr handle, Tensor output)
+                {
+                    this.handle = new HType(handle, true);
+                    this.output = output;
+                }
+
+                /// <summary>
+                /// The output of the forward pass.
+                /// </summary>
+                public Tensor output { get; }
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSNN_PerSampleTrace_grads(HType trace, IntPtr loss, AllocatePinnedArray allocator);
+
+                /// <summary>
+                /// Computes the gradient of the loss for every sample separately.
+                /// </summary>
+                /// <param name="loss">A scalar loss computed from the output, summed over the batch.</param>
+                /// <returns>For each trainable parameter of the traced layers, in order, its per-sample gradients stacked along dimension 0.
+                /// Embedding gradients are sparse, and not coalesced.</returns>
+                public IList<Tensor> grads(Tensor loss)
+                {
+                    IntPtr[] ptrArray;
+
+                    using (var pa = new PinnedArray<IntPtr>()) {
+                        THSNN_PerSampleTrace_grads(handle, loss.Handle, pa.CreateArray);
+                        torch.CheckForErrors();
+                        ptrArray = pa.Array;
+                    }
+                    return ptrArray.Select(x => new Tensor(x)).ToList();
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern IntPtr THSNN_PerSampleTrace_clip_and_accumulate(HType trace, IntPtr loss, double max_norm);
+
+                /// <summary>
+                /// Computes the per-sample gradients of the loss, scales each sample's gradient down to at most max_norm,
+                /// and adds the sum of the clipped gradients to the grad of the parameters.
+                /// </summary>
+                /// <param name="loss">A scalar loss computed from the output, summed over the batch.</param>
+                /// <param name="max_norm">The largest norm, over all parameters, allowed for one sample's gradient.</param>
+                /// <returns>The norms of the per-sample gradients before clipping.</returns>
+                public Tensor clip_and_accumulate(Tensor loss, double max_norm)
+                {
+                    var res = THSNN_PerSampleTrace_clip_and_accumulate(handle, loss.Handle, max_norm);
+                    if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+                    return new Tensor(res);
+                }
+
+                /// <summary>
+                ///   Releases the recorded activations.
+                /// </summary>
+                public void Dispose()
+                {
+                    handle.Dispose();
+                    handle.SetHandleAsInvalid();
+                }
+            }
+        }
+    }
+}
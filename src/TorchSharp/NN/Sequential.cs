@@ -76,6 +76,96 @@ namespace TorchSharp
                 return result;
             }
 
+            [DllImport("LibTorchSharp")]
+            private static extern void THSNN_Sequential_forward_batch(torch.nn.Module.HType module, IntPtr inputs, int length, IntPtr outputs);
+
+            /// <summary>
+            /// Run several independent inputs through the sequence, one stage at a time.
+            /// Custom modules created with ForwardTraits are called once per stage rather than once per input.
+            /// </summary>
+            public override Tensor[] forward_batch(Tensor[] inputs)
+            {
+                var inputHandles = inputs.Select(t => t.Handle).ToArray();
+                var outputHandles = new IntPtr[inputs.Length];
+                unsafe {
+                    fixed (IntPtr* pInputs = inputHandles, pOutputs = outputHandles) {
+                        THSNN_Sequential_forward_batch(handle, (IntPtr)pInputs, inputs.Length, (IntPtr)pOutputs);
+                        torch.CheckForErrors();
+                    }
+                }
+                GC.KeepAlive(inputs);
+                return outputHandles.Select(h => new Tensor(h)).ToArray();
+            }
+
+            [DllImport("LibTorchSharp")]
+            private static extern IntPtr THSNN_Sequential_plan(torch.nn.Module.HType module, IntPtr example);
+
+            /// <summary>
+            /// Prepare the sequence for inference on inputs shaped like the example, reusing two activation buffers
+            /// for all layers. The example is run through the sequence once, to learn the shape of each activation.
+            /// </summary>
+            /// <param name="example">An input with the shape, dtype and device that the plan will be used with.</param>
+            public torch.nn.SequentialPlan plan(Tensor example)
+            {
+                var res = THSNN_Sequential_plan(handle, example.Handle);
+                if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+                return new torch.nn.SequentialPlan(res);
+            }
+
+            [DllImport("LibTorchSharp")]
+            private static extern IntPtr THSNN_Sequential_per_sample_forward(torch.nn.Module.HType module, IntPtr input, out IntPtr output);
+
+            /// <summary>
+            /// Run the input through the sequence natively, recording what is needed to compute per-sample gradients
+            /// of a loss with a single backward pass.
+            /// </summary>
+            /// <param name="input">A batch of samples, along dimension 0.</param>
+            public torch.nn.PerSampleGradients per_sample_forward(Tensor input)
+            {
+                var res = THSNN_Sequential_per_sample_forward(handle, input.Handle, out var output);
+                if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+                return new torch.nn.PerSampleGradients(res, new Tensor(output));
+            }
+
+            [DllImport("LibTorchSharp")]
+            private static extern IntPtr THSNN_Sequential_pipeline(torch.nn.Module.HType module, IntPtr boundaries, int boundaries_length, int stages, IntPtr nodes, int nodes_length, int capacity);
+
+            private torch.nn.SequentialPipeline pipeline(long[] boundaries, int stages, int[] numa_nodes, int queue_capacity)
+            {
+                IntPtr res;
+                unsafe {
+                    fixed (long* pBoundaries = boundaries)
+                    fixed (int* pNodes = numa_nodes) {
+                        res = THSNN_Sequential_pipeline(handle, (IntPtr)pBoundaries, boundaries == null ? 0 : boundaries.Length, stages,
+                            (IntPtr)pNodes, numa_nodes == null ? 0 : numa_nodes.Length, queue_capacity);
+                    }
+                }
+                if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+                return new torch.nn.SequentialPipeline(res, this);
+            }
+
+            /// <summary>
+            /// Split the sequence into stages with roughly equal numbers of parameters, for pipeline-parallel execution.
+            /// </summary>
+            /// <param name="stages">The number of stages, each run by its own thread.</param>
+            /// <param name="numa_nodes">The NUMA node to pin each stage to, cycling through the list; null to leave stages unpinned.</param>
+            /// <param name="queue_capacity">The number of micro-batches that may wait at the entrance of each stage.</param>
+            public torch.nn.SequentialPipeline pipeline(int stages, int[] numa_nodes = null, int queue_capacity = 2)
+            {
+                return pipeline(null, stages, numa_nodes, queue_capacity);
+            }
+
+            /// <summary>
+            /// Split the sequence into stages at the given layers, for pipeline-parallel execution.
+            /// </summary>
+            /// <param name="boundaries">The index of the first layer of every stage but the first, in increasing order.</param>
+            /// <param name="numa_nodes">The NUMA node to pin each stage to, cycling through the list; null to leave stages unpinned.</param>
+            /// <param name="queue_capacity">The number of micro-batches that may wait at the entrance of each stage.</param>
+            public torch.nn.SequentialPipeline pipeline(long[] boundaries, int[] numa_nodes = null, int queue_capacity = 2)
+            {
+                return pipeline(boundaries, boundaries.Length + 1, numa_nodes, queue_capacity);
+            }
+
             public override nn.Module apply(Action<nn.Module> fn)
             {
                 // More efficient than asking C++ for the children. We already have the list, after all.
@@ -0,0 +1,177 @@
+// Copyright (c) .NET Foundation and Contributors.  All Rights Reserved.  See LICENSE in the project root for license information.
+using System;
+using System.Linq;
+using System.Runtime.InteropServices;
+
+namespace TorchSharp
+{
+    public static partial class torch
+    {
+        public static partial class nn
+        {
+            /// <summary>
+            /// A Sequential split into consecutive stages that run concurrently on their own native threads, with
+            /// micro-batches streaming from stage to stage over bounded queues. A stage may be pinned to a NUMA node,
+            /// in which case its worker thread runs on that node's processors and its parameters are moved to its memory.
+            /// </summary>
+            /// <remarks>
+            /// Training follows the GPipe schedule: forward_train() runs the forward pass of every micro-batch, and
+            /// backward() the backward pass of every micro-batch, each pipelined through the stages.
+            /// The module's parameters are shared with the pipeline, so optimizers created for the module keep working.
+            /// </remarks>
+            public sealed class SequentialPipeline : IDisposable
+            {
+                internal sealed class HType : SafeHandle
+                {
+                    public HType(IntPtr preexistingHandle, bool ownsHandle) : base(IntPtr.Zero, ownsHandle)
+                    {
+                        SetHandle(preexistingHandle);
+                    }
+
+                    public override bool IsInvalid => handle == IntPtr.Zero;
+
+                    [DllImport("LibTorchSharp")]
+                    private static extern void THSNN_Pipeline_dispose(HType handle);
+
+                    protected override bool ReleaseHandle()
+                    {
+                        if (!IsInvalid) THSNN_Pipeline_dispose(this);
+                        SetHandle(IntPtr.Zero);
+                        return true;
+                    }
+
+                    protected override void Dispose(bool disposing)
+                    {
+                        if (disposing) {
+                            ReleaseHandle();
+                        }
+                    }
+                }
+
+                internal HType handle;
+
+                // Custom modules in the sequence call back into .NET from the stage threads, so they must stay alive.
+                private readonly Modules.Sequential sequential;
+
+                internal SequentialPipeline(IntPtr handle, Modules.Sequential sequential)
+                {
+                    this.handle = new HType(handle, true);
+                    this.sequential = sequential;
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSNN_Pipeline_forward(HType pipeline, IntPtr input, long micro_batches, bool train, AllocatePinnedArray allocator);
+
+                private Tensor[] forward(Tensor input, int micro_batches, bool train)
+                {
+                    IntPtr[] ptrArray;
+
+                    using (var pa = new PinnedArray<IntPtr>()) {
+                        THSNN_Pipeline_forward(handle, input.Handle, micro_batches, train, pa.CreateArray);
+                        torch.CheckForErrors();
+                        ptrArray = pa.Array;
+                    }
+                    return ptrArray.Select(x => new Tensor(x)).ToArray();
+                }
+
+                /// <summary>
+                /// Run the input through the pipeline without tracking gradients.
+                /// </summary>
+                /// <param name="input">The input, with samples along dimension 0.</param>
+                /// <param name="micro_batches">The number of micro-batches to split the input into.</param>
+                public Tensor forward(Tensor input, int micro_batches)
+                {
+                    var outputs = forward(input, micro_batches, false);
+                    if (outputs.Length == 1) return outputs[0];
+
+                    var result = torch.cat(outputs, 0);
+                    foreach (var t in outputs) t.Dispose();
+                    return result;
+                }
+
+                /// <summary>
+                /// Run the input through the pipeline for training, keeping each stage's activations for backward().
+                /// </summary>
+                /// <param name="input">The input, with samples along dimension 0.</param>
+                /// <param name="micro_batches">The number of micro-batches to split the input into.</param>
+                /// <returns>The output of each micro-batch.</returns>
+                public Tensor[] forward_train(Tensor input, int micro_batches) => forward(input, micro_batches, true);
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSNN_Pipeline_backward(HType pipeline, IntPtr losses, int length);
+
+                /// <summary>
+                /// Back-propagate the loss of each micro-batch returned by the preceding forward_train(), accumulating the gradients
+                /// of the parameters. Each loss must depend only on the output of its own micro-batch.
+                /// </summary>
+                public void backward(params Tensor[] losses)
+                {
+                    var handles = losses.Select(t => t.Handle).ToArray();
+                    unsafe {
+                        fixed (IntPtr* pLosses = handles) {
+                            THSNN_Pipeline_backward(handle, (IntPtr)pLosses, handles.Length);
+                        }
+                    }
+                    torch.CheckForErrors();
+                    GC.KeepAlive(losses);
+                }
+
+                /// <summary>
+                /// Run the forward and backward passes of one training step, accumulating the gradients of the batch-mean loss.
+                /// </summary>
+                /// <param name="input">The input, with samples along dimension 0.</param>
+                /// <param name="target">The target, with samples along dimension 0.</param>
+                /// <param name="loss_fn">A loss function returning the mean loss of a micro-batch.</param>
+                /// <param name="micro_batches">The number of micro-batches to split the input into.</param>
+                /// <returns>The mean loss of the batch.</returns>
+                public Tensor train_step(Tensor input, Tensor target, Func<Tensor, Tensor, Tensor> loss_fn, int micro_batches)
+                {
+                    var outputs = forward_train(input, micro_batches);
+                    var targets = target.chunk(micro_batches, 0);
+                    var batch = (double)input.shape[0];
+
+                    // Weigh each micro-batch's mean loss by its size, so that the gradients are those of the batch mean.
+                    var losses = outputs.Select((o, i) => loss_fn(o, targets[i]) * (o.shape[0] / batch)).ToArray();
+                    backward(losses);
+
+                    using (var _ = torch.no_grad()) {
+                        var total = torch.stack(losses).sum();
+                        foreach (var t in outputs.Concat(targets).Concat(losses)) t.Dispose();
+                        return total;
+                    }
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSNN_Pipeline_stages(HType pipeline, AllocatePinnedArray allocator);
+
+                private long[] stages()
+                {
+                    using (var pa = new PinnedArray<long>()) {
+                        THSNN_Pipeline_stages(handle, pa.CreateArray);
+                        torch.CheckForErrors();
+                        return pa.Array;
+                    }
+                }
+
+                /// <summary>
+                /// The number of layers in each stage.
+                /// </summary>
+                public long[] stage_sizes => stages().Where((x, i) => i % 2 == 0).ToArray();
+
+                /// <summary>
+                /// The NUMA node each stage is pinned to, or -1 if it is not pinned.
+                /// </summary>
+                public long[] stage_nodes => stages().Where((x, i) => i % 2 == 1).ToArray();
+
+                /// <summary>
+                ///   Stops the stage threads and releases the pipeline.
+                /// </summary>
+                public void Dispose()
+                {
+                    handle.Dispose();
+                    handle.SetHandleAsInvalid();
+                }
+            }
+        }
+    }
+}
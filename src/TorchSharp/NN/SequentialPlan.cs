@@ -0,0 +1,95 @@
+// Copyright (c) .NET Foundation and Contributors.  All Rights Reserved.  See LICENSE in the project root for license information.
+using System;
+using System.Runtime.InteropServices;
+
+namespace TorchSharp
+{
+    public static partial class torch
+    {
+        public static partial class nn
+        {
+            /// <summary>
+            /// A Sequential prepared for inference on inputs of one fixed shape, dtype and device.
+            /// The activations of all layers are placed in two preallocated buffers, so a planned forward
+            /// pass of Linear and activation layers performs no allocations.
+            /// </summary>
+            /// <remarks>
+            /// The tensor returned by forward() shares storage with the plan, and is overwritten by the next call.
+            /// Layers that the plan cannot write into its buffers still run their own forward(), allocating as usual.
+            /// </remarks>
+            public sealed class SequentialPlan : IDisposable
+            {
+                internal sealed class HType : SafeHandle
+                {
+                    public HType(IntPtr preexistingHandle, bool ownsHandle) : base(IntPtr.Zero, ownsHandle)
+                    {
+                        SetHandle(preexistingHandle);
+                    }
+
+                    public override bool IsInvalid => handle == IntPtr.Zero;
+
+                    [DllImport("LibTorchSharp")]
+                    private static extern void THSNN_SequentialPlan_dispose(HType handle);
+
+                    protected override bool ReleaseHandle()
+                    {
+                        if (!IsInvalid) THSNN_SequentialPlan_dispose(this);
+                        SetHandle(IntPtr.Zero);
+                        return true;
+                    }
+
+                    protected override void Dispose(bool disposing)
+                    {
+                        if (disposing) {
+                            ReleaseHandle();
+                        }
+                    }
+                }
+
+                internal HType handle;
+
+                internal SequentialPlan(IntPtr handle)
+                {
+                    this.handle = new HType(handle, true);
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern IntPtr THSNN_SequentialPlan_forward(HType plan, IntPtr input);
+
+                /// <summary>
+                /// Run the input through the sequence, without tracking gradients.
+                /// </summary>
+                /// <param name="input">A tensor with the same shape, dtype and device as the example the plan was made from.</param>
+                public Tensor forward(Tensor input)
+                {
+                    var res = THSNN_SequentialPlan_forward(handle, input.Handle);
+                    if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+                    return new Tensor(res);
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern long THSNN_SequentialPlan_workspace_bytes(HType plan);
+
+                /// <summary>
+                /// The number of bytes held by the plan's activation buffers.
+                /// </summary>
+                public long workspace_bytes {
+                    get {
+                        var res = THSNN_SequentialPlan_workspace_bytes(handle);
+                        torch.CheckForErrors();
+                        return res;
+                    }
+                }
+
+                /// <summary>
+                ///   Releases the plan and its buffers.
+                /// </summary>
+                public void Dispose()
+                {
+                    handle.Dispose();
+                    handle.SetHandleAsInvalid();
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,161 @@
+// Copyright (c) .NET Foundation and Contributors.  All Rights Reserved.  See LICENSE in the project root for license information.
+using System;
+using System.Linq;
+using System.Runtime.InteropServices;
+
+namespace TorchSharp
+{
+    public static partial class torch
+    {
+        public static partial class nn
+        {
+            /// <summary>
+            /// An exponential moving average of a module's weights, kept natively and updated with one call per step.
+            /// Created by Module.weight_average().
+            /// </summary>
+            /// <remarks>
+            /// Each update computes average = decay * average + (1 - decay) * weight for all floating-point weights in a single
+            /// multi-threaded pass. swap() exchanges the module's weights with the averages without copying, e.g. for evaluation.
+            /// </remarks>
+            public sealed class WeightAverage : IDisposable
+            {
+                internal sealed class HType : SafeHandle
+                {
+                    public HType(IntPtr preexistingHandle, bool ownsHandle) : base(IntPtr.Zero, ownsHandle)
+                    {
+                        SetHandle(preexistingHandle);
+                    }
+
+                    public override bool IsInvalid => handle == IntPtr.Zero;
+
+                    [DllImport("LibTorchSharp")]
+                    private static extern void THSNN_WeightAverage_dispose(HType handle);
+
+                    protected override bool ReleaseHandle()
+                    {
+                        if (!IsInvalid) THSNN_WeightAverage_dispose(this);
+                        SetHandle(IntPtr.Zero);
+                        return true;
+                    }
+
+                    protected override void Dispose(bool disposing)
+                    {
+                        if (disposing) {
+                            ReleaseHandle();
+                        }
+                    }
+                }
+
+                internal HType handle;
+
+                internal WeightAverage(IntPtr handle)
+                {
+                    this.handle = new HType(handle, true);
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSNN_WeightAverage_update(HType average);
+
+                /// <summary>
+                /// Fold the module's current weights into the average. Call after each optimizer step.
+                /// </summary>
+                public void update()
+                {
+                    THSNN_WeightAverage_update(handle);
+                    torch.CheckForErrors();
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSNN_WeightAverage_swap(HType average);
+
+                /// <summary>
+                /// Exchange the module's weights with the averages, without copying. Calling it again swaps them back.
+                /// The average cannot be updated while swapped.
+                /// </summary>
+                public void swap()
+                {
+                    THSNN_WeightAverage_swap(handle);
+                    torch.CheckForErrors();
+                }
+
+                /// <summary>
+                /// Swap the averages into the module until the returned object is disposed.
+                /// </summary>
+                public IDisposable swapped()
+                {
+                    if (is_swapped)
+                        throw new InvalidOperationException("The averaged weights are already swapped into the module.");
+                    swap();
+                    return new SwapScope(this);
+                }
+
+                private sealed class SwapScope : IDisposable
+                {
+                    private WeightAverage _average;
+
+                    internal SwapScope(WeightAverage average) { _average = average; }
+
+                    public void Dispose()
+                    {
+                        _average?.swap();
+                        _average = null;
+                    }
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern int THSNN_WeightAverage_is_swapped(HType average);
+
+                /// <summary>
+                /// True while the module holds the averaged weights.
+                /// </summary>
+                public bool is_swapped => THSNN_WeightAverage_is_swapped(handle) != 0;
+
+                [DllImport("LibTorchSharp")]
+                private static extern long THSNN_WeightAverage_updates(HType average);
+
+                /// <summary>
+                /// The number of updates so far.
+                /// </summary>
+                public long updates => THSNN_WeightAverage_updates(handle);
+
+                [DllImport("LibTorchSharp")]
+                private static extern double THSNN_WeightAverage_decay(HType average);
+
+                /// <summary>
+                /// The decay the next update will use, which is smaller than the configured one during warm-up.
+                /// </summary>
+                public double decay => THSNN_WeightAverage_decay(handle);
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSNN_WeightAverage_get_averages(HType average, AllocatePinnedArray allocator1, AllocatePinnedArray allocator2);
+
+                /// <summary>
+                /// The averaged weights, by parameter or buffer name.
+                /// </summary>
+                public (string name, Tensor average)[] named_averages()
+                {
+                    IntPtr[] ptrArray;
+                    IntPtr[] strArray;
+
+                    using (var pa = new PinnedArray<IntPtr>())
+                    using (var sa = new PinnedArray<IntPtr>()) {
+                        THSNN_WeightAverage_get_averages(handle, pa.CreateArray, sa.CreateArray);
+                        torch.CheckForErrors();
+                        ptrArray = pa.Array;
+                        strArray = sa.Array;
+                    }
+                    return ptrArray.Select((x, i) => (Marshal.PtrToStringAnsi(strArray[i]), new Tensor(x))).ToArray();
+                }
+
+                /// <summary>
+                ///   Releases the average. If the averaged weights are swapped in, the module gets its own weights back.
+                /// </summary>
+                public void Dispose()
+                {
+                    handle.Dispose();
+                    handle.SetHandleAsInvalid();
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,123 @@
+// Copyright (c) .NET Foundation and Contributors.  All Rights Reserved.  See LICENSE in the project root for license information.
+using System;
+using System.Runtime.InteropServices;
+
+namespace TorchSharp
+{
+    public static partial class torch
+    {
+        public static partial class distributed
+        {
+            [DllImport("LibTorchSharp")]
+            private static extern IntPtr THSTorch_process_group_create([MarshalAs(UnmanagedType.LPStr)] string name, long rank, long world_size, long slot_bytes, long timeout_ms);
+
+            /// <summary>
+            /// Join a group of processes on this machine that communicate through a named shared memory segment.
+            /// Every process calls this with the same name and world size and its own rank; rank 0 creates the segment and
+            /// the call returns once all ranks have joined.
+            /// </summary>
+            /// <param name="name">The name of the group, which must be unique on the machine while the group is being formed.</param>
+            /// <param name="rank">The rank of the calling process, between 0 and world_size - 1.</param>
+            /// <param name="world_size">The number of processes in the group.</param>
+            /// <param name="slot_bytes">The number of bytes each rank exchanges per step of a collective. Larger tensors are reduced in chunks.</param>
+            /// <param name="timeout_ms">How long to wait for the other ranks, in milliseconds, before failing.</param>
+            public static ProcessGroup new_shared_memory_group(string name, long rank, long world_size, long slot_bytes = 1 << 20, long timeout_ms = 60000)
+            {
+                var res = THSTorch_process_group_create(name, rank, world_size, slot_bytes, timeout_ms);
+                if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+                return new ProcessGroup(res);
+            }
+
+            /// <summary>
+            /// A group of cooperating processes. Collectives must be called by every rank, in the same order.
+            /// </summary>
+            public sealed class ProcessGroup : IDisposable
+            {
+                internal sealed class HType : SafeHandle
+                {
+                    public HType(IntPtr preexistingHandle, bool ownsHandle) : base(IntPtr.Zero, ownsHandle)
+                    {
+                        SetHandle(preexistingHandle);
+                    }
+
+                    public override bool IsInvalid => handle == IntPtr.Zero;
+
+                    [DllImport("LibTorchSharp")]
+                    private static extern void THSTorch_process_group_dispose(HType handle);
+
+                    protected override bool ReleaseHandle()
+                    {
+                        if (!IsInvalid) THSTorch_process_group_dispose(this);
+                        SetHandle(IntPtr.Zero);
+                        return true;
+                    }
+
+                    protected override void Dispose(bool disposing)
+                    {
+                        if (disposing) {
+                            ReleaseHandle();
+                        }
+                    }
+                }
+
+                internal HType handle;
+
+                internal ProcessGroup(IntPtr handle)
+                {
+                    this.handle = new HType(handle, true);
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern long THSTorch_process_group_rank(HType group);
+
+                [DllImport("LibTorchSharp")]
+                private static extern long THSTorch_process_group_size(HType group);
+
+                /// <summary>
+                /// The rank of this process within the group.
+                /// </summary>
+                public long rank => THSTorch_process_group_rank(handle);
+
+                /// <summary>
+                /// The number of processes in the group.
+                /// </summary>
+                public long world_size => THSTorch_process_group_size(handle);
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSTorch_process_group_all_reduce_(HType group, IntPtr tensor);
+
+                /// <summary>
+                /// Replace a tensor, in place, with the sum of that tensor across all ranks.
+                /// The sum is computed in rank order, so every rank gets identical results.
+                /// </summary>
+                public Tensor all_reduce_(Tensor tensor)
+                {
+                    THSTorch_process_group_all_reduce_(handle, tensor.Handle);
+                    torch.CheckForErrors();
+                    return tensor;
+                }
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSTorch_process_group_barrier(HType group);
+
+                /// <summary>
+                /// Block until every rank has reached the barrier.
+                /// </summary>
+                public void barrier()
+                {
+                    THSTorch_process_group_barrier(handle);
+                    torch.CheckForErrors();
+                }
+
+                /// <summary>
+                ///   Leaves the group. Modules created with the group keep it alive until they are disposed.
+                /// </summary>
+                public void Dispose()
+                {
+                    handle.Dispose();
+                    handle.SetHandleAsInvalid();
+                }
+            }
+        }
+    }
+}
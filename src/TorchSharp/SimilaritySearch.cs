@@ -0,0 +1,142 @@
+// Copyright (c) .NET Foundation and Contributors.  All Rights Reserved.  See LICENSE in the project root for license information.
+using System;
+using System.Runtime.InteropServices;
+
+namespace TorchSharp
+{
+    public static partial class torch
+    {
+        [DllImport("LibTorchSharp")]
+        private static extern void THSTensor_topk_similarity(IntPtr queries, IntPtr corpus, long k, bool cosine, long tile_size, AllocatePinnedArray allocator);
+
+        /// <summary>
+        /// Finds, for each query, the k corpus rows with the highest dot product or cosine similarity.
+        /// The corpus is scored a tile of rows at a time, keeping only the running top k of each query, so the full
+        /// queries x corpus score matrix is never materialized. On the CPU, tiles are searched in parallel.
+        /// </summary>
+        /// <param name="queries">The queries, one per row.</param>
+        /// <param name="corpus">The corpus, one entry per row, with as many columns as the queries.</param>
+        /// <param name="k">The number of neighbours to return for each query.</param>
+        /// <param name="cosine">Use cosine similarity rather than the dot product.</param>
+        /// <param name="tile_size">The number of corpus rows scored at once.</param>
+        /// <returns>The scores and corpus row indices of the neighbours, best first, each of shape (queries, k).</returns>
+        public static (Tensor values, Tensor indices) topk_similarity(Tensor queries, Tensor corpus, long k, bool cosine = false, long tile_size = 65536)
+        {
+            IntPtr[] ptrArray;
+
+            using (var pa = new PinnedArray<IntPtr>()) {
+                THSTensor_topk_similarity(queries.Handle, corpus.Handle, k, cosine, tile_size, pa.CreateArray);
+                torch.CheckForErrors();
+                ptrArray = pa.Array;
+            }
+            return (new Tensor(ptrArray[0]), new Tensor(ptrArray[1]));
+        }
+
+        [DllImport("LibTorchSharp")]
+        private static extern IntPtr THSTensor_ivf_index_create(IntPtr corpus, long lists, long iterations, bool cosine);
+
+        /// <summary>
+        /// Builds an inverted-file index over a corpus, partitioning its rows into lists with k-means.
+        /// A search then scores only the rows in the lists whose centroids are closest to the query.
+        /// </summary>
+        /// <param name="corpus">The corpus, one entry per row.</param>
+        /// <param name="lists">The number of lists, i.e. k-means clusters.</param>
+        /// <param name="iterations">The number of k-means iterations.</param>
+        /// <param name="cosine">Search by cosine similarity rather than the dot product.</param>
+        public static IVFIndex ivf_index(Tensor corpus, long lists, long iterations = 10, bool cosine = false)
+        {
+            var res = THSTensor_ivf_index_create(corpus.Handle, lists, iterations, cosine);
+            if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+            return new IVFIndex(res);
+        }
+
+        /// <summary>
+        /// An inverted-file index for approximate top-k similarity search. See torch.ivf_index().
+        /// </summary>
+        /// <remarks>The index holds its own copy of the corpus, grouped by list.</remarks>
+        public sealed class IVFIndex : IDisposable
+        {
+            internal sealed class HType : SafeHandle
+            {
+                public HType(IntPtr preexistingHandle, bool ownsHandle) : base(IntPtr.Zero, ownsHandle)
+                {
+                    SetHandle(preexistingHandle);
+                }
+
+                public override bool IsInvalid => handle == IntPtr.Zero;
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSTensor_ivf_index_dispose(HType handle);
+
+                protected override bool ReleaseHandle()
+                {
+                    if (!IsInvalid) THSTensor_ivf_index_dispose(this);
+                    SetHandle(IntPtr.Zero);
+                    return true;
+                }
+
+                protected override void Dispose(bool disposing)
+                {
+                    if (disposing) {
+                        ReleaseHandle();
+                    }
+                }
+            }
+
+            internal HType handle;
+
+            internal IVFIndex(IntPtr handle)
+            {
+                this.handle = new HType(handle, true);
+            }
+
+            [DllImport("LibTorchSharp")]
+            private static extern void THSTensor_ivf_index_search(HType index, IntPtr queries, long k, long probes, AllocatePinnedArray allocator);
+
+            /// <summary>
+            /// Finds, for each query, the k highest-scoring rows among those in the 'probes' lists closest to it.
+            /// </summary>
+            /// <param name="queries">The queries, one per row.</param>
+            /// <param name="k">The number of neighbours to return for each query.</param>
+            /// <param name="probes">The number of lists to search for each query.</param>
+            /// <returns>
+            /// The scores and corpus row indices of the neighbours, best first, each of shape (queries, k).
+            /// If the probed lists hold fewer than k rows, the remaining scores are -inf and the indices -1.
+            /// </returns>
+            public (Tensor values, Tensor indices) search(Tensor queries, long k, long probes = 1)
+            {
+                IntPtr[] ptrArray;
+
+                using (var pa = new PinnedArray<IntPtr>()) {
+                    THSTensor_ivf_index_search(handle, queries.Handle, k, probes, pa.CreateArray);
+                    torch.CheckForErrors();
+                    ptrArray = pa.Array;
+                }
+                return (new Tensor(ptrArray[0]), new Tensor(ptrArray[1]));
+            }
+
+            [DllImport("LibTorchSharp")]
+            private static extern IntPtr THSTensor_ivf_index_centroids(HType index);
+
+            /// <summary>
+            /// The k-means centroids of the lists.
+            /// </summary>
+            public Tensor centroids {
+                get {
+                    var res = THSTensor_ivf_index_centroids(handle);
+                    if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+                    return new Tensor(res);
+                }
+            }
+
+            /// <summary>
+            ///   Releases the index.
+            /// </summary>
+            public void Dispose()
+            {
+                handle.Dispose();
+                handle.SetHandleAsInvalid();
+            }
+        }
+    }
+}
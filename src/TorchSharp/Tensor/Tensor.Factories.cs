@@ -2074,6 +2074,78 @@ namespace TorchSharp
         }
 
 
+        [DllImport("LibTorchSharp")]
+        extern static IntPtr THSTensor_sparse_csr(IntPtr crow_indices, IntPtr col_indices, IntPtr values, IntPtr sizes, int length, sbyte type, int deviceType, int deviceIndex, bool requiresGrad);
+
+        /// <summary>
+        /// Create a sparse tensor in CSR (Compressed Sparse Row) format, from row offsets, column indices and values.
+        /// </summary>
+        /// <param name="crow_indices">The row offsets, of length rows + 1. Row i holds the values at crow_indices[i] .. crow_indices[i+1]-1.</param>
+        /// <param name="col_indices">The column index of each value.</param>
+        /// <param name="values">The non-zero values.</param>
+        /// <param name="size">The shape of the (2D) tensor.</param>
+        /// <param name="dtype">The desired data type of the returned tensor. Default: the type of 'values'.</param>
+        /// <param name="device">The desired device of the returned tensor.</param>
+        /// <param name="requiresGrad">If autograd should record operations on the returned tensor.</param>
+        public static Tensor sparse_csr(Tensor crow_indices, Tensor col_indices, Tensor values, long[] size, torch.ScalarType? dtype = null, torch.Device device = null, bool requiresGrad = false)
+        {
+            device = torch.InitializeDevice(device);
+            if (!dtype.HasValue) {
+                // Determine the element type dynamically.
+                dtype = values.dtype;
+            }
+
+            unsafe {
+                fixed (long* psizes = size) {
+                    var handle = THSTensor_sparse_csr(crow_indices.Handle, col_indices.Handle, values.Handle, (IntPtr)psizes, size.Length, (sbyte)dtype, (int)device.type, device.index, requiresGrad);
+                    if (handle == IntPtr.Zero) {
+                        GC.Collect();
+                        GC.WaitForPendingFinalizers();
+                        handle = THSTensor_sparse_csr(crow_indices.Handle, col_indices.Handle, values.Handle, (IntPtr)psizes, size.Length, (sbyte)dtype, (int)device.type, device.index, requiresGrad);
+                    }
+                    if (handle == IntPtr.Zero) { torch.CheckForErrors(); }
+                    return new Tensor(handle);
+                }
+            }
+        }
+
+        [DllImport("LibTorchSharp")]
+        extern static IntPtr THSTensor_sparse_mm(IntPtr sparse, IntPtr dense);
+
+        /// <summary>
+        /// Matrix product of a sparse matrix and a dense matrix. For sparse COO inputs, this also supports backward
+        /// through the sparse operand, with a gradient that has the same sparsity.
+        /// </summary>
+        /// <param name="sparse">A sparse COO or CSR matrix.</param>
+        /// <param name="dense">A dense matrix.</param>
+        public static Tensor sparse_mm(Tensor sparse, Tensor dense)
+        {
+            var res = THSTensor_sparse_mm(sparse.Handle, dense.Handle);
+            if (res == IntPtr.Zero)
+                torch.CheckForErrors();
+            return new Tensor(res);
+        }
+
+        [DllImport("LibTorchSharp")]
+        extern static IntPtr THSTensor_sparse_addmm(IntPtr mat, IntPtr sparse, IntPtr dense, float beta, float alpha);
+
+        /// <summary>
+        /// Computes beta * mat + alpha * (sparse @ dense), where 'sparse' is a sparse matrix.
+        /// For sparse COO inputs, this also supports backward through the sparse operand.
+        /// </summary>
+        /// <param name="mat">A dense matrix to be added.</param>
+        /// <param name="sparse">A sparse COO or CSR matrix.</param>
+        /// <param name="dense">A dense matrix.</param>
+        /// <param name="beta">Multiplier for 'mat'.</param>
+        /// <param name="alpha">Multiplier for sparse @ dense.</param>
+        public static Tensor sparse_addmm(Tensor mat, Tensor sparse, Tensor dense, float beta = 1, float alpha = 1)
+        {
+            var res = THSTensor_sparse_addmm(mat.Handle, sparse.Handle, dense.Handle, beta, alpha);
+            if (res == IntPtr.Zero)
+                torch.CheckForErrors();
+            return new Tensor(res);
+        }
+
         /// <summary>
         /// onstructs a complex tensor with its real part equal to real and its imaginary part equal to imag.
         /// </summary>
@@ -85,6 +85,9 @@ namespace TorchSharp
             [DllImport("LibTorchSharp")]
             static extern IntPtr THSTensor_matmul(IntPtr tensor, IntPtr target);
 
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_matmul_out(IntPtr tensor, IntPtr target, IntPtr _out);
+
             /// <summary>
             /// Matrix product of two tensors.
             /// </summary>
@@ -98,9 +101,9 @@ namespace TorchSharp
             /// 4. If the first argument is 2-dimensional and the second argument is 1-dimensional, the matrix-vector product is returned.
             /// 5. If both arguments are at least 1-dimensional and at least one argument is N-dimensional (where N > 2), then a batched matrix multiply is returned.
             /// </remarks>
-            public Tensor matmul(Tensor target)
+            public Tensor matmul(Tensor target, Tensor @out = null)
             {
-                var res = THSTensor_matmul(Handle, target.Handle);
+                var res = @out is null ? THSTensor_matmul(Handle, target.Handle) : THSTensor_matmul_out(Handle, target.Handle, @out.Handle);
                 if (res == IntPtr.Zero) { torch.CheckForErrors(); }
                 return new Tensor(res);
             }
@@ -108,14 +111,17 @@ namespace TorchSharp
             [DllImport("LibTorchSharp")]
             static extern IntPtr THSTensor_mm(IntPtr tensor, IntPtr target);
 
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_mm_out(IntPtr tensor, IntPtr target, IntPtr _out);
+
             /// <summary>
             /// Performs a matrix multiplication of the matrices input and mat2.
             /// </summary>
             /// <param name="target"></param>
             /// <returns></returns>
-            public Tensor mm(Tensor target)
+            public Tensor mm(Tensor target, Tensor @out = null)
             {
-                var res = THSTensor_mm(Handle, target.Handle);
+                var res = @out is null ? THSTensor_mm(Handle, target.Handle) : THSTensor_mm_out(Handle, target.Handle, @out.Handle);
                 if (res == IntPtr.Zero) { torch.CheckForErrors(); }
                 return new Tensor(res);
             }
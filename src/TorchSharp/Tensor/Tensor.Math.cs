@@ -64,6 +64,9 @@ namespace TorchSharp
             [DllImport("LibTorchSharp")]
             static extern IntPtr THSTensor_add(IntPtr tensor, IntPtr trg, IntPtr alpha);
 
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_add_out(IntPtr tensor, IntPtr trg, IntPtr alpha, IntPtr _out);
+
             /// <summary>
             /// Add two tensors, element-wise
             /// </summary>
@@ -79,10 +82,13 @@ namespace TorchSharp
             /// </summary>
             /// <param name="target">The right-hand-side operand.</param>
             /// <param name="alpha">The RHS scale factor</param>
+            /// <param name="out">The output tensor -- optional.</param>
             /// <returns></returns>
-            public Tensor add(Tensor target, Scalar alpha)
+            public Tensor add(Tensor target, Scalar alpha, Tensor @out = null)
             {
-                var res = THSTensor_add(Handle, target.Handle, alpha.Handle);
+                var res = @out is null ?
+                    THSTensor_add(Handle, target.Handle, alpha.Handle) :
+                    THSTensor_add_out(Handle, target.Handle, alpha.Handle, @out.Handle);
                 if (res == IntPtr.Zero)
                     torch.CheckForErrors();
                 return new Tensor(res);
@@ -287,6 +293,9 @@ namespace TorchSharp
             [DllImport("LibTorchSharp")]
             static extern IntPtr THSTensor_addmm(IntPtr mat, IntPtr mat1, IntPtr mat2, float beta, float alpha);
 
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_addmm_out(IntPtr mat, IntPtr mat1, IntPtr mat2, float beta, float alpha, IntPtr _out);
+
             /// <summary>
             /// Performs a matrix multiplication of the matrices mat1 and mat2. The matrix input is added to the final result.
             /// </summary>
@@ -294,10 +303,13 @@ namespace TorchSharp
             /// <param name="mat2">Second matrix</param>
             /// <param name="beta">Input scale factor</param>
             /// <param name="alpha">Matrix multiplication scale factor</param>
+            /// <param name="out">The output tensor -- optional.</param>
             /// <returns></returns>
-            public Tensor addmm(Tensor mat1, Tensor mat2, float beta = 1, float alpha = 1)
+            public Tensor addmm(Tensor mat1, Tensor mat2, float beta = 1, float alpha = 1, Tensor @out = null)
             {
-                var res = THSTensor_addmm(Handle, mat1.Handle, mat2.Handle, beta, alpha);
+                var res = @out is null ?
+                    THSTensor_addmm(Handle, mat1.Handle, mat2.Handle, beta, alpha) :
+                    THSTensor_addmm_out(Handle, mat1.Handle, mat2.Handle, beta, alpha, @out.Handle);
                 if (res == IntPtr.Zero)
                     torch.CheckForErrors();
                 return new Tensor(res);
@@ -627,15 +639,22 @@ namespace TorchSharp
             [DllImport("LibTorchSharp")]
             static extern IntPtr THSTensor_div(IntPtr tensor, IntPtr trg, [MarshalAs(UnmanagedType.LPStr)] string rounding_mode);
 
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_div_out(IntPtr tensor, IntPtr trg, [MarshalAs(UnmanagedType.LPStr)] string rounding_mode, IntPtr _out);
+
             /// <summary>
             /// Divides each element of the input by the corresponding element of other.
             /// </summary>
             /// <param name="target">Denominator</param>
             /// <param name="rounding_mode">Rounding mode.</param>
+            /// <param name="out">The output tensor -- optional.</param>
             /// <returns></returns>
-            public Tensor div(Tensor target, RoundingMode rounding_mode = RoundingMode.None)
+            public Tensor div(Tensor target, RoundingMode rounding_mode = RoundingMode.None, Tensor @out = null)
             {
-                var res = THSTensor_div(Handle, target.Handle, rounding_mode == RoundingMode.trunc ? "trunc" : rounding_mode == RoundingMode.floor ? "floor" : null);
+                var mode = rounding_mode == RoundingMode.trunc ? "trunc" : rounding_mode == RoundingMode.floor ? "floor" : null;
+                var res = @out is null ?
+                    THSTensor_div(Handle, target.Handle, mode) :
+                    THSTensor_div_out(Handle, target.Handle, mode, @out.Handle);
                 if (res == IntPtr.Zero) { torch.CheckForErrors(); }
                 return new Tensor(res);
             }
@@ -723,12 +742,16 @@ namespace TorchSharp
             [DllImport("LibTorchSharp")]
             static extern IntPtr THSTensor_exp(IntPtr tensor);
 
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_exp_out(IntPtr tensor, IntPtr _out);
+
             /// <summary>
             /// Returns a new tensor with the exponential of the elements of the input tensor.
             /// </summary>
-            public Tensor exp()
+            /// <param name="out">The output tensor -- optional.</param>
+            public Tensor exp(Tensor @out = null)
             {
-                var res = THSTensor_exp(Handle);
+                var res = @out is null ? THSTensor_exp(Handle) : THSTensor_exp_out(Handle, @out.Handle);
                 if (res == IntPtr.Zero) { torch.CheckForErrors(); }
                 return new Tensor(res);
             }
@@ -1326,14 +1349,18 @@ namespace TorchSharp
             [DllImport("LibTorchSharp")]
             static extern IntPtr THSTensor_mul(IntPtr tensor, IntPtr target);
 
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_mul_out(IntPtr tensor, IntPtr target, IntPtr _out);
+
             /// <summary>
             /// Element-wise multiplication
             /// </summary>
             /// <param name="target">Right-hand operand</param>
+            /// <param name="out">The output tensor -- optional.</param>
             /// <returns></returns>
-            public Tensor mul(Tensor target)
+            public Tensor mul(Tensor target, Tensor @out = null)
             {
-                var res = THSTensor_mul(Handle, target.Handle);
+                var res = @out is null ? THSTensor_mul(Handle, target.Handle) : THSTensor_mul_out(Handle, target.Handle, @out.Handle);
                 if (res == IntPtr.Zero) { torch.CheckForErrors(); }
                 return new Tensor(res);
             }
@@ -1727,14 +1754,18 @@ namespace TorchSharp
             [DllImport("LibTorchSharp")]
             static extern IntPtr THSTensor_sub(IntPtr tensor, IntPtr trg);
 
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_sub_out(IntPtr tensor, IntPtr trg, IntPtr _out);
+
             /// <summary>
             /// Element-wise subtraction
             /// </summary>
             /// <param name="target">Right-hand operand</param>
+            /// <param name="out">The output tensor -- optional.</param>
             /// <returns></returns>
-            public Tensor sub(Tensor target)
+            public Tensor sub(Tensor target, Tensor @out = null)
             {
-                var res = THSTensor_sub(Handle, target.Handle);
+                var res = @out is null ? THSTensor_sub(Handle, target.Handle) : THSTensor_sub_out(Handle, target.Handle, @out.Handle);
                 if (res == IntPtr.Zero) { torch.CheckForErrors(); }
                 return new Tensor(res);
             }
@@ -2425,6 +2456,29 @@ namespace TorchSharp
             }
         }
 
+        [DllImport("LibTorchSharp")]
+        [return: MarshalAs(UnmanagedType.LPStr)]
+        extern static string THSTensor_einsum_path([MarshalAs(UnmanagedType.LPStr)] string equation, IntPtr tensors, int len);
+
+        /// <summary>
+        /// Describes the order in which einsum() contracts three or more operands of the given shapes, as a
+        /// semicolon-separated list of pairwise equations. The order is chosen to minimize the number of operations,
+        /// exhaustively for up to five operands and greedily beyond that, and is cached per equation and shapes.
+        /// </summary>
+        /// <param name="equation">The subscripts for the Einstein summation.</param>
+        /// <param name="tensors">The operands.</param>
+        /// <returns>The pairwise contractions, or an empty string if einsum() contracts the operands as given.</returns>
+        public static string einsum_path(string equation, params Tensor[] tensors)
+        {
+            using (var parray = new PinnedArray<IntPtr>()) {
+                IntPtr tensorsRef = parray.CreateArray(tensors.Select(p => p.Handle).ToArray());
+
+                var res = THSTensor_einsum_path(equation, tensorsRef, parray.Array.Length);
+                torch.CheckForErrors();
+                return res;
+            }
+        }
+
         /// <summary>
         /// Returns a new tensor with the exponential of the elements of the input tensor input.
         /// </summary>
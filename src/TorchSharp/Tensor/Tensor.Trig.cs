@@ -373,13 +373,17 @@ namespace TorchSharp
             [DllImport("LibTorchSharp")]
             static extern IntPtr THSTensor_tanh(IntPtr tensor);
 
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_tanh_out(IntPtr tensor, IntPtr _out);
+
             /// <summary>
             /// Computes the hyperbolic tangent of the elements of input.
             /// </summary>
+            /// <param name="out">The output tensor -- optional.</param>
             /// <returns></returns>
-            public Tensor tanh()
+            public Tensor tanh(Tensor @out = null)
             {
-                var res = THSTensor_tanh(Handle);
+                var res = @out is null ? THSTensor_tanh(Handle) : THSTensor_tanh_out(Handle, @out.Handle);
                 if (res == IntPtr.Zero)
                     torch.CheckForErrors();
                 return new Tensor(res);
@@ -629,6 +629,146 @@ namespace TorchSharp
                 torch.CheckForErrors();
             }
 
+            [DllImport("LibTorchSharp")]
+            static extern void THSTensor_save_mapped(IntPtr tensors, IntPtr names, int length, [MarshalAs(UnmanagedType.LPStr)] string location);
+
+            /// <summary>
+            /// Save a collection of named tensors to a file with page-aligned data, suitable for load_mapped().
+            /// </summary>
+            /// <param name="tensors">The tensors to save, keyed by name.</param>
+            /// <param name="location">The file path where tensor values are to be stored.</param>
+            public static void save_mapped(IDictionary<string, Tensor> tensors, string location)
+            {
+                var names = tensors.Keys.Select(k => Marshal.StringToHGlobalAnsi(k)).ToArray();
+
+                try {
+                    using (var parray = new PinnedArray<IntPtr>())
+                    using (var narray = new PinnedArray<IntPtr>()) {
+                        var tensorsRef = parray.CreateArray(tensors.Values.Select(t => t.Handle).ToArray());
+                        var namesRef = narray.CreateArray(names);
+                        THSTensor_save_mapped(tensorsRef, namesRef, names.Length, location);
+                        torch.CheckForErrors();
+                    }
+                } finally {
+                    foreach (var n in names) Marshal.FreeHGlobal(n);
+                }
+            }
+
+            [DllImport("LibTorchSharp")]
+            static extern void THSTensor_load_mapped([MarshalAs(UnmanagedType.LPStr)] string location, AllocatePinnedArray allocator1, AllocatePinnedArray allocator2);
+
+            /// <summary>
+            /// Load the tensors in a file written by save_mapped(). The file is memory-mapped and the returned tensors
+            /// view it directly, so data is only read from disk when it is first touched.
+            /// The mapping is private: modifying a loaded tensor never changes the file.
+            /// </summary>
+            /// <param name="location">The file path where tensor values are stored.</param>
+            /// <returns>The tensors, keyed by name.</returns>
+            public static Dictionary<string, Tensor> load_mapped(string location)
+            {
+                IntPtr[] ptrArray;
+                IntPtr[] strArray;
+
+                using (var pa = new PinnedArray<IntPtr>())
+                using (var sa = new PinnedArray<IntPtr>()) {
+                    THSTensor_load_mapped(location, pa.CreateArray, sa.CreateArray);
+                    torch.CheckForErrors();
+                    ptrArray = pa.Array;
+                    strArray = sa.Array;
+                }
+
+                var result = new Dictionary<string, Tensor>();
+                for (var i = 0; i < ptrArray.Length; ++i) {
+                    result[Marshal.PtrToStringAnsi(strArray[i])!] = new Tensor(ptrArray[i]);
+                }
+                return result;
+            }
+
+            [DllImport("LibTorchSharp")]
+            static extern void THSTensor_save_shared(IntPtr tensors, IntPtr names, int length, [MarshalAs(UnmanagedType.LPStr)] string name, AllocatePinnedArray allocator);
+
+            /// <summary>
+            /// Copy a collection of named tensors into a new named shared memory segment, which other processes on the
+            /// same host can map with load_shared(), so that they all share one physical copy of the data.
+            /// </summary>
+            /// <param name="tensors">The tensors to share, keyed by name.</param>
+            /// <param name="name">The name of the segment. It must not exist already.</param>
+            /// <returns>CPU tensors viewing the shared copies, keyed by name.</returns>
+            /// <remarks>
+            /// On Linux and macOS, the segment outlives the processes using it until unlink_shared() is called.
+            /// On Windows, it goes away when the last tensor viewing it, in any process, is disposed.
+            /// Writes to the returned tensors are visible to every process that has the segment mapped.
+            /// </remarks>
+            public static Dictionary<string, Tensor> save_shared(IDictionary<string, Tensor> tensors, string name)
+            {
+                var keys = tensors.Keys.ToArray();
+                var names = keys.Select(k => Marshal.StringToHGlobalAnsi(k)).ToArray();
+                IntPtr[] ptrArray;
+
+                try {
+                    using (var parray = new PinnedArray<IntPtr>())
+                    using (var narray = new PinnedArray<IntPtr>())
+                    using (var pa = new PinnedArray<IntPtr>()) {
+                        var tensorsRef = parray.CreateArray(keys.Select(k => tensors[k].Handle).ToArray());
+                        var namesRef = narray.CreateArray(names);
+                        THSTensor_save_shared(tensorsRef, namesRef, names.Length, name, pa.CreateArray);
+                        torch.CheckForErrors();
+                        ptrArray = pa.Array;
+                    }
+                } finally {
+                    foreach (var n in names) Marshal.FreeHGlobal(n);
+                }
+
+                var result = new Dictionary<string, Tensor>();
+                for (var i = 0; i < ptrArray.Length; ++i) {
+                    result[keys[i]] = new Tensor(ptrArray[i]);
+                }
+                return result;
+            }
+
+            [DllImport("LibTorchSharp")]
+            static extern void THSTensor_load_shared([MarshalAs(UnmanagedType.LPStr)] string name, AllocatePinnedArray allocator1, AllocatePinnedArray allocator2);
+
+            /// <summary>
+            /// Map the tensors in a named shared memory segment created by save_shared(), possibly in another process.
+            /// The returned tensors view the segment directly, without copying.
+            /// </summary>
+            /// <param name="name">The name of the segment.</param>
+            /// <returns>The tensors, keyed by name.</returns>
+            public static Dictionary<string, Tensor> load_shared(string name)
+            {
+                IntPtr[] ptrArray;
+                IntPtr[] strArray;
+
+                using (var pa = new PinnedArray<IntPtr>())
+                using (var sa = new PinnedArray<IntPtr>()) {
+                    THSTensor_load_shared(name, pa.CreateArray, sa.CreateArray);
+                    torch.CheckForErrors();
+                    ptrArray = pa.Array;
+                    strArray = sa.Array;
+                }
+
+                var result = new Dictionary<string, Tensor>();
+                for (var i = 0; i < ptrArray.Length; ++i) {
+                    result[Marshal.PtrToStringAnsi(strArray[i])!] = new Tensor(ptrArray[i]);
+                }
+                return result;
+            }
+
+            [DllImport("LibTorchSharp")]
+            static extern void THSTensor_unlink_shared([MarshalAs(UnmanagedType.LPStr)] string name);
+
+            /// <summary>
+            /// Remove the name of a shared memory segment, so that no other process can attach to it.
+            /// Processes that have already mapped it keep their tensors; the memory is freed when the last of them is disposed.
+            /// </summary>
+            /// <param name="name">The name of the segment.</param>
+            public static void unlink_shared(string name)
+            {
+                THSTensor_unlink_shared(name);
+                torch.CheckForErrors();
+            }
+
             [DllImport("LibTorchSharp")]
             static extern bool THSTensor_requires_grad(IntPtr handle);
 
@@ -879,7 +1019,7 @@ namespace TorchSharp
             static extern IntPtr THSTensor_values(IntPtr handle);
 
             /// <summary>
-            /// Return the values tensor of a sparse COO tensor.
+            /// Return the values tensor of a sparse COO or CSR tensor.
             /// </summary>
             public Tensor SparseValues {
                 get {
@@ -890,6 +1030,105 @@ namespace TorchSharp
                 }
             }
 
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_crow_indices(IntPtr handle);
+
+            /// <summary>
+            /// Return the row offsets of a sparse CSR tensor.
+            /// </summary>
+            public Tensor crow_indices()
+            {
+                var res = THSTensor_crow_indices(Handle);
+                if (res == IntPtr.Zero)
+                    torch.CheckForErrors();
+                return new Tensor(res);
+            }
+
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_col_indices(IntPtr handle);
+
+            /// <summary>
+            /// Return the column indices of a sparse CSR tensor.
+            /// </summary>
+            public Tensor col_indices()
+            {
+                var res = THSTensor_col_indices(Handle);
+                if (res == IntPtr.Zero)
+                    torch.CheckForErrors();
+                return new Tensor(res);
+            }
+
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_to_sparse(IntPtr handle, long sparse_dim);
+
+            /// <summary>
+            /// Returns a sparse COO copy of the tensor.
+            /// </summary>
+            /// <param name="sparse_dim">The number of sparse dimensions. By default, all dimensions are sparse.</param>
+            public Tensor to_sparse(long? sparse_dim = null)
+            {
+                var res = THSTensor_to_sparse(Handle, sparse_dim.HasValue ? sparse_dim.Value : -1);
+                if (res == IntPtr.Zero)
+                    torch.CheckForErrors();
+                return new Tensor(res);
+            }
+
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_to_sparse_csr(IntPtr handle);
+
+            /// <summary>
+            /// Returns a sparse CSR copy of a 2D tensor.
+            /// </summary>
+            public Tensor to_sparse_csr()
+            {
+                var res = THSTensor_to_sparse_csr(Handle);
+                if (res == IntPtr.Zero)
+                    torch.CheckForErrors();
+                return new Tensor(res);
+            }
+
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_coalesce(IntPtr handle);
+
+            /// <summary>
+            /// Returns a coalesced copy of a sparse COO tensor, i.e. one with sorted, unique indices,
+            /// where the values at duplicate indices have been summed.
+            /// </summary>
+            public Tensor coalesce()
+            {
+                var res = THSTensor_coalesce(Handle);
+                if (res == IntPtr.Zero)
+                    torch.CheckForErrors();
+                return new Tensor(res);
+            }
+
+            [DllImport("LibTorchSharp")]
+            static extern bool THSTensor_is_coalesced(IntPtr handle);
+
+            /// <summary>
+            /// Is the sparse COO tensor coalesced?
+            /// </summary>
+            public bool is_coalesced()
+            {
+                var res = THSTensor_is_coalesced(Handle);
+                torch.CheckForErrors();
+                return res;
+            }
+
+            [DllImport("LibTorchSharp")]
+            static extern bool THSTensor_is_sparse_csr(IntPtr handle);
+
+            /// <summary>
+            /// Is the tensor a sparse CSR tensor?
+            /// </summary>
+            public bool is_sparse_csr {
+                get {
+                    var res = THSTensor_is_sparse_csr(Handle);
+                    torch.CheckForErrors();
+                    return res;
+                }
+            }
+
             [DllImport("LibTorchSharp")]
             static extern IntPtr THSTensor_vander(IntPtr handle, long N, bool increasing);
 
@@ -1072,7 +1311,7 @@ namespace TorchSharp
 
             [DllImport("LibTorchSharp")]
             static extern IntPtr THSTensor_index_put_(IntPtr tensor, IntPtr indexStarts, IntPtr indexEnds, IntPtr indexSteps, IntPtr indexTensors, int indicesLength, IntPtr value);
-            internal void EncodeIndices(TensorIndex[] indices,
+            internal static void EncodeIndices(TensorIndex[] indices,
                 out long[] arrKindAndStarts,
                 out long[]? arrStops,
                 out long[]? arrSteps,
@@ -1326,6 +1565,22 @@ namespace TorchSharp
                 return index(indices.Select(t => TensorIndex.Tensor(t)).ToArray());
             }
 
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_index_plan_apply(IntPtr tensor, TensorIndexPlan.HType plan);
+
+            /// <summary>
+            /// Index into the tensor using a precompiled indexing expression.
+            /// </summary>
+            /// <param name="plan">The compiled indexing expression.</param>
+            /// <returns></returns>
+            public Tensor index(TensorIndexPlan plan)
+            {
+                var res = THSTensor_index_plan_apply(Handle, plan.handle);
+                if (res == IntPtr.Zero)
+                    torch.CheckForErrors();
+                return new Tensor(res);
+            }
+
             /// <summary>
             /// Index into the tensor using Python-like indexing expressions and place a tensor at the index.
             /// </summary>
@@ -1357,6 +1612,42 @@ namespace TorchSharp
             }
 
 
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_index_plan_put_(IntPtr tensor, TensorIndexPlan.HType plan, IntPtr value);
+
+            /// <summary>
+            /// Place a tensor at the location selected by a precompiled indexing expression.
+            /// </summary>
+            /// <param name="value">The values to write.</param>
+            /// <param name="plan">The compiled indexing expression.</param>
+            /// <returns></returns>
+            public Tensor index_put_(Tensor value, TensorIndexPlan plan)
+            {
+                var res = THSTensor_index_plan_put_(Handle, plan.handle, value.Handle);
+                if (res == IntPtr.Zero)
+                    torch.CheckForErrors();
+                GC.KeepAlive(value);
+                return new Tensor(res);
+            }
+
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_index_plan_put_scalar_(IntPtr tensor, TensorIndexPlan.HType plan, IntPtr value);
+
+            /// <summary>
+            /// Place a scalar at the location selected by a precompiled indexing expression.
+            /// </summary>
+            /// <param name="value">The value to write.</param>
+            /// <param name="plan">The compiled indexing expression.</param>
+            /// <returns></returns>
+            public Tensor index_put_(Scalar value, TensorIndexPlan plan)
+            {
+                var res = THSTensor_index_plan_put_scalar_(Handle, plan.handle, value.Handle);
+                if (res == IntPtr.Zero)
+                    torch.CheckForErrors();
+                GC.KeepAlive(value);
+                return new Tensor(res);
+            }
+
             /// <summary>
             /// Index into the tensor using Python-like indexing expressions and place a scalar tensor at the index.
             /// </summary>
@@ -2176,9 +2467,12 @@ namespace TorchSharp
             [DllImport("LibTorchSharp")]
             static extern IntPtr THSTensor_relu(IntPtr tensor);
 
-            public Tensor relu()
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_relu_out(IntPtr tensor, IntPtr _out);
+
+            public Tensor relu(Tensor? @out = null)
             {
-                var res = THSTensor_relu(Handle);
+                var res = @out is null ? THSTensor_relu(Handle) : THSTensor_relu_out(Handle, @out.Handle);
                 if (res == IntPtr.Zero)
                     torch.CheckForErrors();
                 return new Tensor(res);
@@ -2264,9 +2558,12 @@ namespace TorchSharp
             [DllImport("LibTorchSharp")]
             static extern IntPtr THSTensor_gelu(IntPtr tensor);
 
-            public Tensor gelu()
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_gelu_out(IntPtr tensor, IntPtr _out);
+
+            public Tensor gelu(Tensor? @out = null)
             {
-                var res = THSTensor_gelu(Handle);
+                var res = @out is null ? THSTensor_gelu(Handle) : THSTensor_gelu_out(Handle, @out.Handle);
                 if (res == IntPtr.Zero)
                     torch.CheckForErrors();
                 return new Tensor(res);
@@ -2535,9 +2832,12 @@ namespace TorchSharp
             [DllImport("LibTorchSharp")]
             static extern IntPtr THSTensor_silu(IntPtr tensor);
 
-            public Tensor silu()
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_silu_out(IntPtr tensor, IntPtr _out);
+
+            public Tensor silu(Tensor? @out = null)
             {
-                var res = THSTensor_silu(Handle);
+                var res = @out is null ? THSTensor_silu(Handle) : THSTensor_silu_out(Handle, @out.Handle);
                 if (res == IntPtr.Zero)
                     torch.CheckForErrors();
                 return new Tensor(res);
@@ -2602,9 +2902,12 @@ namespace TorchSharp
             [DllImport("LibTorchSharp")]
             static extern IntPtr THSTensor_bmm(IntPtr batch1, IntPtr batch2);
 
-            public Tensor bmm(Tensor batch2)
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_bmm_out(IntPtr batch1, IntPtr batch2, IntPtr _out);
+
+            public Tensor bmm(Tensor batch2, Tensor? @out = null)
             {
-                var res = THSTensor_bmm(Handle, batch2.Handle);
+                var res = @out is null ? THSTensor_bmm(Handle, batch2.Handle) : THSTensor_bmm_out(Handle, batch2.Handle, @out.Handle);
                 if (res == IntPtr.Zero) { torch.CheckForErrors(); }
                 return new Tensor(res);
             }
@@ -3640,11 +3943,16 @@ namespace TorchSharp
             [DllImport("LibTorchSharp")]
             static extern IntPtr THSTensor_mean_along_dimensions(IntPtr tensor, IntPtr dimensions, int length, bool keepdim, bool has_type, sbyte scalar_type);
 
-            public Tensor mean(long[] dimensions, bool keepDimension = false, ScalarType? type = null)
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_mean_along_dimensions_out(IntPtr tensor, IntPtr dimensions, int length, bool keepdim, bool has_type, sbyte scalar_type, IntPtr _out);
+
+            public Tensor mean(long[] dimensions, bool keepDimension = false, ScalarType? type = null, Tensor? @out = null)
             {
                 unsafe {
                     fixed (long* pdims = dimensions) {
-                        var res = THSTensor_mean_along_dimensions(Handle, (IntPtr)pdims, dimensions.Length, keepDimension, type.HasValue, (sbyte)type.GetValueOrDefault());
+                        var res = @out is null ?
+                            THSTensor_mean_along_dimensions(Handle, (IntPtr)pdims, dimensions.Length, keepDimension, type.HasValue, (sbyte)type.GetValueOrDefault()) :
+                            THSTensor_mean_along_dimensions_out(Handle, (IntPtr)pdims, dimensions.Length, keepDimension, type.HasValue, (sbyte)type.GetValueOrDefault(), @out.Handle);
                         if (res == IntPtr.Zero) { torch.CheckForErrors(); }
                         return new Tensor(res);
                     }
@@ -3865,9 +4173,12 @@ namespace TorchSharp
             [DllImport("LibTorchSharp")]
             static extern IntPtr THSTensor_sigmoid(IntPtr tensor);
 
-            public Tensor sigmoid()
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_sigmoid_out(IntPtr tensor, IntPtr _out);
+
+            public Tensor sigmoid(Tensor? @out = null)
             {
-                var res = THSTensor_sigmoid(Handle);
+                var res = @out is null ? THSTensor_sigmoid(Handle) : THSTensor_sigmoid_out(Handle, @out.Handle);
                 if (res == IntPtr.Zero) { torch.CheckForErrors(); }
                 return new Tensor(res);
             }
@@ -3922,14 +4233,23 @@ namespace TorchSharp
             [DllImport("LibTorchSharp")]
             static extern IntPtr THSTensor_sum_along_dimensions(IntPtr tensor, IntPtr dimensions, int length, bool keepdim, bool has_type, sbyte scalar_type);
 
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_sum_along_dimensions_out(IntPtr tensor, IntPtr dimensions, int length, bool keepdim, bool has_type, sbyte scalar_type, IntPtr _out);
+
             /// <summary>
             ///  Returns the sum of each row of the input tensor in the given dimensions.
             /// </summary>
-            public Tensor sum(long[] dimensions, bool keepdim = false, ScalarType? type = null)
+            /// <param name="dimensions">The dimensions to reduce.</param>
+            /// <param name="keepdim">Whether the output tensor has dim retained or not.</param>
+            /// <param name="type">The desired data type of the returned tensor.</param>
+            /// <param name="out">The output tensor -- optional.</param>
+            public Tensor sum(long[] dimensions, bool keepdim = false, ScalarType? type = null, Tensor? @out = null)
             {
                 unsafe {
                     fixed (long* pdims = dimensions) {
-                        var res = THSTensor_sum_along_dimensions(Handle, (IntPtr)pdims, dimensions.Length, keepdim, type.HasValue, (sbyte)type.GetValueOrDefault());
+                        var res = @out is null ?
+                            THSTensor_sum_along_dimensions(Handle, (IntPtr)pdims, dimensions.Length, keepdim, type.HasValue, (sbyte)type.GetValueOrDefault()) :
+                            THSTensor_sum_along_dimensions_out(Handle, (IntPtr)pdims, dimensions.Length, keepdim, type.HasValue, (sbyte)type.GetValueOrDefault(), @out.Handle);
                         if (res == IntPtr.Zero) { torch.CheckForErrors(); }
                         return new Tensor(res);
                     }
@@ -5537,6 +5857,83 @@ namespace TorchSharp
             }
         }
 
+        /// <summary>
+        /// An indexing expression that has been decoded once, so that it can be applied
+        /// to many tensors without re-encoding it on every call. Expressions made up only of
+        /// integers and slices are applied as views, without going through the general indexing path.
+        /// </summary>
+        public sealed class TensorIndexPlan : IDisposable
+        {
+            internal sealed class HType : SafeHandle
+            {
+                public HType(IntPtr preexistingHandle, bool ownsHandle) : base(IntPtr.Zero, ownsHandle)
+                {
+                    SetHandle(preexistingHandle);
+                }
+
+                public override bool IsInvalid => handle == IntPtr.Zero;
+
+                [DllImport("LibTorchSharp")]
+                private static extern void THSTensor_index_plan_dispose(HType handle);
+
+                protected override bool ReleaseHandle()
+                {
+                    if (!IsInvalid) THSTensor_index_plan_dispose(this);
+                    SetHandle(IntPtr.Zero);
+                    return true;
+                }
+
+                protected override void Dispose(bool disposing)
+                {
+                    if (disposing) {
+                        ReleaseHandle();
+                    }
+                }
+            }
+
+            internal HType handle;
+
+            [DllImport("LibTorchSharp")]
+            static extern IntPtr THSTensor_index_plan_create(IntPtr indexStarts, IntPtr indexEnds, IntPtr indexSteps, IntPtr indexTensors, int indicesLength);
+
+            /// <summary>
+            /// Compile an indexing expression. Tensors used as indices are retained by the plan.
+            /// </summary>
+            /// <param name="indices">The indexing expression.</param>
+            public TensorIndexPlan(params TensorIndex[] indices)
+            {
+                Tensor.EncodeIndices(indices, out var arrKindAndStarts, out var arrStops, out var arrSteps, out var arrTensors);
+                unsafe {
+                    fixed (long* ptrKindAndStarts = arrKindAndStarts, ptrStops = arrStops, ptrSteps = arrSteps) {
+                        fixed (IntPtr* ptrTensors = arrTensors) {
+                            var res = THSTensor_index_plan_create((IntPtr)ptrKindAndStarts, (IntPtr)ptrStops, (IntPtr)ptrSteps, (IntPtr)ptrTensors, indices.Length);
+                            if (res == IntPtr.Zero)
+                                torch.CheckForErrors();
+                            GC.KeepAlive(indices);
+                            handle = new HType(res, true);
+                        }
+                    }
+                }
+            }
+
+            [DllImport("LibTorchSharp")]
+            static extern bool THSTensor_index_plan_is_view(HType handle);
+
+            /// <summary>
+            /// True if the plan only contains integers and slices, so that applying it produces a view.
+            /// </summary>
+            public bool is_view => THSTensor_index_plan_is_view(handle);
+
+            /// <summary>
+            ///   Releases the plan, and any tensors it retains as indices.
+            /// </summary>
+            public void Dispose()
+            {
+                handle.Dispose();
+                handle.SetHandleAsInvalid();
+            }
+        }
+
         /// <summary>
         /// The element types of tensors.
         /// </summary>
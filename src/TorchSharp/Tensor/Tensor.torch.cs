@@ -253,6 +253,72 @@ namespace TorchSharp
         /// </summary>
         public static Tensor scatter_add_(Tensor input, long dimension, Tensor index, Tensor src) => input.scatter_add_(dimension, index, src);
 
+        /// <summary>
+        /// The reduction applied to each segment by segment_reduce().
+        /// </summary>
+        public enum SegmentReduction : sbyte
+        {
+            Sum = 0,
+            Mean = 1,
+            Max = 2,
+            Min = 3
+        }
+
+        [DllImport("LibTorchSharp")]
+        static extern IntPtr THSTensor_segment_reduce(IntPtr values, IntPtr offsets, sbyte reduction);
+
+        /// <summary>
+        /// Reduces consecutive runs of rows of the input. Segment s is made of rows offsets[s] to offsets[s+1] (exclusive),
+        /// so the result has offsets.shape[0] - 1 rows. Empty segments reduce to zero. Segments are reduced in parallel,
+        /// without atomics, and the reduction is differentiable.
+        /// </summary>
+        /// <param name="values">The rows to reduce, along dimension 0.</param>
+        /// <param name="offsets">Non-decreasing int64 CSR offsets, starting at 0 and ending at the number of rows.</param>
+        /// <param name="reduction">The reduction. Max and Min are only supported for CPU tensors.</param>
+        public static Tensor segment_reduce(Tensor values, Tensor offsets, SegmentReduction reduction)
+        {
+            var res = THSTensor_segment_reduce(values.Handle, offsets.Handle, (sbyte)reduction);
+            if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+            return new Tensor(res);
+        }
+
+        [DllImport("LibTorchSharp")]
+        static extern IntPtr THSTensor_segment_reduce_ids(IntPtr values, IntPtr segment_ids, long segments, sbyte reduction);
+
+        /// <summary>
+        /// Reduces the rows of the input that share a segment id.
+        /// </summary>
+        /// <param name="values">The rows to reduce, along dimension 0.</param>
+        /// <param name="segment_ids">The sorted int64 segment id of each row.</param>
+        /// <param name="num_segments">The number of segments, i.e. rows of the result.</param>
+        /// <param name="reduction">The reduction. Max and Min are only supported for CPU tensors.</param>
+        public static Tensor segment_reduce(Tensor values, Tensor segment_ids, long num_segments, SegmentReduction reduction)
+        {
+            var res = THSTensor_segment_reduce_ids(values.Handle, segment_ids.Handle, num_segments, (sbyte)reduction);
+            if (res == IntPtr.Zero) { torch.CheckForErrors(); }
+            return new Tensor(res);
+        }
+
+        /// <summary>
+        /// Sums each segment of rows given by CSR offsets. See segment_reduce().
+        /// </summary>
+        public static Tensor segment_sum(Tensor values, Tensor offsets) => segment_reduce(values, offsets, SegmentReduction.Sum);
+
+        /// <summary>
+        /// Averages each segment of rows given by CSR offsets. See segment_reduce().
+        /// </summary>
+        public static Tensor segment_mean(Tensor values, Tensor offsets) => segment_reduce(values, offsets, SegmentReduction.Mean);
+
+        /// <summary>
+        /// Takes the maximum of each segment of rows given by CSR offsets. See segment_reduce().
+        /// </summary>
+        public static Tensor segment_max(Tensor values, Tensor offsets) => segment_reduce(values, offsets, SegmentReduction.Max);
+
+        /// <summary>
+        /// Takes the minimum of each segment of rows given by CSR offsets. See segment_reduce().
+        /// </summary>
+        public static Tensor segment_min(Tensor values, Tensor offsets) => segment_reduce(values, offsets, SegmentReduction.Min);
+
         static public Tensor clamp(Tensor input, Scalar min = null, Scalar max = null) => input.clamp(min, max);
 
         static public Tensor clamp_(Tensor input, Scalar min = null, Scalar max = null) => input.clamp_(min, max);
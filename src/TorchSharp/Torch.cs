@@ -299,6 +299,81 @@ namespace TorchSharp
             }
         }
 
+        /// <summary>
+        /// Opt-in instrumentation of the native API: per-function call counts, exception counts,
+        /// latency histograms and the bytes of the tensors returned, as well as tracking of live tensor handles.
+        /// </summary>
+        public static class instrumentation
+        {
+            [DllImport("LibTorchSharp")]
+            private static extern void THSTorch_set_instrumentation(bool enabled);
+
+            [DllImport("LibTorchSharp")]
+            private static extern bool THSTorch_is_instrumentation_enabled();
+
+            /// <summary>
+            /// Turns instrumentation on or off. When off, the native overhead is a single flag check per call.
+            /// </summary>
+            public static bool enabled {
+                get { return THSTorch_is_instrumentation_enabled(); }
+                set { THSTorch_set_instrumentation(value); }
+            }
+
+            [DllImport("LibTorchSharp")]
+            private static extern void THSTorch_reset_instrumentation();
+
+            /// <summary>
+            /// Discards all statistics collected so far.
+            /// </summary>
+            public static void reset()
+            {
+                THSTorch_reset_instrumentation();
+            }
+
+            [DllImport("LibTorchSharp")]
+            [return: MarshalAs(UnmanagedType.LPStr)]
+            private static extern string THSTorch_get_instrumentation_report();
+
+            /// <summary>
+            /// Returns the statistics collected so far as tab-separated text, with a header line followed by
+            /// one line per native function, sorted by total time spent in it.
+            /// </summary>
+            public static string report()
+            {
+                return THSTorch_get_instrumentation_report();
+            }
+
+            [DllImport("LibTorchSharp")]
+            private static extern void THSTorch_set_tensor_tracking(bool enabled);
+
+            [DllImport("LibTorchSharp")]
+            private static extern bool THSTorch_is_tensor_tracking_enabled();
+
+            /// <summary>
+            /// Turns tracking of live tensor handles on or off. While on, every tensor handle handed out by the native
+            /// library is recorded together with the function that created it, until it is disposed.
+            /// Turning tracking off forgets all handles recorded so far.
+            /// </summary>
+            public static bool track_tensors {
+                get { return THSTorch_is_tensor_tracking_enabled(); }
+                set { THSTorch_set_tensor_tracking(value); }
+            }
+
+            [DllImport("LibTorchSharp")]
+            [return: MarshalAs(UnmanagedType.LPStr)]
+            private static extern string THSTorch_dump_live_tensors(bool details);
+
+            /// <summary>
+            /// Reports the tracked tensor handles that have not been disposed yet, as tab-separated text with
+            /// handle counts and storage bytes grouped by the native function that created them.
+            /// </summary>
+            /// <param name="details">If true, also list every live handle with its shape, dtype and device.</param>
+            public static string dump_live_tensors(bool details = false)
+            {
+                return THSTorch_dump_live_tensors(details);
+            }
+        }
+
         [DllImport("LibTorchSharp")]
         private static extern IntPtr THSTorch_get_and_reset_last_err();
 
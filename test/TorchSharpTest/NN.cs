@@ -464,6 +464,163 @@ namespace TorchSharp
             var eval = seq.forward(x);
         }
 
+        [Fact]
+        public void EvalSequenceBatched()
+        {
+            var lin1 = Linear(10, 8);
+            var scale = new BatchedScale(ForwardTraits.BatchAgnostic);
+            var doubled = new BatchedScale(ForwardTraits.Elementwise);
+            var seq = Sequential(lin1, scale, ReLU(), doubled);
+
+            var inputs = new[] { torch.randn(new long[] { 4, 10 }), torch.randn(new long[] { 3, 10 }), torch.randn(new long[] { 5, 10 }) };
+            var outputs = seq.forward_batch(inputs);
+
+            Assert.Equal(inputs.Length, outputs.Length);
+            for (int i = 0; i < inputs.Length; i++) {
+                Assert.Equal(new long[] { inputs[i].shape[0], 8 }, outputs[i].shape);
+                Assert.True(outputs[i].allclose(seq.forward(inputs[i]), rtol: 1e-4, atol: 1e-5));
+            }
+
+            // Each custom stage was entered once for the whole batch.
+            Assert.Equal(1, scale.Calls);
+            Assert.Equal(1, doubled.Calls);
+
+            // Without concatenation traits, the batch still arrives in a single call.
+            var plain = new BatchedScale(ForwardTraits.None);
+            var outputs2 = Sequential(lin1, plain).forward_batch(inputs);
+            Assert.Equal(1, plain.Calls);
+            Assert.True(outputs2[2].allclose(lin1.forward(inputs[2]) * 2, rtol: 1e-4, atol: 1e-5));
+        }
+
+        [Fact]
+        public void EvalSequencePlanned()
+        {
+            var seq = Sequential(Linear(10, 16), ReLU(), Dropout(0.5), Linear(16, 8), Tanh(), Flatten(), Linear(8, 4), Sigmoid());
+            seq.Eval();
+
+            var example = torch.randn(new long[] { 6, 10 });
+            using (var plan = seq.plan(example)) {
+                // Two buffers, each large enough for the largest activation assigned to it.
+                Assert.Equal(2 * 6 * 16 * sizeof(float), plan.workspace_bytes);
+
+                for (int i = 0; i < 3; i++) {
+                    var input = torch.randn(new long[] { 6, 10 });
+                    var expected = seq.forward(input);
+                    var output = plan.forward(input);
+                    Assert.Equal(expected.shape, output.shape);
+                    Assert.True(output.allclose(expected, rtol: 1e-4, atol: 1e-5));
+                }
+
+                Assert.Throws<ExternalException>(() => plan.forward(torch.randn(new long[] { 5, 10 })));
+            }
+
+            // A single planned layer uses only one of the two buffers.
+            var single = Sequential(Linear(10, 16));
+            using (var plan = single.plan(example)) {
+                Assert.Equal(6 * 16 * sizeof(float), plan.workspace_bytes);
+            }
+
+            // With no plannable layers, there are no buffers at all.
+            using (var plan = Sequential(Dropout(0.5)).plan(example)) {
+                Assert.Equal(0, plan.workspace_bytes);
+            }
+        }
+
+        [Fact]
+        public void TestProfileCost()
+        {
+            var seq = Sequential(
+                ("conv", Conv2d(3, 8, 3, padding: 1)),
+                ("relu", ReLU()),
+                ("pool", MaxPool2d(2)),
+                ("flat", Flatten()),
+                ("fc", Linear(128, 10)));
+
+            var costs = seq.profile_cost(new long[] { 2, 3, 8, 8 });
+            Assert.Equal(new[] { "conv", "relu", "pool", "flat", "fc" }, costs.Select(c => c.name));
+            Assert.Equal(new[] { "Conv2d", "ReLU", "MaxPool2d", "Flatten", "Linear" }, costs.Select(c => c.kind));
+
+            // Conv2d: [2, 8, 8, 8] output, 27 multiply-adds per output element, plus the bias.
+            Assert.Equal(8 * 3 * 9 + 8, costs[0].parameters);
+            Assert.Equal(2 * 1024 * 27 + 1024, costs[0].flops);
+            Assert.Equal(1024 * sizeof(float), costs[0].activation_bytes);
+            Assert.Equal((384 + 224 + 1024) * sizeof(float), costs[0].memory_traffic_bytes);
+
+            Assert.Equal(1024, costs[1].flops);
+            Assert.Equal(256 * 4, costs[2].flops);
+            Assert.Equal(0, costs[3].activation_bytes);
+            Assert.Equal(2 * 2 * 128 * 10 + 20, costs[4].flops);
+            Assert.Equal(1290, costs[4].parameters);
+
+            // LSTM: four gates over input and hidden state, for 5 steps of a batch of 3.
+            var lstm = LSTM(10, 20);
+            var lstmCost = lstm.profile_cost(new long[] { 5, 3, 10 }).Single();
+            Assert.Equal(15 * (2 * 4 * 20 * 30 + 8 * 20 + 2 * 4 * 20), lstmCost.flops);
+            // The [5, 3, 20] output plus the 15 x 4 x 20 gate pre-activations; traffic adds the input, the 2560 weights
+            // and a write and read of the pre-activations.
+            Assert.Equal((300 + 1200) * sizeof(float), lstmCost.activation_bytes);
+            Assert.Equal((150 + 2560 + 300 + 2 * 1200) * sizeof(float), lstmCost.memory_traffic_bytes);
+
+            // Custom modules have no closed form, but are run to learn their output shape.
+            var custom = Sequential(("scale", new BatchedScale(ForwardTraits.None)), ("fc", Linear(4, 2)));
+            var customCosts = custom.profile_cost(new long[] { 3, 4 });
+            Assert.Null(customCosts[0].flops);
+            Assert.Equal(2 * 3 * 4 * 2 + 6, customCosts[1].flops);
+
+            Assert.Throws<ExternalException>(() => seq.profile_cost(new long[] { 2, 4, 8, 8 }));
+        }
+
+        [Fact]
+        public void TestSequentialPipeline()
+        {
+            var seq = Sequential(Linear(10, 32), ReLU(), Linear(32, 32), Tanh(), Linear(32, 4));
+            var input = torch.randn(new long[] { 12, 10 });
+            var target = torch.randn(new long[] { 12, 4 });
+            var mse = mse_loss();
+
+            using (var pipeline = seq.pipeline(new long[] { 2, 4 }, numa_nodes: new[] { 0 })) {
+                Assert.Equal(new long[] { 2, 2, 1 }, pipeline.stage_sizes);
+                Assert.Equal(3, pipeline.stage_nodes.Length);
+
+                var expected = seq.forward(input);
+                Assert.True(pipeline.forward(input, 4).allclose(expected, rtol: 1e-4, atol: 1e-5));
+
+                // A GPipe step accumulates the same gradients as a full batch.
+                seq.zero_grad();
+                mse(seq.forward(input), target).backward();
+                var grads = seq.parameters().Select(p => p.grad()!.clone()).ToArray();
+
+                seq.zero_grad();
+                var loss = pipeline.train_step(input, target, (o, t) => mse(o, t), 3);
+                Assert.Equal(mse(expected, target).item<float>(), loss.item<float>(), 4);
+                foreach (var (p, g) in seq.parameters().Zip(grads)) {
+                    Assert.True(p.grad()!.allclose(g, rtol: 1e-4, atol: 1e-5));
+                }
+
+                Assert.Throws<ExternalException>(() => pipeline.backward(loss));
+            }
+
+            using (var balanced = seq.pipeline(2)) {
+                Assert.Equal(2, balanced.stage_sizes.Length);
+                Assert.Equal(5, balanced.stage_sizes.Sum());
+            }
+        }
+
+        private class BatchedScale : Module
+        {
+            public BatchedScale(ForwardTraits traits) : base("BatchedScale", traits) { }
+
+            public int Calls { get; private set; }
+
+            public override Tensor forward(Tensor input) => input * 2;
+
+            public override Tensor[] forward_batch(Tensor[] inputs)
+            {
+                Calls += 1;
+                return base.forward_batch(inputs);
+            }
+        }
+
         [Fact]
         public void CreateSequence2()
         {
@@ -1037,6 +1194,132 @@ namespace TorchSharp
                 }
             }
         }
+
+        [Fact]
+        public void TestPerSampleGradients()
+        {
+            var seq = Sequential(Conv2d(2, 4, 3, padding: 1, groups: 2), ReLU(), Flatten(), LayerNorm(new long[] { 100 }), Linear(100, 2));
+            var x = torch.randn(new long[] { 3, 2, 5, 5 });
+
+            // Reference: one backward pass per sample.
+            var expected = new System.Collections.Generic.List<Tensor[]>();
+            for (int i = 0; i < 3; i++) {
+                seq.zero_grad();
+                seq.forward(x.narrow(0, i, 1)).pow(2).sum().backward();
+                expected.Add(seq.parameters().Select(p => p.grad()!.clone()).ToArray());
+            }
+
+            using (var trace = seq.per_sample_forward(x)) {
+                var grads = trace.grads(trace.output.pow(2).sum());
+                Assert.Equal(6, grads.Count);
+                for (int p = 0; p < grads.Count; p++) {
+                    Assert.Equal(3, grads[p].shape[0]);
+                    for (int i = 0; i < 3; i++) {
+                        Assert.True(grads[p][i].allclose(expected[i][p], rtol: 1e-3, atol: 1e-4));
+                    }
+                }
+            }
+
+            seq.zero_grad();
+            using (var trace = seq.per_sample_forward(x)) {
+                var norms = trace.clip_and_accumulate(trace.output.pow(2).sum(), max_norm: 0.5);
+                Assert.Equal(new long[] { 3 }, norms.shape);
+
+                var parameters = seq.parameters();
+                for (int p = 0; p < parameters.Length; p++) {
+                    var sum = torch.zeros_like(parameters[p]);
+                    for (int i = 0; i < 3; i++) {
+                        var norm = norms[i].ToSingle();
+                        sum = sum + expected[i][p] * Math.Min(1.0, 0.5 / (norm + 1e-6));
+                    }
+                    Assert.True(parameters[p].grad()!.allclose(sum, rtol: 1e-3, atol: 1e-4));
+                }
+            }
+
+            var embedding = Sequential(Embedding(10, 4), Linear(4, 1));
+            var tokens = torch.tensor(new long[] { 1, 2, 1, 7, 3, 3 }).reshape(3, 2);
+
+            var embeddingExpected = new System.Collections.Generic.List<Tensor[]>();
+            for (int i = 0; i < 3; i++) {
+                embedding.zero_grad();
+                embedding.forward(tokens.narrow(0, i, 1)).sum().backward();
+                embeddingExpected.Add(embedding.parameters().Select(p => p.grad()!.clone()).ToArray());
+            }
+
+            using (var trace = embedding.per_sample_forward(tokens)) {
+                var grads = trace.grads(trace.output.sum());
+                Assert.True(grads[0].is_sparse);
+                Assert.Equal(new long[] { 3, 10, 4 }, grads[0].shape);
+                var dense = grads[0].to_dense();
+                Assert.Equal(0, dense[0][5].abs().sum().ToSingle());
+                for (int i = 0; i < 3; i++) {
+                    Assert.True(dense[i].allclose(embeddingExpected[i][0], rtol: 1e-3, atol: 1e-4));
+                }
+            }
+
+            embedding.zero_grad();
+            using (var trace = embedding.per_sample_forward(tokens)) {
+                var norms = trace.clip_and_accumulate(trace.output.sum(), max_norm: 0.5);
+
+                // Sample 2 looks up row 3 twice, so its rows must be summed before taking the norm.
+                var sum = torch.zeros(new long[] { 10, 4 });
+                for (int i = 0; i < 3; i++) {
+                    var norm = (float)Math.Sqrt(embeddingExpected[i].Sum(g => g.pow(2).sum().ToSingle()));
+                    Assert.Equal(norm, norms[i].ToSingle(), 3);
+                    sum = sum + embeddingExpected[i][0] * Math.Min(1.0, 0.5 / (norm + 1e-6));
+                }
+                Assert.True(embedding.parameters()[0].grad()!.allclose(sum, rtol: 1e-3, atol: 1e-4));
+            }
+        }
+
+        [Fact]
+        public void TestForwardAD()
+        {
+            var x = torch.randn(new long[] { 3, 4 });
+            var v = torch.randn(new long[] { 3, 4 });
+
+            using (torch.autograd.forward_ad.dual_level()) {
+                var dual = torch.autograd.forward_ad.make_dual(x, v);
+                var (primal, tangent) = torch.autograd.forward_ad.unpack_dual(dual.sin() * 2);
+                Assert.True(primal.allclose(x.sin() * 2, rtol: 1e-4, atol: 1e-5));
+                Assert.NotNull(tangent);
+                Assert.True(tangent.allclose(x.cos() * v * 2, rtol: 1e-4, atol: 1e-5));
+
+                Assert.Null(torch.autograd.forward_ad.unpack_dual(x).tangent);
+            }
+
+            Assert.Throws<InvalidOperationException>(() => torch.autograd.forward_ad.make_dual(x, v));
+        }
+
+        [Fact]
+        public void TestBatchedJacobianProducts()
+        {
+            var W = torch.randn(new long[] { 4, 3 });
+            var x = torch.randn(new long[] { 3 }, requiresGrad: true);
+
+            var tangents = torch.randn(new long[] { 5, 3 });
+            var jvp = torch.autograd.batched_jvp(new[] { W.matmul(x) }, new[] { x }, new[] { tangents });
+            Assert.Single(jvp);
+            Assert.Equal(new long[] { 5, 4 }, jvp[0].shape);
+            Assert.True(jvp[0].allclose(tangents.mm(W.t()), rtol: 1e-4, atol: 1e-5));
+
+            var cotangents = torch.randn(new long[] { 5, 4 });
+            var vjp = torch.autograd.batched_vjp(new[] { W.matmul(x) }, new[] { x }, new[] { cotangents });
+            Assert.Equal(new long[] { 5, 3 }, vjp[0].shape);
+            Assert.True(vjp[0].allclose(cotangents.mm(W), rtol: 1e-4, atol: 1e-5));
+
+            // The Hessian of sum(x^3) is diag(6x).
+            var directions = torch.randn(new long[] { 5, 3 });
+            var hvp = torch.autograd.batched_hvp((x * x * x).sum(), new[] { x }, new[] { directions });
+            Assert.Equal(new long[] { 5, 3 }, hvp[0].shape);
+            Assert.True(hvp[0].allclose(directions * (x.detach() * 6), rtol: 1e-4, atol: 1e-5));
+
+            // Directions must pair up with the inputs and share one batch size.
+            var y = torch.randn(new long[] { 2 }, requiresGrad: true);
+            Assert.Throws<ExternalException>(() => torch.autograd.batched_hvp((x * x).sum(), new[] { x }, new Tensor[0]));
+            Assert.Throws<ExternalException>(() => torch.autograd.batched_jvp(new[] { W.matmul(x) }, new[] { x, y }, new[] { tangents }));
+            Assert.Throws<ExternalException>(() => torch.autograd.batched_hvp((x * x).sum() + (y * y).sum(), new[] { x, y }, new[] { directions, torch.randn(new long[] { 4, 2 }) }));
+        }
         #endregion
 
         #region Convolution
@@ -1498,6 +1781,65 @@ namespace TorchSharp
             Assert.True(seq.has_parameter("0.dict.second"));
         }
 
+        [Fact]
+        public void TestParameterTable()
+        {
+            var module = new TestModule2(torch.randn(new long[] { 2, 2 }), true);
+            var table = module.parameter_table();
+            Assert.Same(table, module.parameter_table());
+
+            var ps = table.named_parameters();
+            Assert.Equal(module.named_parameters().Select(p => p.name), ps.Select(p => p.name));
+            Assert.Equal(module.named_modules().Select(m => m.name), table.named_modules().Select(m => m.name));
+
+            // Unchanged structure: the same cached entries are returned.
+            Assert.Same(ps, table.named_parameters());
+
+            // Registering anything invalidates the table.
+            var seq = Sequential(("inner", module));
+            var ps2 = table.named_parameters();
+            Assert.NotSame(ps, ps2);
+            Assert.Equal(16, ps2.Length);
+
+            // Cached entries alias the module's parameters.
+            using (torch.no_grad()) {
+                ps2[0].parameter.fill_(3.0f);
+            }
+            Assert.Equal(3.0f, module.get_parameter(ps2[0].name)[0, 0].ToSingle());
+        }
+
+        [Fact]
+        public void TestWeightAverage()
+        {
+            var lin = Linear(4, 3);
+            var w0 = lin.weight.clone();
+
+            using var ema = lin.weight_average(decay: 0.9);
+            Assert.Equal(new[] { "weight", "bias" }, ema.named_averages().Select(a => a.name));
+
+            using (torch.no_grad()) {
+                lin.weight.add_(1.0f);
+            }
+            ema.update();
+            Assert.Equal(1, ema.updates);
+
+            var expected = w0 * 0.9f + (w0 + 1.0f) * 0.1f;
+            Assert.True(ema.named_averages()[0].average.allclose(expected, rtol: 1e-5, atol: 1e-6));
+
+            // Swapping puts the averages into the module, and swapping back restores the trained weights.
+            using (ema.swapped()) {
+                Assert.True(ema.is_swapped);
+                Assert.True(lin.weight.allclose(expected, rtol: 1e-5, atol: 1e-6));
+                Assert.Throws<ExternalException>(() => ema.update());
+            }
+            Assert.False(ema.is_swapped);
+            Assert.True(lin.weight.allclose(w0 + 1.0f));
+
+            // Warm-up starts with a small decay.
+            using var warm = lin.weight_average(decay: 0.999, warmup: true);
+            Assert.Equal(0.1, warm.decay, 6);
+        }
+
         private class TestModule1 : Module
         {
             public TestModule1(Tensor tensor, bool withGrad)
@@ -2054,6 +2396,52 @@ namespace TorchSharp
             }
         }
 
+        [Fact]
+        public void TestSyncBatchNorm()
+        {
+            var name = "tsbn" + Guid.NewGuid().ToString("N").Substring(0, 8);
+            // A large mean relative to the spread, which summed squares would lose precision on.
+            var input = torch.randn(new long[] { 8, 3, 5 }) * 0.5f + 1000.0f;
+            var grad = torch.randn(new long[] { 8, 3, 5 });
+
+            using var reference = BatchNorm1d(3);
+            var referenceInput = input.detach().requires_grad_();
+            var expected = reference.forward(referenceInput);
+            (expected * grad).sum().backward();
+
+            // Two ranks, each normalizing half of the batch, should match normalizing the whole batch.
+            var halves = input.chunk(2);
+            var gradHalves = grad.chunk(2);
+            var outputs = new Tensor[2];
+            var inputGrads = new Tensor[2];
+            var weightGrads = new Tensor[2];
+            var biasGrads = new Tensor[2];
+            var means = new Tensor[2];
+            var ranks = Enumerable.Range(0, 2).Select(rank => System.Threading.Tasks.Task.Run(() => {
+                using var group = torch.distributed.new_shared_memory_group(name, rank, 2, timeout_ms: 10000);
+                Assert.Equal(2, group.world_size);
+                using var norm = SyncBatchNorm(3, group);
+                var x = halves[rank].detach().requires_grad_();
+                outputs[rank] = norm.forward(x);
+                (outputs[rank] * gradHalves[rank]).sum().backward();
+                inputGrads[rank] = x.grad()!;
+                weightGrads[rank] = norm.weight!.grad()!;
+                biasGrads[rank] = norm.bias!.grad()!;
+                means[rank] = norm.running_mean!.clone();
+            })).ToArray();
+            System.Threading.Tasks.Task.WaitAll(ranks);
+
+            Assert.True(torch.cat(outputs, 0).allclose(expected, rtol: 1e-4, atol: 1e-3));
+            Assert.True(means[0].allclose(reference.running_mean!, rtol: 1e-4, atol: 1e-3));
+            Assert.True(means[0].allclose(means[1], rtol: 0, atol: 0));
+
+            // Input gradients account for the other rank's share of the statistics. Parameter gradients are local,
+            // and add up to the single-process ones, as a data-parallel all-reduce of them would.
+            Assert.True(torch.cat(inputGrads, 0).allclose(referenceInput.grad()!, rtol: 1e-3, atol: 1e-3));
+            Assert.True((weightGrads[0] + weightGrads[1]).allclose(reference.weight.grad()!, rtol: 1e-3, atol: 1e-3));
+            Assert.True((biasGrads[0] + biasGrads[1]).allclose(reference.bias.grad()!, rtol: 1e-3, atol: 1e-3));
+        }
+
         [Fact]
         public void TestBatchNorm2D()
         {
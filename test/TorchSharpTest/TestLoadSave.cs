@@ -59,6 +59,141 @@ namespace TorchSharp
             Assert.Equal(params0, params1);
         }
 
+        [Fact]
+        public void TestSaveLoadMapped()
+        {
+            if (File.Exists(".model.ts")) File.Delete(".model.ts");
+            var seq = Sequential(("lin1", Linear(100, 10, true)), ("lin2", Linear(10, 5, true)));
+            var params0 = seq.parameters();
+            seq.save(".model.ts");
+
+            var copied = Sequential(("lin1", Linear(100, 10, true)), ("lin2", Linear(10, 5, true)));
+            copied.load_mapped(".model.ts");
+            Assert.Equal(params0, copied.parameters());
+
+            var mapped = Sequential(("lin1", Linear(100, 10, true)), ("lin2", Linear(10, 5, true)));
+            mapped.load_mapped(".model.ts", zero_copy: true);
+            Assert.Equal(params0, mapped.parameters());
+
+            var mismatched = Sequential(("lin1", Linear(100, 10, true)), ("lin3", Linear(10, 5, true)));
+            Assert.Throws<ExternalException>(() => mismatched.load_mapped(".model.ts"));
+            mismatched.load_mapped(".model.ts", strict: false);
+
+            mapped.Dispose();
+            File.Delete(".model.ts");
+        }
+
+        [Fact]
+        public void TestSaveAsync()
+        {
+            if (File.Exists(".model.ts")) File.Delete(".model.ts");
+            if (File.Exists(".optim.ts")) File.Delete(".optim.ts");
+
+            var linear = Linear(100, 10, true);
+            var optimizer = torch.optim.Adam(linear.parameters());
+            linear.forward(torch.randn(new long[] { 16, 100 })).sum().backward();
+            optimizer.step();
+
+            var before = linear.parameters().Select(p => p.clone()).ToArray();
+
+            using (var checkpoint = linear.save_async(".model.ts", optimizer, ".optim.ts")) {
+                // Training may continue while the checkpoint is being written.
+                using (var _ = torch.no_grad()) {
+                    foreach (var p in linear.parameters()) p.add_(1.0);
+                }
+                checkpoint.Wait();
+                Assert.True(checkpoint.IsCompleted);
+            }
+
+            Assert.True(new FileInfo(".model.ts").Length > 0);
+            Assert.False(File.Exists(".model.ts.tmp"));
+
+            // The checkpoint holds the weights from before the update that followed the call.
+            var loaded = Linear(100, 10, true);
+            loaded.load_checkpoint(".model.ts");
+            var after = linear.parameters();
+            var restored = loaded.parameters();
+            for (int i = 0; i < before.Length; i++) {
+                Assert.True(restored[i].allclose(before[i], rtol: 0, atol: 0));
+                Assert.False(restored[i].allclose(after[i]));
+            }
+            Module.clear_checkpoint_staging();
+
+            var loadedOptimizer = torch.optim.Adam(Linear(100, 10, true).parameters());
+            loadedOptimizer.load(".optim.ts");
+
+            File.Delete(".model.ts");
+            File.Delete(".optim.ts");
+        }
+
+        [Fact]
+        public void TestSaveLoadMappedTensors()
+        {
+            if (File.Exists(".tensors.bin")) File.Delete(".tensors.bin");
+
+            var tensors = new System.Collections.Generic.Dictionary<string, torch.Tensor> {
+                { "weight", torch.randn(new long[] { 33, 17 }) },
+                { "index", torch.arange(0, 100, torch.int64) },
+                { "scalar", torch.tensor(3.5) },
+            };
+            torch.Tensor.save_mapped(tensors, ".tensors.bin");
+
+            var loaded = torch.Tensor.load_mapped(".tensors.bin");
+            Assert.Equal(tensors.Count, loaded.Count);
+            foreach (var (name, t) in tensors) {
+                Assert.Equal(t.dtype, loaded[name].dtype);
+                Assert.Equal(t.shape, loaded[name].shape);
+                Assert.True(t.Equals(loaded[name]));
+            }
+
+            // Writing to a mapped tensor must not change the file.
+            loaded["weight"].zero_();
+            var reloaded = torch.Tensor.load_mapped(".tensors.bin");
+            Assert.True(tensors["weight"].Equals(reloaded["weight"]));
+
+            foreach (var t in loaded.Values) t.Dispose();
+            foreach (var t in reloaded.Values) t.Dispose();
+            File.Delete(".tensors.bin");
+        }
+
+        [Fact]
+        public void TestShareMemory()
+        {
+            var name = "torchsharp-test-" + Guid.NewGuid().ToString("N");
+
+            var seq = Sequential(("lin1", Linear(100, 10, true)), ("lin2", Linear(10, 5, true)));
+            var params0 = seq.parameters().Select(p => p.clone()).ToArray();
+            seq.share_memory(name);
+            Assert.Equal(params0, seq.parameters());
+
+            try {
+                // A replica, as another process would create it, sees the same data without copying it.
+                var replica = Sequential(("lin1", Linear(100, 10, true)), ("lin2", Linear(10, 5, true)));
+                replica.attach_shared_memory(name);
+                Assert.Equal(params0, replica.parameters());
+
+                using (var _ = torch.no_grad()) {
+                    seq.parameters()[0].add_(1.0);
+                }
+                Assert.Equal(seq.parameters(), replica.parameters());
+
+                var mismatched = Sequential(("lin1", Linear(100, 10, true)), ("lin3", Linear(10, 5, true)));
+                Assert.Throws<ArgumentException>(() => mismatched.attach_shared_memory(name));
+
+                var tensors = torch.Tensor.load_shared(name);
+                Assert.Equal(new[] { "lin1.bias", "lin1.weight", "lin2.bias", "lin2.weight" }, tensors.Keys.OrderBy(k => k, StringComparer.Ordinal));
+                foreach (var t in tensors.Values) t.Dispose();
+
+                Assert.Throws<ExternalException>(() => Sequential(("lin1", Linear(100, 10, true))).share_memory(name));
+            } finally {
+                torch.Tensor.unlink_shared(name);
+            }
+
+            if (!RuntimeInformation.IsOSPlatform(OSPlatform.Windows)) {
+                Assert.Throws<ExternalException>(() => torch.Tensor.load_shared(name));
+            }
+        }
+
         [Fact]
         public void TestSaveLoadCustomWithParameters()
         {
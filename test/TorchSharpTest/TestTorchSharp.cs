@@ -171,6 +171,107 @@ namespace TorchSharp
             }
         }
 
+        [Fact]
+        public void TestInstrumentation()
+        {
+            torch.instrumentation.enabled = true;
+            try {
+                var x = torch.randn(new long[] { 16, 16 });
+                for (int i = 0; i < 10; i++) {
+                    using var y = x.matmul(x);
+                }
+                Assert.Throws<ExternalException>(() => x.matmul(torch.randn(new long[] { 3, 3 })));
+            } finally {
+                torch.instrumentation.enabled = false;
+            }
+
+            var report = torch.instrumentation.report();
+            var lines = report.Split('\n');
+            Assert.StartsWith("function\tcalls\texceptions", lines[0]);
+
+            var matmul = Array.Find(lines, l => l.StartsWith("THSTensor_matmul\t"));
+            Assert.NotNull(matmul);
+            var columns = matmul!.Split('\t');
+            Assert.True(long.Parse(columns[1]) >= 11);
+            Assert.True(long.Parse(columns[2]) >= 1);
+        }
+
+        [Fact]
+        public void TestCaptureReplay()
+        {
+            var lin = torch.nn.Linear(8, 4);
+            var x = torch.randn(new long[] { 16, 8 });
+
+            using (var graph = torch.capture(inputs => new[] { lin.forward(inputs[0]).relu().sum(new long[] { 1 }) }, lin, x)) {
+                Assert.Contains("aten::relu", graph.ToString());
+
+                var y = torch.randn(new long[] { 16, 8 });
+                var outputs = graph.replay(y);
+                Assert.Single(outputs);
+                Assert.True(outputs[0].allclose(lin.forward(y).relu().sum(new long[] { 1 }), rtol: 1e-4, atol: 1e-5));
+
+                // The parameters are referenced, not copied, so replays see updated weights.
+                using (torch.no_grad()) {
+                    lin.weight.mul_(2.0f);
+                }
+                Assert.True(graph.replay(y)[0].allclose(lin.forward(y).relu().sum(new long[] { 1 }), rtol: 1e-4, atol: 1e-5));
+
+                Assert.Throws<ExternalException>(() => graph.replay(x, y));
+            }
+
+            // Parameters that require grad cannot be recorded unless the module is passed.
+            Assert.Throws<ExternalException>(() => torch.capture(inputs => new[] { lin.forward(inputs[0]) }, x));
+
+            // A failed recording leaves the thread free to record again.
+            Assert.Throws<ExternalException>(() => torch.capture(inputs => new[] { inputs[0].mm(inputs[0]) }, x));
+            torch.capture(inputs => new[] { inputs[0] * 2 }, x).Dispose();
+        }
+
+        [Fact]
+        public void TestTraceAndSave()
+        {
+            var seq = torch.nn.Sequential(torch.nn.Linear(8, 16), torch.nn.ReLU(), torch.nn.Linear(16, 4));
+            var x = torch.randn(new long[] { 5, 8 });
+            var expected = seq.forward(x);
+
+            using (var traced = torch.jit.trace(seq, x)) {
+                Assert.True(traced.forward(x).allclose(expected, rtol: 1e-4, atol: 1e-5));
+
+                foreach (var freeze in new[] { false, true }) {
+                    var location = System.IO.Path.GetTempFileName();
+                    try {
+                        traced.save(location, freeze);
+                        using (var loaded = torch.jit.load(location)) {
+                            var y = torch.randn(new long[] { 3, 8 });
+                            Assert.True(loaded.forward(y).allclose(seq.forward(y), rtol: 1e-4, atol: 1e-5));
+                        }
+                    } finally {
+                        System.IO.File.Delete(location);
+                    }
+                }
+            }
+        }
+
+        [Fact]
+        public void TestLiveTensorTracking()
+        {
+            torch.instrumentation.track_tensors = true;
+            try {
+                var leaked = torch.zeros(new long[] { 1000, 1000 });
+                using (var disposed = torch.ones(new long[] { 10, 10 })) { }
+
+                var report = torch.instrumentation.dump_live_tensors(details: true);
+                var zeros = Array.Find(report.Split('\n'), l => l.StartsWith("THSTensor_zeros\t"));
+                Assert.NotNull(zeros);
+                Assert.True(long.Parse(zeros!.Split('\t')[2]) >= 4000000);
+                Assert.Contains("[1000, 1000]", report);
+
+                leaked.Dispose();
+            } finally {
+                torch.instrumentation.track_tensors = false;
+            }
+        }
+
         // Because some of the tests mess with global state, and are run in parallel, we need to
         // acquire a lock before testing setting the default RNG see.
         private static object _lock = new object();
@@ -1783,6 +1783,65 @@ namespace TorchSharp
             }
         }
 
+        [Fact]
+        public void TorchAliasSampler()
+        {
+            var probs = torch.tensor(new float[] { 1, 0, 3, 6 });
+            using (var sampler = torch.alias_sampler(probs)) {
+                Assert.Equal(4, sampler.categories);
+
+                var samples = sampler.sample(new long[] { 400, 250 });
+                Assert.Equal(new long[] { 400, 250 }, samples.shape);
+                Assert.Equal(torch.int64, samples.dtype);
+
+                // A zero-probability category is never drawn, and the frequencies approach the probabilities.
+                var frequencies = samples.ravel().bincount(null, 4).to_type(torch.float64) / 100000.0;
+                Assert.Equal(0, frequencies[1].ToDouble());
+                Assert.True(frequencies.allclose(torch.tensor(new double[] { 0.1, 0, 0.3, 0.6 }), atol: 0.01));
+
+                // The same generator state gives the same samples.
+                using (var gen1 = new torch.Generator(4711L))
+                using (var gen2 = new torch.Generator(4711L)) {
+                    Assert.True(sampler.sample(1000, gen1).Equals(sampler.sample(1000, gen2)));
+                }
+            }
+
+            Assert.Throws<ExternalException>(() => torch.alias_sampler(torch.tensor(new float[] { 1, -1 })));
+        }
+
+        [Fact]
+        public void TorchSegmentReduce()
+        {
+            var values = torch.tensor(new float[] { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10 }, new long[] { 5, 2 }, requiresGrad: true);
+            var offsets = torch.tensor(new long[] { 0, 2, 2, 5 });
+
+            var sum = torch.segment_sum(values, offsets);
+            Assert.Equal(new long[] { 3, 2 }, sum.shape);
+            Assert.Equal(new float[] { 4, 6, 0, 0, 21, 24 }, sum.data<float>().ToArray());
+
+            Assert.Equal(new float[] { 2, 3, 0, 0, 7, 8 }, torch.segment_mean(values, offsets).data<float>().ToArray());
+            Assert.Equal(new float[] { 3, 4, 0, 0, 9, 10 }, torch.segment_max(values, offsets).data<float>().ToArray());
+            Assert.Equal(new float[] { 1, 2, 0, 0, 5, 6 }, torch.segment_min(values, offsets).data<float>().ToArray());
+
+            // Sorted segment ids are equivalent to offsets.
+            var ids = torch.tensor(new long[] { 0, 0, 2, 2, 2 });
+            Assert.True(torch.segment_reduce(values, ids, 3, torch.SegmentReduction.Sum).Equals(sum));
+
+            {
+                torch.segment_mean(values, offsets).sum().backward();
+                var grad = values.grad();
+                Assert.NotNull(grad);
+                Assert.True(grad!.allclose(torch.tensor(new float[] { 0.5f, 0.5f, 0.5f, 0.5f, 1 / 3f, 1 / 3f, 1 / 3f, 1 / 3f, 1 / 3f, 1 / 3f }, new long[] { 5, 2 })));
+            }
+            {
+                values.grad()!.zero_();
+                torch.segment_max(values, offsets).sum().backward();
+                Assert.Equal(new float[] { 0, 0, 1, 1, 0, 0, 0, 0, 1, 1 }, values.grad()!.data<float>().ToArray());
+            }
+
+            Assert.Throws<ExternalException>(() => torch.segment_sum(values, torch.tensor(new long[] { 0, 3, 2, 5 })));
+        }
+
         [Fact]
         public void TorchPoisson()
         {
@@ -2032,6 +2091,68 @@ namespace TorchSharp
             }
         }
 
+        [Fact]
+        public void TestSparseMatmul()
+        {
+            var dense = torch.randn(new long[] { 64, 32 });
+            using (var _ = torch.no_grad()) {
+                dense.mul_(torch.rand(new long[] { 64, 32 }).gt(0.9));
+            }
+            var other = torch.randn(new long[] { 32, 8 });
+            var expected = dense.mm(other);
+
+            var coo = dense.to_sparse();
+            Assert.True(coo.is_sparse);
+            Assert.True(coo.coalesce().is_coalesced());
+            Assert.True(coo.to_dense().Equals(dense));
+            Assert.True(torch.sparse_mm(coo, other).allclose(expected, rtol: 1e-4, atol: 1e-5));
+
+            var bias = torch.randn(new long[] { 64, 8 });
+            Assert.True(torch.sparse_addmm(bias, coo, other, 0.5f, 2.0f).allclose(bias * 0.5 + expected * 2.0, rtol: 1e-4, atol: 1e-5));
+
+            var csr = dense.to_sparse_csr();
+            Assert.True(csr.is_sparse_csr);
+            Assert.Equal(65, csr.crow_indices().shape[0]);
+            var rebuilt = torch.sparse_csr(csr.crow_indices(), csr.col_indices(), csr.SparseValues, new long[] { 64, 32 });
+            Assert.True(rebuilt.to_dense().Equals(dense));
+            Assert.True(torch.sparse_mm(csr, other).allclose(expected, rtol: 1e-4, atol: 1e-5));
+        }
+
+        [Fact]
+        public void TestOutVariants()
+        {
+            var a = torch.randn(new long[] { 16, 16 });
+            var b = torch.randn(new long[] { 16, 16 });
+            var buf = torch.empty(new long[] { 16, 16 });
+
+            Assert.True(a.add(b, 2, @out: buf).Equals(a.add(b, 2)));
+            Assert.True(buf.Equals(a.add(b, 2)));
+            Assert.True(a.sub(b, buf).Equals(a.sub(b)));
+            Assert.True(a.mul(b, buf).Equals(a.mul(b)));
+            Assert.True(a.div(b, @out: buf).Equals(a.div(b)));
+            Assert.True(a.mm(b, buf).allclose(a.mm(b), rtol: 1e-4, atol: 1e-5));
+            Assert.True(a.matmul(b, buf).allclose(a.matmul(b), rtol: 1e-4, atol: 1e-5));
+            Assert.True(a.addmm(a, b, 0.5f, 2.0f, buf).allclose(a.addmm(a, b, 0.5f, 2.0f), rtol: 1e-4, atol: 1e-5));
+            Assert.True(a.exp(buf).Equals(a.exp()));
+            Assert.True(a.tanh(buf).Equals(a.tanh()));
+            Assert.True(a.sigmoid(buf).Equals(a.sigmoid()));
+            Assert.True(a.relu(buf).Equals(a.relu()));
+            Assert.True(a.gelu(buf).Equals(a.gelu()));
+            Assert.True(a.silu(buf).Equals(a.silu()));
+
+            var batch = torch.randn(new long[] { 4, 16, 16 });
+            var bbuf = torch.empty(new long[] { 4, 16, 16 });
+            Assert.True(batch.bmm(batch, bbuf).allclose(batch.bmm(batch), rtol: 1e-4, atol: 1e-5));
+
+            var rbuf = torch.empty(new long[] { 16 });
+            Assert.True(a.sum(new long[] { 1 }, @out: rbuf).allclose(a.sum(1), rtol: 1e-4, atol: 1e-5));
+            Assert.True(rbuf.allclose(a.sum(1), rtol: 1e-4, atol: 1e-5));
+            Assert.True(a.mean(new long[] { 0 }, @out: rbuf).allclose(a.mean(new long[] { 0 }), rtol: 1e-4, atol: 1e-5));
+
+            // A destination of the wrong dtype is rejected rather than silently converted.
+            Assert.Throws<ExternalException>(() => a.mm(b, torch.empty(new long[] { 16, 16 }, torch.int64)));
+        }
+
         [Fact]
         public void TestIndexSingle()
         {
@@ -2152,6 +2273,104 @@ namespace TorchSharp
             }
         }
 
+        [Fact]
+        public void TestIndexPlan()
+        {
+            using (var i = torch.tensor(new long[] { 0, 1, 2, 6, 5, 4 }, new long[] { 2, 3 }))
+            using (var plan = new TensorIndexPlan(TensorIndex.Slice(0, 2), TensorIndex.Slice(0, 3, step: 2))) {
+                Assert.True(plan.is_view);
+                var t1 = i.index(plan);
+                Assert.True(t1.Equals(i.index(TensorIndex.Slice(0, 2), TensorIndex.Slice(0, 3, step: 2))));
+
+                // The plan can be reused across tensors of compatible shape.
+                using (var j = i * 10) {
+                    Assert.Equal(60, j.index(plan)[1, 0].ToInt32());
+                }
+
+                // Writing through a view plan updates the original tensor.
+                i.index_put_(-1, plan);
+                Assert.Equal(-1, i[1, 2].ToInt32());
+                Assert.Equal(1, i[0, 1].ToInt32());
+
+                using (var ones = torch.ones(new long[] { 2, 2 }, torch.int64)) {
+                    i.index_put_(ones, plan);
+                    Assert.Equal(1, i[0, 0].ToInt32());
+                    Assert.Equal(1, i[1, 2].ToInt32());
+                }
+            }
+
+            using (var i = torch.tensor(new long[] { 0, 1, 2, 6, 5, 4 }, new long[] { 2, 3 }))
+            using (var idx = torch.tensor(new long[] { 2, 0 }))
+            using (var plan = new TensorIndexPlan(TensorIndex.Single(1), TensorIndex.Tensor(idx))) {
+                Assert.False(plan.is_view);
+                var t1 = i.index(plan);
+                Assert.Equal(4, t1[0].ToInt32());
+                Assert.Equal(6, t1[1].ToInt32());
+
+                i.index_put_(0, plan);
+                Assert.Equal(0, i[1, 0].ToInt32());
+                Assert.Equal(5, i[1, 1].ToInt32());
+                Assert.Equal(0, i[1, 2].ToInt32());
+            }
+
+            // Invalid expressions are reported, rather than taking down the process.
+            Assert.Throws<ExternalException>(() => new TensorIndexPlan(TensorIndex.Slice(0, 3, step: 0)));
+        }
+
+        [Fact]
+        public void TestTopkSimilarity()
+        {
+            var corpus = torch.randn(new long[] { 100, 8 });
+            var queries = torch.randn(new long[] { 5, 8 });
+
+            var (expectedValues, expectedIndices) = queries.mm(corpus.t()).topk(4);
+            var (values, indices) = torch.topk_similarity(queries, corpus, 4, tile_size: 7);
+            Assert.Equal(new long[] { 5, 4 }, values.shape);
+            Assert.True(values.allclose(expectedValues, rtol: 1e-4, atol: 1e-5));
+            Assert.True(indices.Equals(expectedIndices));
+
+            var normalized = corpus / corpus.norm(1, true, 2);
+            var (cosineValues, cosineIndices) = (queries / queries.norm(1, true, 2)).mm(normalized.t()).topk(3);
+            var (values2, indices2) = torch.topk_similarity(queries, corpus, 3, cosine: true, tile_size: 16);
+            Assert.True(values2.allclose(cosineValues, rtol: 1e-4, atol: 1e-5));
+            Assert.True(indices2.Equals(cosineIndices));
+
+            // Probing every list makes the inverted-file search exact.
+            using (var index = torch.ivf_index(corpus, 4, iterations: 5)) {
+                Assert.Equal(new long[] { 4, 8 }, index.centroids.shape);
+
+                var (ivfValues, ivfIndices) = index.search(queries, 4, probes: 4);
+                Assert.True(ivfValues.allclose(expectedValues, rtol: 1e-4, atol: 1e-5));
+                Assert.True(ivfIndices.Equals(expectedIndices));
+
+                var (_, probed) = index.search(queries, 4, probes: 1);
+                Assert.Equal(new long[] { 5, 4 }, probed.shape);
+            }
+        }
+
+        [Fact]
+        public void TestEinsumPath()
+        {
+            var a = torch.randn(new long[] { 200, 200 });
+            var b = torch.randn(new long[] { 200, 200 });
+            var v = torch.randn(new long[] { 200 });
+
+            // Multiplying the vector first avoids the matrix-matrix product.
+            Assert.Equal("jk,k->j; ij,j->i", torch.einsum_path("ij,jk,k->i", a, b, v));
+            Assert.True(torch.einsum("ij,jk,k->i", a, b, v).allclose(a.matmul(b.matmul(v)), rtol: 1e-3, atol: 1e-3));
+
+            // Implicit output, and a path with more operands than is searched exhaustively.
+            var ms = Enumerable.Range(0, 7).Select(i => torch.randn(new long[] { 4, 4 })).ToArray();
+            var chain = torch.einsum("ab,bc,cd,de,ef,fg,gh", ms);
+            var expected = ms.Skip(1).Aggregate(ms[0], (acc, m) => acc.matmul(m));
+            Assert.True(chain.allclose(expected, rtol: 1e-3, atol: 1e-3));
+            Assert.Equal(6, torch.einsum_path("ab,bc,cd,de,ef,fg,gh", ms).Split(';').Length);
+
+            // Two operands, and ellipses, are left to the built-in einsum.
+            Assert.Equal("", torch.einsum_path("ij,jk->ik", a, b));
+            Assert.Equal("", torch.einsum_path("...j,jk,k->...", a, b, v));
+        }
+
         [Fact]
         public void CopyCpuToCuda()
         {
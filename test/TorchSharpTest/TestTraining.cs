@@ -183,6 +183,34 @@ namespace TorchSharp
             Assert.True(finalLoss < initialLoss);
         }
 
+        [Fact]
+        public void TestTrainingNativeStep()
+        {
+            var seq = Sequential(("lin1", Linear(1000, 100)), ("relu1", ReLU()), ("lin2", Linear(100, 10)));
+
+            var x = torch.randn(new long[] { 64, 1000 });
+            var y = torch.randn(new long[] { 64, 10 });
+
+            var optimizer = torch.optim.Adam(seq.parameters());
+
+            double initialLoss = optimizer.train_step(seq, x, y, LossKind.MSE, max_grad_norm: 1.0, accumulation_steps: 4);
+            double finalLoss = double.MaxValue;
+
+            for (int i = 0; i < 10; i++) {
+                finalLoss = optimizer.train_step(seq, x, y, LossKind.MSE, max_grad_norm: 1.0, accumulation_steps: 4);
+            }
+            Assert.True(finalLoss < initialLoss);
+
+            // A module that is not a Sequential runs through its boxed form.
+            var lin = Linear(1000, 10);
+            var labels = torch.randint(10, new long[] { 64 }, torch.int64);
+            var sgd = torch.optim.SGD(lin.parameters(), 0.01);
+
+            var before = cross_entropy_loss()(lin.forward(x), labels).ToDouble();
+            var reported = sgd.train_step(lin, x, labels, LossKind.CrossEntropy);
+            Assert.Equal(before, reported, 4);
+        }
+
         [Fact]
         public void TestTrainingAdamAmsGrad()
         {